@@ -36,6 +36,14 @@ namespace maestro {
 					return bandwidth_;
 				}
 
+				int GetNumAverageHops() {
+					return num_average_hops_;
+				}
+
+				int GetLatencyPerHops() {
+					return latency_per_hops_;
+				}
+
 				bool IsMulticastSupported() {
 					return multicast_support_;
 				}
@@ -44,6 +52,10 @@ namespace maestro {
 					bandwidth_ = bw;
 				}
 
+				void SetLatencyPerHops(int hop_latency) {
+					latency_per_hops_ = hop_latency;
+				}
+
 				long GetOutStandingDelay(long data_amount) {
 					long delay;
 
@@ -29,11 +29,35 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 namespace maestro {
 
-	extern std::shared_ptr<TL::ErrorHandler> error_handler;
-	extern std::shared_ptr<TL::MessagePrinter> message_printer;
+  // Base objects are owned per thread: each thread lazily creates its own error handler and
+  // message printer on first use, so evaluations on different threads never share them.
+  TL::ErrorHandler& GetErrorHandler();
+  TL::MessagePrinter& GetMessagePrinter();
+
+  // Stateless handle that resolves to the calling thread's instance on every dereference.
+  // Copying a handle costs nothing, and a handle held by a long-lived object stays valid
+  // no matter which thread later uses that object.
+  template<typename T, T& (*GetInstance)()>
+  class ThreadLocalHandle {
+    public:
+      T* operator->() const {
+        return &GetInstance();
+      }
+
+      T& operator*() const {
+        return GetInstance();
+      }
+  };
+
+  using ErrorHandlerHandle = ThreadLocalHandle<TL::ErrorHandler, GetErrorHandler>;
+  using MessagePrinterHandle = ThreadLocalHandle<TL::MessagePrinter, GetMessagePrinter>;
+
+	inline constexpr ErrorHandlerHandle error_handler{};
+	inline constexpr MessagePrinterHandle message_printer{};
 
 	extern int printout_level;
 
+	// Resets the calling thread's message printer to the given print level
 	void InitializeBaseObjects(int print_lv = 256);
   void SetPrintOutLevel(int new_lv);
 
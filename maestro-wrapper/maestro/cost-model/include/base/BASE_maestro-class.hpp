@@ -33,15 +33,11 @@ namespace maestro {
 		public:
 
 			MAESTROClass() :
-				instance_name_("class"),
-				error_handler_(error_handler),
-				message_printer_(message_printer) {
+				instance_name_("class") {
 			}
 
 			MAESTROClass(std::string instance_name) :
-				instance_name_(instance_name),
-				error_handler_(error_handler),
-				message_printer_(message_printer) {
+				instance_name_(instance_name) {
 			}
 
 			std::string GetName() {
@@ -54,8 +50,8 @@ namespace maestro {
 
 		protected:
 			std::string instance_name_;
-			std::shared_ptr<TL::ErrorHandler> error_handler_;
-			std::shared_ptr<TL::MessagePrinter> message_printer_;
+			ErrorHandlerHandle error_handler_;
+			MessagePrinterHandle message_printer_;
 	};
 };
 #endif
@@ -0,0 +1,162 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*******************************************************************************/
+
+
+#ifndef MAESTRO_BASE_MEMORY_ARENA_HPP_
+#define MAESTRO_BASE_MEMORY_ARENA_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+
+namespace maestro {
+
+  /*
+   * Per-thread bump allocator for the objects built while evaluating one design point.
+   *
+   * While an ArenaScope is alive, MakeShared places objects (and their control blocks) in a
+   * monotonic buffer owned by the calling thread, so allocation is a pointer bump and freeing
+   * is a no-op. When the outermost scope ends, the whole region is reclaimed at once. The
+   * buffer is kept and reused by the thread's next scope, and it grows to the largest
+   * footprint seen so far (up to max_buffer_size), so a steady-state evaluation does not touch
+   * malloc for these objects at all.
+   *
+   * Every object allocated in a scope must be destroyed before the scope ends. Without a scope, MakeShared allocates from the global heap; objects that
+   * are built during an evaluation but kept for the next one are built inside a HeapScope.
+   */
+  class ArenaScope {
+    public:
+      static constexpr std::size_t initial_buffer_size = 64 * 1024;
+      static constexpr std::size_t max_buffer_size = 16 * 1024 * 1024;
+
+      ArenaScope() {
+        State& state = GetState();
+        if(state.depth++ > 0) {
+          return; // Nested scopes share the outermost arena
+        }
+
+        std::size_t desired_size = std::min(state.desired_size, max_buffer_size);
+        if(state.buffer_size < desired_size) {
+          state.buffer_size = desired_size;
+          state.buffer = std::make_unique<std::byte[]>(state.buffer_size);
+        }
+        state.overflow.Reset();
+        arena_.emplace(state.buffer.get(), state.buffer_size, &state.overflow);
+        state.current = &*arena_;
+      }
+
+      ~ArenaScope() {
+        State& state = GetState();
+        if(--state.depth > 0) {
+          return;
+        }
+
+        state.current = std::pmr::new_delete_resource();
+        arena_.reset();
+        state.desired_size = state.buffer_size + state.overflow.GetAllocatedBytes();
+      }
+
+      ArenaScope(ArenaScope const &) = delete;
+      ArenaScope& operator=(ArenaScope const &) = delete;
+
+      // Memory resource that MakeShared uses on the calling thread
+      static std::pmr::memory_resource* GetMemoryResource() {
+        return GetState().current;
+      }
+
+    protected:
+      // Upstream of the arena; records how much the arena spilled past its buffer
+      class OverflowResource : public std::pmr::memory_resource {
+        public:
+          void Reset() {
+            allocated_bytes_ = 0;
+          }
+
+          std::size_t GetAllocatedBytes() const {
+            return allocated_bytes_;
+          }
+
+        protected:
+          void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            allocated_bytes_ += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+          }
+
+          void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+          }
+
+          bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override {
+            return this == &other;
+          }
+
+          std::size_t allocated_bytes_ = 0;
+      };
+
+      struct State {
+        std::pmr::memory_resource* current = std::pmr::new_delete_resource();
+        int depth = 0;
+        std::unique_ptr<std::byte[]> buffer;
+        std::size_t buffer_size = 0;
+        std::size_t desired_size = initial_buffer_size;
+        OverflowResource overflow;
+      };
+
+      static State& GetState() {
+        static thread_local State state;
+        return state;
+      }
+
+      std::optional<std::pmr::monotonic_buffer_resource> arena_;
+
+      friend class HeapScope;
+  };
+
+  // While alive, MakeShared on the calling thread allocates from the global heap even inside an
+  // ArenaScope, so the objects it builds may outlive that scope
+  class HeapScope {
+    public:
+      HeapScope() : previous_(ArenaScope::GetState().current) {
+        ArenaScope::GetState().current = std::pmr::new_delete_resource();
+      }
+
+      ~HeapScope() {
+        ArenaScope::GetState().current = previous_;
+      }
+
+      HeapScope(HeapScope const &) = delete;
+      HeapScope& operator=(HeapScope const &) = delete;
+
+    protected:
+      std::pmr::memory_resource* previous_;
+  };
+
+  // std::make_shared that allocates from the calling thread's arena, if one is active
+  template<typename T, typename... Args>
+  std::shared_ptr<T> MakeShared(Args&&... args) {
+    return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(ArenaScope::GetMemoryResource()), std::forward<Args>(args)...);
+  }
+
+}; // End of namespace maestro
+
+#endif
@@ -28,10 +28,14 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <iostream>
 #include <memory>
 #include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "BASE_constants.hpp"
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_cluster-unit.hpp"
@@ -42,7 +46,9 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include "CA_iterations.hpp"
 #include "CA_analysis-types.hpp"
 #include "CA_reuse-analysis.hpp"
+#include "CA_reuse-analysis-cache.hpp"
 #include "CA_cost-analysis-results.hpp"
+#include "CA_sub-cluster-cache.hpp"
 
 namespace maestro {
   namespace CA {
@@ -57,7 +63,8 @@ namespace maestro {
           MAESTROClass("PerformanceAnalysis"),
           tensors_(tensors),
           clusters_(clusters),
-          num_simd_lanes_(num_simd_lanes)
+          num_simd_lanes_(num_simd_lanes),
+          sub_cluster_cache_(std::make_shared<SubClusterCache>())
         {
 
         }
@@ -71,7 +78,8 @@ namespace maestro {
           configs_(configs),
           tensors_(tensors),
           clusters_(clusters),
-          num_simd_lanes_(configs->target_accelerator_->GetVectorWidth())
+          num_simd_lanes_(configs->target_accelerator_->GetVectorWidth()),
+          sub_cluster_cache_(std::make_shared<SubClusterCache>())
         {
 
         }
@@ -79,11 +87,23 @@ namespace maestro {
 
         void SetTargetCluster(std::shared_ptr<DFA::ClusterTable> clusters) {
           clusters_ = clusters;
+          sub_cluster_cache_ = std::make_shared<SubClusterCache>();
+          level_signatures_.clear();
+        }
+
+        std::shared_ptr<SubClusterCache> GetSubClusterCache() {
+          return sub_cluster_cache_;
+        }
+
+        // Reuse analysis of the cluster levels of earlier evaluations; see ReuseAnalysisCache
+        void SetReuseAnalysisCache(std::shared_ptr<ReuseAnalysisCache> cache) {
+          reuse_cache_ = cache;
+          level_signatures_.clear();
         }
 
         std::shared_ptr<std::vector<std::shared_ptr<CostAnalyisResults>>> AnalyzeEntireCluster(bool & valid, bool write_log_file = false, std::string const & logfile = "") {
 
-          std::shared_ptr<std::vector<std::shared_ptr<CostAnalyisResults>>> ret = std::make_shared<std::vector<std::shared_ptr<CostAnalyisResults>>>();
+          std::shared_ptr<std::vector<std::shared_ptr<CostAnalyisResults>>> ret = MakeShared<std::vector<std::shared_ptr<CostAnalyisResults>>>();
 
           assert(! write_log_file || logfile != "");
           valid = AnalyzeClusterLevel_V2(0, clusters_->size(), clusters_->GetCluster(0)->GetDimensions(), ret, 1, true, write_log_file, logfile);
@@ -109,7 +129,6 @@ namespace maestro {
           std::shared_ptr<DFA::ClusterUnit> target_cluster = clusters_->GetCluster(cluster_idx);
           int num_sub_clusters = target_cluster->GetNumClusters(false);
           int num_edge_clusters = target_cluster->GetNumClusters(true);
-          int num_active_clusters = num_sub_clusters;
           auto dataflow = target_cluster->GetDataflow();
           auto noc = target_cluster->GetNoCModel();
 
@@ -134,8 +153,11 @@ namespace maestro {
           }
 
           /* Intermediate analysis */
-          auto reuse_analysis = std::make_shared<CA::ReuseAnalysis>(target_cluster, write_log_file, logfile);
-          auto results = std::make_shared<CostAnalyisResults>(clusters_->GetLayerType(), cluster_idx);
+          auto reuse_analysis = MakeShared<CA::ReuseAnalysis>(target_cluster, write_log_file, logfile);
+          if(ClusterLayout<ConvLayout>::Matches(clusters_->GetLayerType(), clusters_->size())) {
+            reuse_analysis->SpecializeLayout(tensors_);
+          }
+          auto results = MakeShared<CostAnalyisResults>(clusters_->GetLayerType(), cluster_idx);
           results->UpdateNumSubClusters(target_cluster->GetNumClusters());
 
           /* Cost stats */
@@ -151,49 +173,60 @@ namespace maestro {
             delays[i][static_cast<int>(ValueType::Avg)] = 0;
           }
 
-          auto iteration_analysis = std::make_unique<DFA::IterationAnalysis>(dimensions, target_cluster, write_log_file, logfile);
-          std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationStatus>>> all_iteration_cases = iteration_analysis->GetAllIterationsStatus();
+          auto iteration_analysis = MakeShared<DFA::IterationAnalysis>(dimensions, target_cluster, write_log_file, logfile);
+          int num_iteration_cases = iteration_analysis->GetNumIterationCases();
 
-          //Set the buffer size based on the worst case
-          // TODO: Apply case-based analysis
-//          UpdateBufferSizeReq(results, dimensions, reuse_analysis, do_double_buffering);
-
-          long num_total_cases = 0;
-          int case_id = 0;
-          for(auto& iteration_case : *all_iteration_cases) {
-            if(case_id == 0) {
-              UpdateBufferSizeReq(results, dimensions, reuse_analysis, iteration_case, cluster_idx, num_cluster_lvs, do_double_buffering);
+          std::shared_ptr<DFA::directive::Directive> spmap_directive = nullptr;
+          for(auto& directive : *dataflow) {
+            if(directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
+              spmap_directive = directive;
+              break;
             }
+          }
 
-            long num_case_occurrences = iteration_case->GetNumOccurrences();
-#ifdef _SPOTLIGHT
-            if (num_case_occurrences == 0) {
-  #ifdef _SPOTLIGHT_SAFE
-              return false;
-  #else
-              continue;
-  #endif
+          // The reuse and sub-cluster analysis of a case is shared by every case of its class;
+          // a logging run analyzes (and logs) every case on its own. The reuse of a level that
+          // the last evaluation analyzed as well comes from the reuse analysis cache, if any.
+          IterationCaseClasses case_classes(iteration_analysis, dataflow);
+          std::vector<int> class_analysis_ids(num_iteration_cases, -1);
+          std::vector<IterationCaseAnalysis> case_analyses;
+
+          std::string reuse_key;
+          std::shared_ptr<ReuseAnalysisCache::Entry const> cached_reuse = nullptr;
+          std::shared_ptr<ReuseAnalysisCache::Entry> new_reuse = nullptr;
+          if(reuse_cache_ != nullptr && !write_log_file) {
+            if(level_signatures_.empty()) {
+              for(int lv = 0; lv < clusters_->size(); lv++) {
+                level_signatures_.push_back(SubClusterCache::MakeClusterLevelSignature(clusters_, lv, num_simd_lanes_));
+              }
             }
-#else
-            assert(num_case_occurrences > 0);
-#endif
+            reuse_key = level_signatures_[cluster_idx] + "#" + SubClusterCache::MakeDimensionKey(cluster_idx, do_double_buffering, dimensions);
+            cached_reuse = reuse_cache_->Lookup(reuse_key);
+            if(cached_reuse == nullptr) {
+              new_reuse = std::make_shared<ReuseAnalysisCache::Entry>();
+            }
+          }
 
-            if(write_log_file && cluster_idx <= print_cluster_lv) {
-              log_file << "======================= CASE " << case_id << " =======================" << std::endl;
-              log_file << "@ cluster level " << cluster_idx << std::endl;
-              log_file << iteration_case->ToString() << std::endl;
+          auto construct_sub_cluster_dimension = [&](std::shared_ptr<DFA::IterationStatus> iteration_case, bool is_sp_edge_edge) {
+            // Cached tables outlive this evaluation
+            std::optional<HeapScope> heap;
+            if(new_reuse != nullptr) {
+              heap.emplace();
             }
+            return reuse_analysis->ConstructSubClusterDimension(iteration_case, is_sp_edge_edge);
+          };
+
+          auto analyze_reuse = [&](std::shared_ptr<DFA::IterationStatus> iteration_case, IterationCaseReuse& reuse) {
+            reuse.is_all_init = iteration_case->isAllInit();
 
             long ingress_spatial_traffic = 0;
             long egress_spatial_traffic = 0;
 
-            long num_partial_sums = 0;
             long tensor_spatial_partial_sum_mapping_size = 0;
             for(auto& tensor : *output_tensors) {
               long tensor_egress_traffic = reuse_analysis->GetSpatialEgressTraffic(tensor, iteration_case);
               long tensor_spatial_mapping_size = reuse_analysis->GetOutputTensorSpatialMappingSize(tensor, iteration_case);
               tensor_spatial_partial_sum_mapping_size += reuse_analysis->GetOutputTensorSpatialMappingSize(tensor, iteration_case, true);
-              auto data_class = tensor->GetDataClass();
 
               if(write_log_file && cluster_idx <= print_cluster_lv) {
                 log_file << "Output Tensor " << tensor->GetTensorName() << std::endl;
@@ -202,39 +235,23 @@ namespace maestro {
                 log_file << "\ttensor_spatial_partial_sum_mapping_size" << tensor_spatial_partial_sum_mapping_size << std::endl;
               }
 
-
               egress_spatial_traffic += tensor_egress_traffic;
-
-              long upstream_write_this_tensor = tensor_egress_traffic;
-
-              long prev_upstream_wr_count = results->GetBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, data_class);
-              results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, prev_upstream_wr_count + num_case_occurrences * upstream_write_this_tensor, data_class);
-
-              long prev_downstream_wr_count = results->GetBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, data_class);
-              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, prev_downstream_wr_count + num_case_occurrences * tensor_spatial_partial_sum_mapping_size, data_class);
-
-              long prev_downstream_rd_count = results->GetBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, data_class);
-              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, prev_downstream_rd_count + num_case_occurrences * tensor_spatial_partial_sum_mapping_size, data_class);
-              num_partial_sums += reuse_analysis->GetNumCriticalPathPartialSums(tensor, iteration_case);
+              reuse.egress_traffic.push_back(tensor_egress_traffic);
+              reuse.partial_sum_mapping_sizes.push_back(tensor_spatial_partial_sum_mapping_size);
+              reuse.num_partial_sums += reuse_analysis->GetNumCriticalPathPartialSums(tensor, iteration_case);
             }
+            reuse.partial_sum_mapping_size = tensor_spatial_partial_sum_mapping_size;
 
-
-            if(num_partial_sums <= 0) {
-              // std::cout << "Num partial sums is less than 0!" << std::endl;
-#ifdef _SPOTLIGHT_SAFE
-              valid = false;
-#endif
+            if(reuse.num_partial_sums <= 0) {
               if(write_log_file && cluster_idx <= print_cluster_lv) {
                 log_file << "Skipping Invalid case" << std::endl;
               }
-              continue;
+              return;
             }
 
-
             for(auto& tensor : *input_tensors) {
               long tensor_ingress_traffic = reuse_analysis->GetSpatialIngressTraffic(tensor, iteration_case);
               long tensor_spatial_mapping_size = reuse_analysis->GetInputTensorSpatialMappingSize(tensor, iteration_case);
-              auto data_class = tensor->GetDataClass();
 
               if(write_log_file && cluster_idx <= print_cluster_lv) {
                 log_file << "Input Tensor " << tensor->GetTensorName() << std::endl;
@@ -243,22 +260,10 @@ namespace maestro {
               }
 
               ingress_spatial_traffic += tensor_ingress_traffic;
-
-              long upstream_read_this_tensor = tensor_ingress_traffic;
-
-              long prev_rd_count = results->GetBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, data_class);
-              results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, prev_rd_count + num_case_occurrences * upstream_read_this_tensor, data_class);
-
-              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, prev_rd_count + num_case_occurrences * upstream_read_this_tensor, data_class);
-
-              long prev_downstream_rd_count = results->GetBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, data_class);
-              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, prev_downstream_rd_count + num_case_occurrences * tensor_spatial_partial_sum_mapping_size, data_class);
+              reuse.ingress_traffic.push_back(tensor_ingress_traffic);
             }
-
-            double arithmetic_intensity = static_cast<double>(tensor_spatial_partial_sum_mapping_size)/static_cast<double>(ingress_spatial_traffic);
-
-            results->SetArithmeticIntensity(arithmetic_intensity);
-
+            reuse.ingress_spatial_traffic = ingress_spatial_traffic;
+            reuse.egress_spatial_traffic = egress_spatial_traffic;
 
             //TODO: Exactly model cross-PE accumulation
 
@@ -268,27 +273,41 @@ namespace maestro {
               log_file << "Number of MACs over sub cluster array: " << tensor_spatial_partial_sum_mapping_size << std::endl;
             }
 
-            ////////////////////////////
+            if(spmap_directive == nullptr) {
+              error_handler_->PrintErrorMsg(TL::ErrorCode::NoSpatialMap, std::to_string(cluster_idx) ,this->GetName());
+              error_handler_->TerminateProgram();
+            }
 
-            long computation_delay = 0;
-            std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>> sub_cluster_results = std::make_shared<std::vector<std::shared_ptr<CA::CostAnalyisResults>>>();
+            auto spmap_dim_iter_state = iteration_case->GetIterState(spmap_directive->GetVariable());
+            reuse.is_spatial_edge = spmap_dim_iter_state->IsEdge();
+            reuse.has_spatial_edge_edge = reuse.is_spatial_edge && spmap_dim_iter_state->HasSpEdgeEdge();
 
-            std::shared_ptr<DFA::directive::Directive> spmap_directive = nullptr;
-            for(auto& directive : *dataflow) {
-              if(directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
-                spmap_directive = directive;
-                break;
+            if(cluster_idx < num_cluster_lvs-1) {
+              if(reuse.has_spatial_edge_edge) {
+                reuse.sp_edge_edge_sub_cluster_dimensions = construct_sub_cluster_dimension(iteration_case, true);
+                if(num_edge_clusters-1 > 0) {
+                  reuse.sub_cluster_dimensions = construct_sub_cluster_dimension(iteration_case, false);
+                }
+              }
+              else {
+                reuse.sub_cluster_dimensions = construct_sub_cluster_dimension(iteration_case, false);
               }
             }
 
-            if(spmap_directive == nullptr) {
-              error_handler_->PrintErrorMsg(TL::ErrorCode::NoSpatialMap, std::to_string(cluster_idx) ,this->GetName());
-              error_handler_->TerminateProgram();
+            reuse.ingress_comm_delay = noc->GetOutStandingDelay(ingress_spatial_traffic);
+            reuse.egress_comm_delay = noc->GetOutStandingDelay(egress_spatial_traffic);
+          };
+
+          auto analyze_sub_clusters = [&](IterationCaseAnalysis& analysis) {
+            if(analysis.num_partial_sums <= 0) {
+              return;
             }
 
-            auto spmap_dim_iter_state = iteration_case->GetIterState(spmap_directive->GetVariable());
+            long computation_delay = 0;
+            std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>> sub_cluster_results = MakeShared<std::vector<std::shared_ptr<CA::CostAnalyisResults>>>();
 
-            if(spmap_dim_iter_state->IsEdge()) {
+            int num_active_clusters;
+            if(analysis.is_spatial_edge) {
               num_active_clusters = num_edge_clusters;
             }
             else {
@@ -296,34 +315,31 @@ namespace maestro {
             }
 
             // Recursively process subclusters
+            analysis.first_sub_cluster_result = ret->size();
             if(cluster_idx < num_cluster_lvs-1) {
-              if(spmap_dim_iter_state->IsEdge()) {
-                if(spmap_dim_iter_state->HasSpEdgeEdge()) {
-                  auto subclsuter_dim_under_sp_edge_edge = reuse_analysis->ConstructSubClusterDimension(iteration_case, true);
-                  valid &= AnalyzeClusterLevel_V2(cluster_idx+1, num_cluster_lvs, subclsuter_dim_under_sp_edge_edge, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
+              if(analysis.is_spatial_edge) {
+                if(analysis.has_spatial_edge_edge) {
+                  analysis.valid &= AnalyzeSubClusterLevel(cluster_idx+1, num_cluster_lvs, analysis.sp_edge_edge_sub_cluster_dimensions, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
                   auto sp_edge_edge_subcluster_res = ret->at(ret->size()-1);
                   sub_cluster_results->push_back(sp_edge_edge_subcluster_res);
 
                   int num_rem_clusters = num_edge_clusters-1;
                   if(num_rem_clusters > 0 ) {
-                    auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(iteration_case, false);
-                    valid &= AnalyzeClusterLevel_V2(cluster_idx+1, num_cluster_lvs, this_subclsuter_dim, ret, print_cluster_lv,do_double_buffering, write_log_file, logfile);
+                    analysis.valid &= AnalyzeSubClusterLevel(cluster_idx+1, num_cluster_lvs, analysis.sub_cluster_dimensions, ret, print_cluster_lv,do_double_buffering, write_log_file, logfile);
                     auto this_subcluster_res = ret->at(ret->size()-1);
                     this_subcluster_res->SetNumSpatialOccurrences(num_rem_clusters);
                     sub_cluster_results->push_back(this_subcluster_res);
                   }
-                } // End of if(spmap_dim_iter_state->HasSpEdgeEdge())
+                } // End of if(analysis.has_spatial_edge_edge)
                 else {
-                  auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(iteration_case, false);
-                  valid &= AnalyzeClusterLevel_V2(cluster_idx+1, num_cluster_lvs, this_subclsuter_dim, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
+                  analysis.valid &= AnalyzeSubClusterLevel(cluster_idx+1, num_cluster_lvs, analysis.sub_cluster_dimensions, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
                   auto this_subcluster_res = ret->at(ret->size()-1);
                   this_subcluster_res->SetNumSpatialOccurrences(num_edge_clusters);
                   sub_cluster_results->push_back(this_subcluster_res);
-                } // End of else of if(spmap_dim_iter_state->HasSpEdgeEdge())
-              } // End of if(spmap_dim_iter_state->IsEdge())
+                } // End of else of if(analysis.has_spatial_edge_edge)
+              } // End of if(analysis.is_spatial_edge)
               else {
-                auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(iteration_case, false);
-                valid &= AnalyzeClusterLevel_V2(cluster_idx+1, num_cluster_lvs, this_subclsuter_dim, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
+                analysis.valid &= AnalyzeSubClusterLevel(cluster_idx+1, num_cluster_lvs, analysis.sub_cluster_dimensions, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
                 auto this_subcluster_res = ret->at(ret->size()-1);
                 this_subcluster_res->SetNumSpatialOccurrences(num_sub_clusters);
                 sub_cluster_results->push_back(this_subcluster_res);
@@ -337,9 +353,154 @@ namespace maestro {
             } // End of if(cluster_idx < num_cluster_lvs-1)
             else { // Base cluster
               computation_delay =static_cast<long>(
-                  std::ceil(static_cast<double>(num_partial_sums) / static_cast<double>(num_simd_lanes_)));
+                  std::ceil(static_cast<double>(analysis.num_partial_sums) / static_cast<double>(num_simd_lanes_)));
             }
-            ////////////////////////////
+            analysis.last_sub_cluster_result = ret->size();
+            analysis.computation_delay = computation_delay;
+
+            // outstanding_delay if every sub-cluster took its compute-bound runtime, which no order
+            // of the sub-clusters' directives can beat
+            analysis.compute_bound_delay = computation_delay;
+            if(cluster_idx < num_cluster_lvs-1) {
+              analysis.compute_bound_delay = 0;
+              for(auto& sub_res : *sub_cluster_results) {
+                analysis.compute_bound_delay = std::max(analysis.compute_bound_delay, sub_res->GetComputeBoundRuntime());
+              }
+            }
+
+            long double num_active_unit_clusters = 0;
+            for(auto& sub_res : * sub_cluster_results) {
+              num_active_unit_clusters += sub_res->GetNumAvgActiveClusters() * sub_res->GetNumSpatialOccurrences();
+            }
+
+            analysis.num_active_unit_clusters = (num_active_unit_clusters== 0)? num_active_clusters : num_active_unit_clusters;
+          };
+
+          //Set the buffer size based on the worst case
+          // TODO: Apply case-based analysis
+//          UpdateBufferSizeReq(results, dimensions, reuse_analysis, do_double_buffering);
+
+          long num_total_cases = 0;
+          int case_id = 0;
+          std::vector<int> state_indices = iteration_analysis->GetFirstIterationCase();
+          for(int case_idx = 0; case_idx < num_iteration_cases; case_idx++) {
+            if(case_idx > 0) {
+              iteration_analysis->GetNextIterationCase(case_idx - 1, state_indices);
+            }
+
+            std::shared_ptr<DFA::IterationStatus> iteration_case = nullptr;
+            if(case_id == 0 || write_log_file) {
+              iteration_case = iteration_analysis->GetIterationStatus(state_indices);
+            }
+
+            if(case_id == 0) {
+              UpdateBufferSizeReq(results, dimensions, reuse_analysis, iteration_case, cluster_idx, num_cluster_lvs, do_double_buffering);
+            }
+
+            long num_case_occurrences = iteration_analysis->GetNumOccurrences(state_indices);
+#ifdef _SPOTLIGHT
+            if (num_case_occurrences == 0) {
+  #ifdef _SPOTLIGHT_SAFE
+              return false;
+  #else
+              continue;
+  #endif
+            }
+#else
+            assert(num_case_occurrences > 0);
+#endif
+
+            if(write_log_file && cluster_idx <= print_cluster_lv) {
+              log_file << "======================= CASE " << case_id << " =======================" << std::endl;
+              log_file << "@ cluster level " << cluster_idx << std::endl;
+              log_file << iteration_case->ToString() << std::endl;
+            }
+
+            int class_id = write_log_file? case_idx : case_classes.GetClassID(state_indices);
+            bool is_new_class = class_analysis_ids[class_id] == -1;
+            if(is_new_class) {
+              class_analysis_ids[class_id] = case_analyses.size();
+              case_analyses.emplace_back();
+              IterationCaseAnalysis& new_analysis = case_analyses.back();
+              if(cached_reuse != nullptr) {
+                assert(case_analyses.size() <= cached_reuse->cases.size());
+                static_cast<IterationCaseReuse&>(new_analysis) = cached_reuse->cases[case_analyses.size()-1];
+              }
+              else {
+                if(iteration_case == nullptr) {
+                  iteration_case = iteration_analysis->GetIterationStatus(state_indices);
+                }
+                analyze_reuse(iteration_case, new_analysis);
+                if(new_reuse != nullptr) {
+                  new_reuse->cases.push_back(new_analysis);
+                }
+              }
+              analyze_sub_clusters(new_analysis);
+            }
+            IterationCaseAnalysis const & analysis = case_analyses[class_analysis_ids[class_id]];
+            bool is_all_init = analysis.is_all_init;
+
+            long num_partial_sums = analysis.num_partial_sums;
+            long tensor_spatial_partial_sum_mapping_size = analysis.partial_sum_mapping_size;
+
+            int tensor_idx = 0;
+            for(auto& tensor : *output_tensors) {
+              auto data_class = tensor->GetDataClass();
+              long upstream_write_this_tensor = analysis.egress_traffic[tensor_idx];
+              long partial_sum_mapping_size = analysis.partial_sum_mapping_sizes[tensor_idx];
+
+              long prev_upstream_wr_count = results->GetBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, data_class);
+              results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, prev_upstream_wr_count + num_case_occurrences * upstream_write_this_tensor, data_class);
+
+              long prev_downstream_wr_count = results->GetBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, data_class);
+              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, prev_downstream_wr_count + num_case_occurrences * partial_sum_mapping_size, data_class);
+
+              long prev_downstream_rd_count = results->GetBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, data_class);
+              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, prev_downstream_rd_count + num_case_occurrences * partial_sum_mapping_size, data_class);
+              tensor_idx++;
+            }
+
+
+            if(num_partial_sums <= 0) {
+              // std::cout << "Num partial sums is less than 0!" << std::endl;
+#ifdef _SPOTLIGHT_SAFE
+              valid = false;
+#endif
+              continue;
+            }
+
+            tensor_idx = 0;
+            for(auto& tensor : *input_tensors) {
+              auto data_class = tensor->GetDataClass();
+              long upstream_read_this_tensor = analysis.ingress_traffic[tensor_idx];
+
+              long prev_rd_count = results->GetBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, data_class);
+              results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, prev_rd_count + num_case_occurrences * upstream_read_this_tensor, data_class);
+
+              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, prev_rd_count + num_case_occurrences * upstream_read_this_tensor, data_class);
+
+              long prev_downstream_rd_count = results->GetBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, data_class);
+              results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read, prev_downstream_rd_count + num_case_occurrences * tensor_spatial_partial_sum_mapping_size, data_class);
+              tensor_idx++;
+            }
+
+            long ingress_spatial_traffic = analysis.ingress_spatial_traffic;
+            long egress_spatial_traffic = analysis.egress_spatial_traffic;
+
+            double arithmetic_intensity = static_cast<double>(tensor_spatial_partial_sum_mapping_size)/static_cast<double>(ingress_spatial_traffic);
+
+            results->SetArithmeticIntensity(arithmetic_intensity);
+
+            // Every case of a class gets its own copies of the sub-cluster results, as it would
+            // from the sub-cluster cache
+            if(!is_new_class) {
+              for(std::size_t res_idx = analysis.first_sub_cluster_result; res_idx < analysis.last_sub_cluster_result; res_idx++) {
+                ret->push_back(MakeShared<CostAnalyisResults>(*ret->at(res_idx)));
+              }
+            }
+            valid &= analysis.valid;
+
+            long computation_delay = analysis.computation_delay;
 
 #ifdef _SPOTLIGHT
             if(computation_delay == 0) {
@@ -351,16 +512,24 @@ namespace maestro {
             }
 #endif
 
-            long ingress_comm_delay = noc->GetOutStandingDelay(ingress_spatial_traffic);
-            long egress_comm_delay = noc->GetOutStandingDelay(egress_spatial_traffic);
+            long ingress_comm_delay = analysis.ingress_comm_delay;
+            long egress_comm_delay = analysis.egress_comm_delay;
 
             long outstanding_delay;
-            if(iteration_case->isAllInit()) {
+            if(is_all_init) {
               outstanding_delay = (do_double_buffering)? computation_delay + ingress_comm_delay : ingress_comm_delay + computation_delay + egress_comm_delay;
             }
             else {
               outstanding_delay = (do_double_buffering)? std::max( egress_comm_delay, std::max(computation_delay, ingress_comm_delay)) : ingress_comm_delay + computation_delay + egress_comm_delay;
             }
+            long compute_bound_delay = analysis.compute_bound_delay;
+            long min_outstanding_delay;
+            if(is_all_init) {
+              min_outstanding_delay = (do_double_buffering)? compute_bound_delay + ingress_comm_delay : ingress_comm_delay + compute_bound_delay + egress_comm_delay;
+            }
+            else {
+              min_outstanding_delay = (do_double_buffering)? std::max( egress_comm_delay, std::max(compute_bound_delay, ingress_comm_delay)) : ingress_comm_delay + compute_bound_delay + egress_comm_delay;
+            }
             //felix
             if(cluster_idx == 0){
               auto out_buffer_delay = (results->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Output))/configs_->offchip_bw_;
@@ -368,6 +537,7 @@ namespace maestro {
               auto ingress_offchip_delay = (do_double_buffering)?in_buffer_delay/2:in_buffer_delay;
               auto egress_offchip_delay = (do_double_buffering)?out_buffer_delay/2:out_buffer_delay;
               outstanding_delay =  (do_double_buffering)?std::max(ingress_offchip_delay, std::max(outstanding_delay, egress_offchip_delay)): outstanding_delay + ingress_offchip_delay + egress_offchip_delay;
+              min_outstanding_delay =  (do_double_buffering)?std::max(ingress_offchip_delay, std::max(min_outstanding_delay, egress_offchip_delay)): min_outstanding_delay + ingress_offchip_delay + egress_offchip_delay;
               //felix
               off_chip_bw_req = std::max(off_chip_bw_req, results->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Output)/computation_delay);
               off_chip_bw_req = std::max(off_chip_bw_req, (results->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Input) + results->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Weight))/computation_delay);
@@ -378,16 +548,12 @@ namespace maestro {
             }
             //
             results->UpdateRuntime(results->GetRuntime(CA::EstimationType::Exact) + num_case_occurrences * outstanding_delay, CA::EstimationType::Exact);
+            results->UpdateComputeBoundRuntime(results->GetComputeBoundRuntime() + num_case_occurrences * compute_bound_delay);
+            results->UpdateMinRuntime(results->GetMinRuntime() + num_case_occurrences * min_outstanding_delay);
             results->UpdateNumComputations(results->GetNumComputations() + num_case_occurrences * tensor_spatial_partial_sum_mapping_size);
 
 
-            long double num_active_unit_clusters = 0;
-            for(auto& sub_res : * sub_cluster_results) {
-              num_active_unit_clusters += sub_res->GetNumAvgActiveClusters() * sub_res->GetNumSpatialOccurrences();
-            }
-
-            num_active_unit_clusters = (num_active_unit_clusters== 0)? num_active_clusters : num_active_unit_clusters;
-            results->SetNumAvgActiveClusters(results->GetNumAvgActiveClusters() + num_active_unit_clusters * num_case_occurrences);
+            results->SetNumAvgActiveClusters(results->GetNumAvgActiveClusters() + analysis.num_active_unit_clusters * num_case_occurrences);
 
             //TODO: Doble check
             if(computation_delay == 0)
@@ -419,7 +585,7 @@ namespace maestro {
             case_id++;
 
             if(write_log_file && cluster_idx <= print_cluster_lv) {
-              if(iteration_case->isAllInit()) {
+              if(is_all_init) {
                 log_file << "Note: Initialization case; cannot exploit latency hiding in this case" << std::endl;
               }
 
@@ -434,7 +600,7 @@ namespace maestro {
               log_file << std::endl;
 
               if(do_double_buffering) {
-                if(iteration_case->isAllInit()){
+                if(is_all_init){
                   log_file << "This case is <<Ingress communication + computation>> bound (Initialization case)" << std::endl;
                 }
                 else if(outstanding_delay == computation_delay) {
@@ -452,7 +618,7 @@ namespace maestro {
               log_file << "outstanding_delay (for all iterations in this case): " << num_case_occurrences * outstanding_delay << std::endl;
               log_file << "======================= END CASE " << case_id << " =======================\n\n" << std::endl;
             }
-          } // End of for_each (iteration_case) in (all_iteration_cases)
+          } // End of for (case_idx) in (iteration cases)
           avg_noc_bw_req = avg_noc_bw_req / num_total_cases;
 
           if(num_total_cases != 0) {
@@ -479,6 +645,10 @@ namespace maestro {
 
           ret->push_back(results);
 
+          if(new_reuse != nullptr) {
+            reuse_cache_->Insert(reuse_key, new_reuse);
+          }
+
           return valid;
         }
 
@@ -488,8 +658,55 @@ namespace maestro {
         std::shared_ptr<DFA::ClusterTable> clusters_;
         int num_simd_lanes_;
 
+        std::shared_ptr<SubClusterCache> sub_cluster_cache_;
+
+        std::shared_ptr<ReuseAnalysisCache> reuse_cache_;
+        std::vector<std::string> level_signatures_;
+
+        // What AnalyzeClusterLevel_V2 derives from the reuse and sub-cluster analysis of an
+        // iteration case, before weighing it by the number of occurrences of the case
+        struct IterationCaseAnalysis : public IterationCaseReuse {
+          // Sub-cluster results the case appended to the result list
+          std::size_t first_sub_cluster_result = 0;
+          std::size_t last_sub_cluster_result = 0;
+          bool valid = true;
+          long computation_delay = 0;
+          long compute_bound_delay = 0;
+          long double num_active_unit_clusters = 0;
+        };
+
       private:
 
+        // Analyzes a sub-cluster level, reusing the results of an identical sub-cluster
+        // dimension table analyzed before. Logging runs are never cached.
+        bool AnalyzeSubClusterLevel(
+            int cluster_idx,
+            int num_cluster_lvs,
+            std::shared_ptr<DFA::DimensionTable> dimensions,
+            std::shared_ptr<std::vector<std::shared_ptr<CostAnalyisResults>>> ret,
+            int print_cluster_lv,
+            bool do_double_buffering,
+            bool write_log_file,
+            std::string const & logfile) {
+
+          if(write_log_file) {
+            return AnalyzeClusterLevel_V2(cluster_idx, num_cluster_lvs, dimensions, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
+          }
+
+          std::string key = SubClusterCache::MakeDimensionKey(cluster_idx, do_double_buffering, dimensions);
+
+          bool valid = true;
+          if(sub_cluster_cache_->Lookup(key, ret, valid)) {
+            return valid;
+          }
+
+          std::size_t first_idx = ret->size();
+          valid = AnalyzeClusterLevel_V2(cluster_idx, num_cluster_lvs, dimensions, ret, print_cluster_lv, do_double_buffering, write_log_file, logfile);
+          sub_cluster_cache_->Insert(key, ret, first_idx, valid);
+
+          return valid;
+        }
+
         void UpdateBufferSizeReq(
             std::shared_ptr<CostAnalyisResults> results,
             std::shared_ptr<DFA::DimensionTable> dimensions,
@@ -24,6 +24,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "BASE_maestro-class.hpp"
 #include "BASE_constants.hpp"
+#include "BASE_memory-arena.hpp"
 
 #include "DFA_layer.hpp"
 #include "DFA_iteration-status.hpp"
@@ -45,7 +46,7 @@ namespace maestro {
           cluster_level_(-1),
           num_computations_(0)
           {
-          iter_status_info_ = std::make_shared<std::vector<std::shared_ptr<DFA::IterationStatus>>>();
+          iter_status_info_ = MakeShared<std::vector<std::shared_ptr<DFA::IterationStatus>>>();
 
           ingress_delay_[static_cast<int>(ValueType::Max)] = 0;
           ingress_delay_[static_cast<int>(ValueType::Min)] = std::numeric_limits<int>::max();
@@ -69,7 +70,7 @@ namespace maestro {
           cluster_level_(cluster_level),
           num_computations_(0)
           {
-          iter_status_info_ = std::make_shared<std::vector<std::shared_ptr<DFA::IterationStatus>>>();
+          iter_status_info_ = MakeShared<std::vector<std::shared_ptr<DFA::IterationStatus>>>();
 
           ingress_delay_[static_cast<int>(ValueType::Max)] = 0;
           ingress_delay_[static_cast<int>(ValueType::Min)] = std::numeric_limits<int>::max();
@@ -90,6 +91,19 @@ namespace maestro {
           return runtime_[static_cast<int>(estimation_type)];
         }
 
+        // Runtime if no communication took time, which only depends on the tile sizes of this
+        // and the lower cluster levels and not on the order of their directives
+        long GetComputeBoundRuntime() {
+          return compute_bound_runtime_;
+        }
+
+        // Runtime if every sub-cluster took its compute-bound runtime. Since the delay of each
+        // iteration case only grows with the runtime of its sub-clusters, no order of the lower
+        // cluster levels' directives has a shorter runtime.
+        long GetMinRuntime() {
+          return min_runtime_;
+        }
+
         long GetNumComputations() {
           return num_computations_;
         }
@@ -208,6 +222,14 @@ namespace maestro {
           runtime_[static_cast<int>(estimation_type)] = new_runtime;
         }
 
+        void UpdateComputeBoundRuntime(long new_runtime) {
+          compute_bound_runtime_ = new_runtime;
+        }
+
+        void UpdateMinRuntime(long new_runtime) {
+          min_runtime_ = new_runtime;
+        }
+
         void UpdateNumComputations(long num_computations) {
           num_computations_ = num_computations;
         }
@@ -289,6 +311,8 @@ namespace maestro {
         double arithmetic_intensity_ = 0;
 
         long runtime_[static_cast<int>(CA::EstimationType::NumEstimationTypes)]= {0, };
+        long compute_bound_runtime_ = 0;
+        long min_runtime_ = 0;
 
         long upstream_buffer_write_estimate_[static_cast<int>(DataClass::NumDataClasses)] = {0};
         long upstream_buffer_read_[static_cast<int>(DataClass::NumDataClasses)] = {0};
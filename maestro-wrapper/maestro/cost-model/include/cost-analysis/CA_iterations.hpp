@@ -33,6 +33,9 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include "BASE_maestro-class.hpp"
 
 #include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_cluster-unit.hpp"
+#include "DFA_iteration-analysis.hpp"
 #include "DFA_tensor.hpp"
 
 #include "CA_analysis-types.hpp"
@@ -104,6 +107,76 @@ namespace maestro {
     }; // End of class UnitIterationAnalysis
 
 
+    /*
+     * Groups the iteration cases of a cluster level that the reuse analysis cannot tell apart.
+     *
+     * Every query ReuseAnalysis makes for a case only looks at the position of the innermost
+     * directive that is not at Init (the changing directive) and of the spatial map. Any other
+     * temporal map is only asked whether it is at an edge, which Init and Steady are not unless
+     * Init itself is one. Such a directive's Steady state is thus folded into Init, which turns
+     * the three states of a temporal map outer to the changing directive into two. Directives
+     * inner to it are at Init in every case anyway.
+     *
+     * A class is numbered by its folded case, read as a number whose digits are the state
+     * indices, so class IDs are below the number of cases.
+     */
+    class IterationCaseClasses {
+      public:
+        IterationCaseClasses(
+          std::shared_ptr<DFA::IterationAnalysis> iteration_analysis,
+          std::shared_ptr<DFA::DirectiveTable> dataflow) {
+          int num_directives = dataflow->size();
+          is_foldable_.resize(num_directives);
+          strides_.resize(num_directives);
+
+          // A directive state is looked up by dimension, so a dimension with two directives
+          // hides the state of one of them; nothing is folded then
+          bool has_repeated_dim = false;
+          DFA::DimensionMask dim_mask = 0;
+          for(auto& directive : *dataflow) {
+            DFA::DimensionMask mask = DFA::GetDimensionMask(directive->GetVariableID());
+            has_repeated_dim |= (dim_mask & mask) != 0;
+            dim_mask |= mask;
+          }
+
+          int stride = 1;
+          for(int idx = num_directives - 1; idx >= 0; idx--) {
+            auto iter_states = iteration_analysis->GetIterationStates(idx);
+            auto directive = dataflow->at(idx);
+
+            is_foldable_[idx] = !has_repeated_dim
+                && directive->GetClass() == DFA::directive::DirectiveClass::TemporalMap
+                && iter_states->size() > 1
+                && !iter_states->at(0)->IsEdge()
+                && iter_states->at(1)->GetIterPosition() == DFA::IterationPosition::Steady;
+
+            strides_[idx] = stride;
+            stride *= iter_states->size();
+          }
+        }
+
+        int GetClassID(std::vector<int> const & state_indices) {
+          int changing_idx = state_indices.size() - 1;
+          while(changing_idx >= 0 && state_indices[changing_idx] == 0) {
+            changing_idx--;
+          }
+
+          int class_id = 0;
+          for(int idx = 0; idx <= changing_idx; idx++) {
+            bool is_folded = idx < changing_idx && is_foldable_[idx] && state_indices[idx] == 1;
+            if(!is_folded) {
+              class_id += state_indices[idx] * strides_[idx];
+            }
+          }
+
+          return class_id;
+        }
+
+      protected:
+        std::vector<bool> is_foldable_;
+        std::vector<int> strides_;
+    }; // End of class IterationCaseClasses
+
   }; // End of namespace CA
 }; // End of namespace maestro
 
@@ -0,0 +1,182 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_CA_LAYER_LAYOUT_HPP_
+#define MAESTRO_CA_LAYER_LAYOUT_HPP_
+
+#include <array>
+#include <memory>
+#include <optional>
+
+#include "BASE_constants.hpp"
+
+#include "DFA_dimension-id.hpp"
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_layer.hpp"
+#include "DFA_tensor.hpp"
+#include "DFA_tensor-table.hpp"
+
+namespace maestro {
+  namespace CA {
+
+    /*
+     * Layer shapes the reuse analysis has a specialized path for, described at compile time: the
+     * layer type, the number of dimensions (directives per cluster level), the number of cluster
+     * levels, and the dimensions each tensor is coupled with, in the order the API couples them.
+     * Every other shape goes through the generic, name-keyed analysis.
+     */
+    template<LayerType layer_type, int num_dimensions, int num_cluster_levels>
+    struct LayerLayout {
+      static constexpr bool is_specialized = false;
+    };
+
+    template<>
+    struct LayerLayout<LayerType::CONV, 7, 2> {
+      static constexpr bool is_specialized = true;
+      static constexpr LayerType layer_type = LayerType::CONV;
+      static constexpr int num_dimensions = 7;
+      static constexpr int num_cluster_levels = 2;
+      static constexpr int num_coupled_dims = 4;
+
+      // Indexed by DataClass
+      static constexpr std::array<DFA::DimensionID, num_coupled_dims> coupling[static_cast<int>(DataClass::NumDataClasses)] = {
+        {DFA::DimensionID::N, DFA::DimensionID::C, DFA::DimensionID::Y, DFA::DimensionID::X},
+        {DFA::DimensionID::K, DFA::DimensionID::C, DFA::DimensionID::R, DFA::DimensionID::S},
+        {DFA::DimensionID::N, DFA::DimensionID::K, DFA::DimensionID::Y, DFA::DimensionID::X}
+      };
+    };
+
+    using ConvLayout = LayerLayout<LayerType::CONV, 7, 2>;
+
+    /*
+     * The dataflow of one cluster level and the coupled dimensions of each tensor, resolved
+     * against a Layout: the dimension and class of every directive, and the directive index of
+     * every coupled dimension. The arrays are sized by the Layout, so loops over them have a
+     * trip count known at compile time.
+     */
+    template<typename Layout>
+    class ClusterLayout {
+      static_assert(Layout::is_specialized, "ClusterLayout needs a specialized LayerLayout");
+
+      public:
+        struct Directive {
+          DFA::DimensionID dim;
+          DFA::directive::DirectiveClass directive_class;
+        };
+
+        struct CoupledDim {
+          DFA::DimensionID dim;
+          int directive_idx;
+          DFA::directive::DirectiveClass directive_class;
+        };
+
+        using Coupling = std::array<CoupledDim, Layout::num_coupled_dims>;
+
+        static bool Matches(LayerType layer_type, int num_cluster_levels) {
+          return layer_type == Layout::layer_type && num_cluster_levels == Layout::num_cluster_levels;
+        }
+
+        // Fails if the dataflow or a tensor of the table does not have the shape of Layout
+        static std::optional<ClusterLayout> Resolve(
+            std::shared_ptr<DFA::DirectiveTable> dataflow,
+            std::shared_ptr<DFA::TensorTable> tensors) {
+          if(dataflow->size() != Layout::num_dimensions) {
+            return std::nullopt;
+          }
+
+          ClusterLayout ret;
+
+          std::array<int, DFA::num_dimension_ids> directive_idx;
+          directive_idx.fill(-1);
+          for(int idx = 0; idx < Layout::num_dimensions; idx++) {
+            auto directive = dataflow->at(idx);
+            auto dim = directive->GetVariableID();
+            auto directive_class = directive->GetClass();
+            if(dim == DFA::invalid_dimension_id
+                || (directive_class != DFA::directive::DirectiveClass::TemporalMap
+                    && directive_class != DFA::directive::DirectiveClass::SpatialMap)) {
+              return std::nullopt;
+            }
+
+            ret.directives_[idx] = {dim, directive_class};
+            if(directive_idx[static_cast<int>(dim)] == -1) {
+              directive_idx[static_cast<int>(dim)] = idx;
+            }
+          }
+
+          for(int data_class = 0; data_class < static_cast<int>(DataClass::NumDataClasses); data_class++) {
+            ret.coupling_masks_[data_class] = 0;
+            for(int i = 0; i < Layout::num_coupled_dims; i++) {
+              auto dim = Layout::coupling[data_class][i];
+              int idx = directive_idx[static_cast<int>(dim)];
+              if(idx == -1) {
+                return std::nullopt;
+              }
+
+              ret.coupling_[data_class][i] = {dim, idx, ret.directives_[idx].directive_class};
+              ret.coupling_masks_[data_class] |= DFA::GetDimensionMask(dim);
+            }
+          }
+
+          for(auto& tensor : *tensors) {
+            int data_class = static_cast<int>(tensor->GetDataClass());
+            auto coupled_vars = tensor->GetCoupledVariables();
+            if(coupled_vars->size() != Layout::num_coupled_dims) {
+              return std::nullopt;
+            }
+
+            int i = 0;
+            for(auto& var : *coupled_vars) {
+              if(DFA::GetDimensionID(var) != Layout::coupling[data_class][i]) {
+                return std::nullopt;
+              }
+              i++;
+            }
+          }
+
+          return ret;
+        }
+
+        std::array<Directive, Layout::num_dimensions> const & GetDirectives() const {
+          return directives_;
+        }
+
+        // Whether the coupling of the tensor is the one of its data class in Layout
+        bool Covers(std::shared_ptr<DFA::Tensor> const & tensor) const {
+          return tensor->GetCoupledVariableMask() == coupling_masks_[static_cast<int>(tensor->GetDataClass())];
+        }
+
+        Coupling const & GetCoupling(std::shared_ptr<DFA::Tensor> const & tensor) const {
+          return coupling_[static_cast<int>(tensor->GetDataClass())];
+        }
+
+      protected:
+        std::array<Directive, Layout::num_dimensions> directives_;
+        std::array<Coupling, static_cast<int>(DataClass::NumDataClasses)> coupling_;
+        std::array<DFA::DimensionMask, static_cast<int>(DataClass::NumDataClasses)> coupling_masks_;
+    }; // End of class ClusterLayout
+
+  }; // End of namespace CA
+}; // End of namespace maestro
+
+#endif
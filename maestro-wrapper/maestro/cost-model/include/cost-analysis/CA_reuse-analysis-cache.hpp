@@ -0,0 +1,125 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*******************************************************************************/
+
+
+#ifndef MAESTRO_CA_REUSE_ANALYSIS_CACHE_HPP_
+#define MAESTRO_CA_REUSE_ANALYSIS_CACHE_HPP_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DFA_dimension-table.hpp"
+
+namespace maestro {
+  namespace CA {
+
+    // What the reuse analysis of a cluster level yields for an iteration case; it only depends
+    // on the level itself, not on the levels below
+    struct IterationCaseReuse {
+      bool is_all_init = false;
+      // Per output tensor; partial sum mapping sizes are running sums over the tensors
+      std::vector<long> egress_traffic;
+      std::vector<long> partial_sum_mapping_sizes;
+      long partial_sum_mapping_size = 0;
+      long num_partial_sums = 0;
+      // Per input tensor
+      std::vector<long> ingress_traffic;
+      long ingress_spatial_traffic = 0;
+      long egress_spatial_traffic = 0;
+      long ingress_comm_delay = 0;
+      long egress_comm_delay = 0;
+      // State of the spatially mapped dimension and the dimension tables of the sub-clusters
+      bool is_spatial_edge = false;
+      bool has_spatial_edge_edge = false;
+      std::shared_ptr<DFA::DimensionTable> sp_edge_edge_sub_cluster_dimensions;
+      std::shared_ptr<DFA::DimensionTable> sub_cluster_dimensions;
+    };
+
+    /*
+     * Keeps the reuse analysis of every cluster level analyzed by the last evaluation of an
+     * APIV2, so that the next one only redoes the levels that changed. A point that differs
+     * from the last one in a single tile size or sub-cluster count leaves the levels above the
+     * changed one as they were: those only combine the new results of their sub-clusters with
+     * the reuse they already know.
+     *
+     * Entries are keyed like the sub-cluster cache, with the signature of a single level, and
+     * hold one IterationCaseReuse per iteration case class of the level. Sub-cluster dimension
+     * tables in an entry must be built in a HeapScope. Entries that the current evaluation did
+     * not use are dropped when the next one begins. Not thread-safe; every thread evaluates
+     * with its own APIV2.
+     */
+    class ReuseAnalysisCache {
+      public:
+        struct Entry {
+          // In the order the classes first occur among the iteration cases
+          std::vector<IterationCaseReuse> cases;
+        };
+
+        void BeginEvaluation() {
+          previous_entries_ = std::move(current_entries_);
+          current_entries_.clear();
+        }
+
+        // Returns nullptr on a miss
+        std::shared_ptr<Entry const> Lookup(std::string const & key) {
+          auto entry = current_entries_.find(key);
+          if(entry != current_entries_.end()) {
+            num_hits_++;
+            return entry->second;
+          }
+
+          entry = previous_entries_.find(key);
+          if(entry == previous_entries_.end()) {
+            num_misses_++;
+            return nullptr;
+          }
+
+          num_hits_++;
+          auto ret = entry->second;
+          current_entries_.emplace(key, ret);
+          return ret;
+        }
+
+        void Insert(std::string const & key, std::shared_ptr<Entry const> entry) {
+          current_entries_.emplace(key, std::move(entry));
+        }
+
+        long GetNumHits() {
+          return num_hits_;
+        }
+
+        long GetNumMisses() {
+          return num_misses_;
+        }
+
+      protected:
+        std::unordered_map<std::string, std::shared_ptr<Entry const>> current_entries_;
+        std::unordered_map<std::string, std::shared_ptr<Entry const>> previous_entries_;
+        long num_hits_ = 0;
+        long num_misses_ = 0;
+    }; // End of class ReuseAnalysisCache
+
+  }; // End of namespace CA
+}; // End of namespace maestro
+
+#endif
@@ -28,18 +28,22 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <memory>
 #include <map>
 #include <cmath>
+#include <optional>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFSL_syntax_tokens.hpp"
 
+#include "DFA_dimension-id.hpp"
 #include "DFA_directives.hpp"
 #include "DFA_tensor.hpp"
 #include "DFA_cluster-unit.hpp"
 #include "DFA_iteration-status.hpp"
 
 #include "CA_analysis-types.hpp"
+#include "CA_layer-layout.hpp"
 
 
 namespace  maestro {
@@ -53,14 +57,6 @@ namespace  maestro {
           write_log_file_(write_log_file),
           logfile_(logfile) {
           assert(! write_log_file || logfile != "");
-          num_mapped_elements_ = std::make_unique<std::map<std::string, int>>();
-          num_mapped_elements_edge_ = std::make_unique<std::map<std::string, int>>();
-
-          num_unique_elements_ = std::make_unique<std::map<std::string, int>>();
-          num_unique_elements_edge_ = std::make_unique<std::map<std::string, int>>();
-
-          num_reused_elements_ = std::make_unique<std::map<std::string, int>>();
-          num_reused_elements_edge_ = std::make_unique<std::map<std::string, int>>();
 
           AnalyzeInputMappingSizes(target_cluster);
           AnalyzeOutputMappingSizes(target_cluster);
@@ -69,41 +65,40 @@ namespace  maestro {
           if(write_log_file) {
             assert(logfile != "");
             std::ofstream log_file(logfile, std::fstream::app);
-            for(auto it : *num_mapped_elements_ ){
-              log_file << "NumMapped_elements[" << it.first << "] = " <<  it.second << std::endl;
-            }
-            for(auto it : *num_mapped_elements_edge_ ){
-              log_file << "NumMapped_elements_edge[" << it.first << "] = " <<  it.second << std::endl;
-            }
-
-            for(auto it : *num_unique_elements_ ){
-              log_file << "num_unique_elements_[" << it.first << "] = " <<  it.second << std::endl;
-            }
-
-            for(auto it : *num_unique_elements_edge_){
-              log_file << "num_unique_elements_edge[" << it.first << "] = " <<  it.second << std::endl;
-            }
-
-            for(auto it : *num_reused_elements_ ){
-              log_file << "Num_reused_elements[" << it.first << "] = " <<  it.second << std::endl;
-            }
-
-            for(auto it : *num_reused_elements_edge_ ){
-              log_file << "Num_reused_elements_edge_[" << it.first << "] = " <<  it.second << std::endl;
-            }
+            auto log_elements = [&](std::string const & label, DFA::DimensionMap<int>& elements) {
+              for(int id = 0; id < DFA::num_dimension_ids; id++) {
+                auto dim = static_cast<DFA::DimensionID>(id);
+                if(elements.Contains(dim)) {
+                  log_file << label << "[" << DFA::GetDimensionName(dim) << "] = " <<  elements[dim] << std::endl;
+                }
+              }
+            };
+            log_elements("NumMapped_elements", num_mapped_elements_);
+            log_elements("NumMapped_elements_edge", num_mapped_elements_edge_);
+            log_elements("num_unique_elements_", num_unique_elements_);
+            log_elements("num_unique_elements_edge", num_unique_elements_edge_);
+            log_elements("Num_reused_elements", num_reused_elements_);
+            log_elements("Num_reused_elements_edge_", num_reused_elements_edge_);
             log_file.close();
           }
 
 #endif
         }
 
+        // Analyzes through the fixed-size tables of ConvLayout if the target cluster and the
+        // tensors have its shape; returns whether they do
+        bool SpecializeLayout(std::shared_ptr<DFA::TensorTable> tensors) {
+          conv_layout_ = ClusterLayout<ConvLayout>::Resolve(target_cluster_->GetDataflow(), tensors);
+          return conv_layout_.has_value();
+        }
+
         long GetMappedVolume(std::shared_ptr<DFA::Tensor> tensor) {
           long ret = 1;
 
           auto coupled_var_list = tensor->GetCoupledVariables();
           for(auto var: *coupled_var_list){
-            if(num_mapped_elements_->find(var) != num_mapped_elements_->end()) {
-              ret *= num_mapped_elements_->at(var);
+            if(num_mapped_elements_.Contains(var)) {
+              ret *= num_mapped_elements_[var];
             }
           }
 
@@ -113,13 +108,13 @@ namespace  maestro {
         std::shared_ptr<DFA::DimensionTable> ConstructSubClusterDimension(
             std::shared_ptr<DFA::IterationStatus> iter_status,
             bool is_sp_edge_edge = false) {
-          std::shared_ptr<DFA::DimensionTable> ret = std::make_shared<DFA::DimensionTable>();
+          std::shared_ptr<DFA::DimensionTable> ret = MakeShared<DFA::DimensionTable>();
 
           auto dataflow = target_cluster_->GetDataflow();
           auto curr_dimension = target_cluster_->GetDimensions();
 
           for(auto& directive : * dataflow) {
-            auto dim = directive->GetVariable();
+            auto dim = directive->GetVariableID();
             auto directive_class = directive->GetClass();
             auto iter_state = iter_status->GetIterState(dim);
             auto iter_pos = iter_state->GetIterPosition();
@@ -128,10 +123,10 @@ namespace  maestro {
 
             if(directive_class == DFA::directive::DirectiveClass::TemporalMap) {
               if(iter_state->IsEdge()) {
-                dim_sz = (*num_mapped_elements_edge_)[dim];
+                dim_sz = num_mapped_elements_edge_[dim];
               }
               else {
-                dim_sz = (*num_mapped_elements_)[dim];
+                dim_sz = num_mapped_elements_[dim];
               }
             } // End of if(directive_class == TemporalMap)
             else if (directive_class == DFA::directive::DirectiveClass::SpatialMap) {
@@ -142,33 +137,33 @@ namespace  maestro {
                 case DFA::IterationPosition::Init: {
                   if(iter_state->IsEdge()) {
                     if(num_edge_sub_clusters == 1) {
-                      dim_sz = (*num_mapped_elements_edge_)[dim];
+                      dim_sz = num_mapped_elements_edge_[dim];
                     }
                     else if(is_sp_edge_edge) {
-                      dim_sz = (*num_mapped_elements_edge_)[dim];
+                      dim_sz = num_mapped_elements_edge_[dim];
                     }
                     else {
-                      dim_sz = (*num_mapped_elements_)[dim];
+                      dim_sz = num_mapped_elements_[dim];
                     }
                   }
                   else {
-                    dim_sz = (*num_mapped_elements_)[dim];
+                    dim_sz = num_mapped_elements_[dim];
                   }
                   break;
                 }
                 case DFA::IterationPosition::Steady: {
-                  dim_sz = (*num_mapped_elements_)[dim];
+                  dim_sz = num_mapped_elements_[dim];
                   break;
                 }
                 case DFA::IterationPosition::Edge: {
                   if(num_edge_sub_clusters == 1) {
-                    dim_sz = (*num_mapped_elements_edge_)[dim];
+                    dim_sz = num_mapped_elements_edge_[dim];
                   }
                   else if(is_sp_edge_edge) {
-                    dim_sz = (*num_mapped_elements_edge_)[dim];
+                    dim_sz = num_mapped_elements_edge_[dim];
                   }
                   else {
-                    dim_sz = (*num_mapped_elements_)[dim];
+                    dim_sz = num_mapped_elements_[dim];
                   }
                   break;
                 }
@@ -179,26 +174,22 @@ namespace  maestro {
             } // End of else if(directive_class == SpatialMap)
 
             auto outer_stride = curr_dimension->GetOuterStride(dim);
-            auto inner_stride = curr_dimension->GetOuterStride(dim);
-            auto dim_sub_cluster = std::make_shared<DFA::LayerDimension>(dim, dim_sz,outer_stride, inner_stride);
 
-            ret->AddDimension(dim_sub_cluster);
+            ret->AddDimension(dim, dim_sz, outer_stride);
           } // End of for_each (directive) in (dataflow)
 
           for(auto& directive : *dataflow) {
             auto dim = directive->GetVariable();
 
             if(dim == DFSL::layer_dim_input_height_) {
-              int output_sz = ret->GetSize(dim) - ret->GetSize(DFSL::layer_dim_weight_height_) + 1;
-              auto output_dim_sub_cluster = std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_output_height_, output_sz, 1, 1);
+              int output_sz = ret->GetSize(DFA::DimensionID::Y) - ret->GetSize(DFA::DimensionID::R) + 1;
 
-              ret->AddDimension(output_dim_sub_cluster);
+              ret->AddDimension(DFA::DimensionID::OutputY, output_sz, 1);
             }
             else if (dim == DFSL::layer_dim_input_width_) {
-              int output_sz = ret->GetSize(dim) - ret->GetSize(DFSL::layer_dim_weight_width_) + 1;
-              auto output_dim_sub_cluster = std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_output_width_, output_sz, 1, 1);
+              int output_sz = ret->GetSize(DFA::DimensionID::X) - ret->GetSize(DFA::DimensionID::S) + 1;
 
-              ret->AddDimension(output_dim_sub_cluster);
+              ret->AddDimension(DFA::DimensionID::OutputX, output_sz, 1);
             }
 
             if(curr_dimension->IsOverlapped(dim)) {
@@ -277,63 +268,54 @@ namespace  maestro {
             std::shared_ptr<DFA::IterationStatus> iter_status,
             bool is_first_pe = true,
             bool is_sp_edge_edge_pe = false) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = input_tensor->GetCoupledVariables();
+          auto coupled_dims = input_tensor->GetCoupledVariableMask();
 
           long ret = 1;
 
-          int directive_idx = 0;
-          for(auto& directive : *dataflow) {
-            auto directive_class = directive->GetClass();
-            auto cur_dim = directive->GetVariable();
-
+          ForEachDirective([&](int, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
             if(directive_class == DFA::directive::DirectiveClass::TemporalMap) {
-              auto dim = directive->GetVariable();
               auto iter_state = iter_status->GetIterState(dim);
 
-              bool is_coupled = std::find(coupled_dims->begin(), coupled_dims->end(), dim) != coupled_dims->end();
+              bool is_coupled = (coupled_dims & DFA::GetDimensionMask(dim)) != 0;
 
               if(is_coupled) {
                 if(iter_state->IsEdge()) {
-                  ret *= (*num_mapped_elements_edge_)[dim];
+                  ret *= num_mapped_elements_edge_[dim];
                 }
                 else {
-                  ret *= (*num_mapped_elements_)[dim];
+                  ret *= num_mapped_elements_[dim];
                 }
               } // End of if(is_coupled)
             } // End of if(directive_class == TemporalMap)
             else if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              auto dim = directive->GetVariable();
               auto iter_state = iter_status->GetIterState(dim);
               // auto iter_pos = iter_state->GetIterPosition();
 
-              bool is_coupled = std::find(coupled_dims->begin(), coupled_dims->end(), dim) != coupled_dims->end();
+              bool is_coupled = (coupled_dims & DFA::GetDimensionMask(dim)) != 0;
 
               if(is_coupled) {
                 if(iter_state->IsEdge()) {
                   int num_active_clusters = target_cluster_->GetNumClusters(true);
 
                   if(num_active_clusters == 1 && (is_first_pe  || is_sp_edge_edge_pe)) {
-                    ret *= (*num_mapped_elements_edge_)[dim];
+                    ret *= num_mapped_elements_edge_[dim];
                   }
                   else if (num_active_clusters > 1) {
                     if(is_sp_edge_edge_pe) {
-                      ret *= (*num_mapped_elements_edge_)[dim];
+                      ret *= num_mapped_elements_edge_[dim];
                     }
                     else {
-                      ret *= (*num_mapped_elements_)[dim];
+                      ret *= num_mapped_elements_[dim];
                     }
                   }
                 }
                 else {
-                  ret *= (*num_mapped_elements_)[dim];
+                  ret *= num_mapped_elements_[dim];
                 }
               } // End of if(is_coupled)
             } // End of else if(directive_class == SpatialMap)
-
-            directive_idx++;
-          } // End of for_each (directive) in (dataflow)
+          }); // End of for_each (directive) in (dataflow)
 
           return ret;
         }
@@ -346,9 +328,8 @@ namespace  maestro {
             std::shared_ptr<DFA::IterationStatus> iter_status,
             bool is_first_pe = true,
             bool is_sp_edge_edge_pe = false) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = input_tensor->GetCoupledVariables();
+          auto coupled_dims = input_tensor->GetCoupledVariableMask();
 
           long ret = 1;
 
@@ -361,14 +342,11 @@ namespace  maestro {
           }
 
           bool is_this_tensor_changing = false;
-          int directive_idx = 0;
-          for(auto& directive : *dataflow) {
-            auto dim = directive->GetVariable();
-            auto directive_class = directive->GetClass();
+          ForEachDirective([&](int directive_idx, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
             auto iter_state = iter_status->GetIterState(dim);
             auto iter_pos = iter_state->GetIterPosition();
 
-            bool is_coupled_dim = ( std::find(coupled_dims->begin(), coupled_dims->end(), dim) != coupled_dims->end() );
+            bool is_coupled_dim = (coupled_dims & DFA::GetDimensionMask(dim)) != 0;
             bool is_changing_dim = directive_idx == changing_dim_directive_idx;
             bool is_reset_dim = directive_idx > changing_dim_directive_idx;
             // bool is_unroll = iter_state->IsUnrolled();
@@ -382,23 +360,23 @@ namespace  maestro {
                 switch(iter_pos) {
                   case DFA::IterationPosition::Init: {
                     if(iter_state->IsEdge()) {
-                      ret *= (*num_mapped_elements_edge_)[dim];
+                      ret *= num_mapped_elements_edge_[dim];
                     }
                     else {
-                      ret *= (*num_mapped_elements_)[dim];
+                      ret *= num_mapped_elements_[dim];
                     }
                     break;
                   }
                   case DFA::IterationPosition::Steady:
                   case DFA::IterationPosition::Edge: {
                     if(is_changing_dim  && !is_tensor_overall_inited) {
-                      if((*num_unique_elements_)[dim] == 0) {
+                      if(num_unique_elements_[dim] == 0) {
                         error_handler_->TerminateProgram();
                       }
-                      ret *= std::max((*num_unique_elements_)[dim], 1);
+                      ret *= std::max(num_unique_elements_[dim], 1);
                     }
                     else {
-                      ret *= (*num_mapped_elements_)[dim];
+                      ret *= num_mapped_elements_[dim];
                     }
                     break;
                   }
@@ -414,16 +392,16 @@ namespace  maestro {
                 switch(iter_pos) {
                   case DFA::IterationPosition::Init: {
                     if(is_first_pe) {
-                      long mult = is_sp_edge_edge_pe? (*num_mapped_elements_edge_)[dim] : (*num_mapped_elements_)[dim];
+                      long mult = is_sp_edge_edge_pe? num_mapped_elements_edge_[dim] : num_mapped_elements_[dim];
                       ret *= mult;
                     }
                     else {
                       if(!is_reset_dim && !is_all_reset) {
-                        long mult = is_sp_edge_edge_pe? (*num_mapped_elements_edge_)[dim] : (*num_mapped_elements_)[dim];
+                        long mult = is_sp_edge_edge_pe? num_mapped_elements_edge_[dim] : num_mapped_elements_[dim];
                         ret *= mult;
                       }
                       else {
-                        long mult = is_sp_edge_edge_pe? (*num_unique_elements_edge_)[dim] : (*num_unique_elements_)[dim];
+                        long mult = is_sp_edge_edge_pe? num_unique_elements_edge_[dim] : num_unique_elements_[dim];
                         ret *= mult;
                       }
                     }
@@ -432,16 +410,16 @@ namespace  maestro {
                   case DFA::IterationPosition::Steady:
                   case DFA::IterationPosition::Edge: {
                     if(is_first_pe) {
-                      long mult = is_sp_edge_edge_pe? (*num_mapped_elements_edge_)[dim] : (*num_mapped_elements_)[dim];
+                      long mult = is_sp_edge_edge_pe? num_mapped_elements_edge_[dim] : num_mapped_elements_[dim];
                       ret *= mult;
                     }
                     else {
                       if(!is_tensor_overall_inited && is_changing_dim) {
-                        long mult = is_sp_edge_edge_pe? (*num_unique_elements_edge_)[dim] : (*num_unique_elements_)[dim];
+                        long mult = is_sp_edge_edge_pe? num_unique_elements_edge_[dim] : num_unique_elements_[dim];
                         ret *= mult;
                       }
                       else {
-                        long mult = is_sp_edge_edge_pe? (*num_mapped_elements_edge_)[dim] : (*num_mapped_elements_)[dim];
+                        long mult = is_sp_edge_edge_pe? num_mapped_elements_edge_[dim] : num_mapped_elements_[dim];
                         ret *= mult;
                       }
                     }
@@ -456,9 +434,7 @@ namespace  maestro {
                 error_handler_->TerminateProgram();
               }
             } // End of if(is_coupled_dim)
-
-            directive_idx++;
-          } // End of for_each (directive) in (dataflow)
+          }); // End of for_each (directive) in (dataflow)
 
           if(!is_this_tensor_changing) ret = 0;
 
@@ -470,30 +446,14 @@ namespace  maestro {
             std::shared_ptr<DFA::Tensor> input_tensor,
             std::shared_ptr<DFA::IterationStatus> iter_status
             ) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = input_tensor->GetCoupledVariables();
 
           long ret = 1;
 
-          std::shared_ptr<DFA::IterationState> sp_iter_state;
-          bool is_sp_mapped = false;
-          bool is_sp_edge = false;
-
-          for(auto& dim : *coupled_dims) {
-            auto iter_state = iter_status->GetIterState(dim);
-            auto dataflow = target_cluster_->GetDataflow();
-            auto directive = dataflow->FindDirective(dim);
-            auto directive_class = directive->GetClass();
-
-            if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              is_sp_mapped = true;
-              sp_iter_state = iter_status->GetIterState(dim);
-              if(iter_state->IsEdge()) {
-                is_sp_edge = true;
-              }
-            }
-          }
+          auto sp_mapping = GetSpatialMapping(input_tensor, iter_status);
+          auto sp_iter_state = sp_mapping.sp_iter_state;
+          bool is_sp_mapped = sp_mapping.is_sp_mapped;
+          bool is_sp_edge = sp_mapping.is_sp_edge;
 
           std::ofstream log_file;
 
@@ -555,30 +515,14 @@ namespace  maestro {
             std::shared_ptr<DFA::Tensor> input_tensor,
             std::shared_ptr<DFA::IterationStatus> iter_status
             ) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = input_tensor->GetCoupledVariables();
 
           long ret = 1;
 
-          std::shared_ptr<DFA::IterationState> sp_iter_state;
-          bool is_sp_mapped = false;
-          bool is_sp_edge = false;
-
-          for(auto& dim : *coupled_dims) {
-            auto iter_state = iter_status->GetIterState(dim);
-            auto dataflow = target_cluster_->GetDataflow();
-            auto directive = dataflow->FindDirective(dim);
-            auto directive_class = directive->GetClass();
-
-            if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              is_sp_mapped = true;
-              sp_iter_state = iter_status->GetIterState(dim);
-              if(iter_state->IsEdge()) {
-                is_sp_edge = true;
-              }
-            }
-          }
+          auto sp_mapping = GetSpatialMapping(input_tensor, iter_status);
+          auto sp_iter_state = sp_mapping.sp_iter_state;
+          bool is_sp_mapped = sp_mapping.is_sp_mapped;
+          bool is_sp_edge = sp_mapping.is_sp_edge;
           int num_clusters = target_cluster_->GetNumClusters(false);
 
           if(!is_sp_mapped) {
@@ -618,31 +562,27 @@ namespace  maestro {
              bool is_sp_edge_edge_pe = false,
              bool consider_reuse_at_edge = true
              ) {
-           auto dataflow = target_cluster_->GetDataflow();
            auto dimensions = target_cluster_->GetDimensions();
-           auto output_coupled_var_list = output_tensor->GetCoupledVariables();
+           auto output_coupled_var_mask = output_tensor->GetCoupledVariableMask();
 
            long ret = 1;
 
            if(get_num_partial_sums) {
-             for(auto& directive : *dataflow) {
-               auto dim = directive->GetVariable();
-               auto directive_class = directive->GetClass();
-
+             ForEachDirective([&](int, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
                if(directive_class == DFA::directive::DirectiveClass::TemporalMap) {
-                 if(std::find(output_coupled_var_list->begin(), output_coupled_var_list->end(), dim) == output_coupled_var_list->end()) {
+                 if((output_coupled_var_mask & DFA::GetDimensionMask(dim)) == 0) {
 
                    auto iter_state = iter_status->GetIterState(dim);
                    if(iter_state->IsEdge()) {
-                     ret *= (*num_mapped_elements_edge_)[dim];
+                     ret *= num_mapped_elements_edge_[dim];
                    }
                    else {
-                     ret *= (*num_mapped_elements_)[dim];
+                     ret *= num_mapped_elements_[dim];
                    }
                  }
                } // End of if(directive_class == TemporalMap)
                else if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-                 if(std::find(output_coupled_var_list->begin(), output_coupled_var_list->end(), dim) == output_coupled_var_list->end()) {
+                 if((output_coupled_var_mask & DFA::GetDimensionMask(dim)) == 0) {
 
                    auto iter_state = iter_status->GetIterState(dim);
                    auto iter_position = iter_state->GetIterPosition();
@@ -652,39 +592,39 @@ namespace  maestro {
                          int num_active_sub_clusters = target_cluster_->GetNumClusters(true);
 
                          if(num_active_sub_clusters == 1 && (is_first_pe  || is_sp_edge_edge_pe)) {
-                           ret *= (*num_mapped_elements_edge_)[dim];
+                           ret *= num_mapped_elements_edge_[dim];
                          }
                          else if (num_active_sub_clusters > 1) {
                            if(is_sp_edge_edge_pe) {
-                             ret *= (*num_mapped_elements_edge_)[dim];
+                             ret *= num_mapped_elements_edge_[dim];
                            }
                            else if (is_first_pe) {
-                             ret *= (*num_mapped_elements_)[dim];
+                             ret *= num_mapped_elements_[dim];
                            }
                            else {
-                             if((*num_unique_elements_)[dim] != 0)
-                               ret *= (*num_unique_elements_)[dim];
+                             if(num_unique_elements_[dim] != 0)
+                               ret *= num_unique_elements_[dim];
                            }
                          }
                        }
                        else {
                          if(is_first_pe) {
-                           ret *= (*num_mapped_elements_)[dim];
+                           ret *= num_mapped_elements_[dim];
                          }
                          else {
-                           if((*num_unique_elements_)[dim] != 0)
-                             ret *= (*num_unique_elements_)[dim];
+                           if(num_unique_elements_[dim] != 0)
+                             ret *= num_unique_elements_[dim];
                          }
                        }
                        break;
                      }
                      case DFA::IterationPosition::Steady: {
                        if(is_first_pe) {
-                         ret *= (*num_mapped_elements_)[dim];
+                         ret *= num_mapped_elements_[dim];
                        }
                        else {
-                         if((*num_unique_elements_)[dim] != 0)
-                           ret *= (*num_unique_elements_)[dim];
+                         if(num_unique_elements_[dim] != 0)
+                           ret *= num_unique_elements_[dim];
                        }
 
                        break;
@@ -692,18 +632,18 @@ namespace  maestro {
                      case DFA::IterationPosition::Edge: {
                        int num_active_sub_clusters = target_cluster_->GetNumClusters(true);
                        if(num_active_sub_clusters == 1 && (is_first_pe  || is_sp_edge_edge_pe)) {
-                         ret *= (*num_mapped_elements_edge_)[dim];
+                         ret *= num_mapped_elements_edge_[dim];
                        }
                        else if (num_active_sub_clusters > 1) {
                          if(is_sp_edge_edge_pe) {
-                           ret *= (*num_unique_elements_edge_)[dim];
+                           ret *= num_unique_elements_edge_[dim];
                          }
                          else if (is_first_pe) {
-                           ret *= (*num_mapped_elements_)[dim];
+                           ret *= num_mapped_elements_[dim];
                          }
                          else {
-                           if((*num_unique_elements_)[dim] != 0)
-                             ret *= (*num_unique_elements_)[dim];
+                           if(num_unique_elements_[dim] != 0)
+                             ret *= num_unique_elements_[dim];
                          }
                        }
                        break;
@@ -715,23 +655,20 @@ namespace  maestro {
                    }
                  } // End of if(directive_var is not in output coupled variables)
                } // End of else if(directive_class == SpatialMap)
-             } // End of for each (directive) in (dataflow)
+             }); // End of for each (directive) in (dataflow)
            } // End of if(get_partial_sums)
 
-           for(auto& dim : *output_coupled_var_list) {
-             int directive_idx = dataflow->GetDirectiveIdx(dim);
-             auto directive = dataflow->at(directive_idx);
-             auto directive_class = directive->GetClass();
+           ForEachCoupledDim(output_tensor, [&](int, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
              auto iter_state = iter_status->GetIterState(dim);
              auto iter_position = iter_state->GetIterPosition();
 
-             std::string actual_dim = dim;
+             auto actual_dim = dim;
 
-             if(dim == DFSL::layer_dim_input_height_) {
-               actual_dim = DFSL::layer_dim_output_height_;
+             if(dim == DFA::DimensionID::Y) {
+               actual_dim = DFA::DimensionID::OutputY;
              }
-             else if(dim == DFSL::layer_dim_input_width_) {
-               actual_dim = DFSL::layer_dim_output_width_;
+             else if(dim == DFA::DimensionID::X) {
+               actual_dim = DFA::DimensionID::OutputX;
              }
 
              /*
@@ -739,10 +676,10 @@ namespace  maestro {
                auto sliding_dim = dimensions->GetOverlappingDim(dim);
                auto sliding_iter_state = iter_status->GetIterState(sliding_dim);
                if(sliding_iter_state->IsEdge()) {
-                 ret *= (*num_mapped_elements_edge_)[sliding_dim];
+                 ret *= num_mapped_elements_edge_[sliding_dim];
                }
                else {
-                 ret *= (*num_mapped_elements_)[sliding_dim];
+                 ret *= num_mapped_elements_[sliding_dim];
                }
              }
               */
@@ -751,19 +688,19 @@ namespace  maestro {
                switch(iter_position) {
                  case DFA::IterationPosition::Init: {
                    if(iter_state->IsEdge()) {
-                     ret *= (*num_mapped_elements_edge_)[actual_dim];
+                     ret *= num_mapped_elements_edge_[actual_dim];
                    }
                    else {
-                     ret *= (*num_mapped_elements_)[actual_dim];
+                     ret *= num_mapped_elements_[actual_dim];
                    }
                    break;
                  }
                  case DFA::IterationPosition::Steady: {
-                   ret *= (*num_mapped_elements_)[actual_dim];
+                   ret *= num_mapped_elements_[actual_dim];
                    break;
                  }
                  case DFA::IterationPosition::Edge: {
-                   ret *= (*num_mapped_elements_edge_)[actual_dim];
+                   ret *= num_mapped_elements_edge_[actual_dim];
                    break;
                  }
                  default: {
@@ -779,60 +716,60 @@ namespace  maestro {
                      int num_active_sub_clusters = target_cluster_->GetNumClusters(true);
 
                      if(num_active_sub_clusters == 1 && (is_first_pe  || is_sp_edge_edge_pe)) {
-                       ret *= (*num_mapped_elements_edge_)[actual_dim];
+                       ret *= num_mapped_elements_edge_[actual_dim];
                      }
                      else if (num_active_sub_clusters > 1) {
                        if(is_sp_edge_edge_pe) {
                          if(consider_reuse_at_edge)
-                           ret *= (*num_unique_elements_edge_)[actual_dim];
+                           ret *= num_unique_elements_edge_[actual_dim];
                          else
-                           ret *= (*num_mapped_elements_edge_)[actual_dim];
+                           ret *= num_mapped_elements_edge_[actual_dim];
                        }
                        else if (is_first_pe) {
-                         ret *= (*num_mapped_elements_)[actual_dim];
+                         ret *= num_mapped_elements_[actual_dim];
                        }
                        else {
-                         if((*num_unique_elements_)[actual_dim] != 0)
-                           ret *= (*num_unique_elements_)[actual_dim];
+                         if(num_unique_elements_[actual_dim] != 0)
+                           ret *= num_unique_elements_[actual_dim];
                        }
                      }
                    }
                    else {
                      if(is_first_pe) {
-                       ret *= (*num_mapped_elements_)[actual_dim];
+                       ret *= num_mapped_elements_[actual_dim];
                      }
                      else {
-                       if((*num_unique_elements_)[actual_dim] != 0)
-                         ret *= (*num_unique_elements_)[actual_dim];
+                       if(num_unique_elements_[actual_dim] != 0)
+                         ret *= num_unique_elements_[actual_dim];
                      }
                    }
                    break;
                  }
                  case DFA::IterationPosition::Steady: {
                    if(is_first_pe) {
-                     ret *= (*num_mapped_elements_)[actual_dim];
+                     ret *= num_mapped_elements_[actual_dim];
                    }
                    else {
-                     if((*num_unique_elements_)[actual_dim] != 0)
-                       ret *= (*num_unique_elements_)[actual_dim];
+                     if(num_unique_elements_[actual_dim] != 0)
+                       ret *= num_unique_elements_[actual_dim];
                    }
                    break;
                  }
                  case DFA::IterationPosition::Edge: {
                    int num_active_sub_clusters = target_cluster_->GetNumClusters(true);
                    if(num_active_sub_clusters == 1 && (is_first_pe  || is_sp_edge_edge_pe)) {
-                     ret *= (*num_mapped_elements_edge_)[dim];
+                     ret *= num_mapped_elements_edge_[dim];
                    }
                    else if (num_active_sub_clusters > 1) {
                      if(is_sp_edge_edge_pe) {
-                       ret *= (*num_unique_elements_edge_)[actual_dim];
+                       ret *= num_unique_elements_edge_[actual_dim];
                      }
                      else if (is_first_pe) {
-                       ret *= (*num_mapped_elements_)[actual_dim];
+                       ret *= num_mapped_elements_[actual_dim];
                      }
                      else {
-                       if((*num_unique_elements_)[actual_dim] != 0)
-                         ret *= (*num_unique_elements_)[actual_dim];
+                       if(num_unique_elements_[actual_dim] != 0)
+                         ret *= num_unique_elements_[actual_dim];
                      }
                    }
                    break;
@@ -843,7 +780,7 @@ namespace  maestro {
                  }
                } // End of switch(iter_position)
              } // End of else if (directive_class == SpatialMap)
-           } // End of for_each (var) in (output_coupled_list)
+           }); // End of for_each (var) in (output_coupled_list)
 
            return ret;
          }
@@ -852,30 +789,14 @@ namespace  maestro {
             std::shared_ptr<DFA::Tensor> output_tensor,
             std::shared_ptr<DFA::IterationStatus> iter_status
             ) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = output_tensor->GetCoupledVariables();
 
           long ret = 1;
 
-          std::shared_ptr<DFA::IterationState> sp_iter_state;
-          bool is_sp_mapped = false;
-          bool is_sp_edge = false;
-
-          for(auto& dim : *coupled_dims) {
-            auto iter_state = iter_status->GetIterState(dim);
-            auto dataflow = target_cluster_->GetDataflow();
-            auto directive = dataflow->FindDirective(dim);
-            auto directive_class = directive->GetClass();
-
-            if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              is_sp_mapped = true;
-              sp_iter_state = iter_status->GetIterState(dim);
-              if(iter_state->IsEdge()) {
-                is_sp_edge = true;
-              }
-            }
-          }
+          auto sp_mapping = GetSpatialMapping(output_tensor, iter_status);
+          auto sp_iter_state = sp_mapping.sp_iter_state;
+          bool is_sp_mapped = sp_mapping.is_sp_mapped;
+          bool is_sp_edge = sp_mapping.is_sp_edge;
 
 
           if(!is_sp_mapped) {
@@ -914,30 +835,14 @@ namespace  maestro {
             std::shared_ptr<DFA::Tensor> output_tensor,
             std::shared_ptr<DFA::IterationStatus> iter_status
             ) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = output_tensor->GetCoupledVariables();
 
           long ret = 1;
 
-          std::shared_ptr<DFA::IterationState> sp_iter_state;
-          bool is_sp_mapped = false;
-          bool is_sp_edge = false;
-
-          for(auto& dim : *coupled_dims) {
-            auto iter_state = iter_status->GetIterState(dim);
-            auto dataflow = target_cluster_->GetDataflow();
-            auto directive = dataflow->FindDirective(dim);
-            auto directive_class = directive->GetClass();
-
-            if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              is_sp_mapped = true;
-              sp_iter_state = iter_status->GetIterState(dim);
-              if(iter_state->IsEdge()) {
-                is_sp_edge = true;
-              }
-            }
-          }
+          auto sp_mapping = GetSpatialMapping(output_tensor, iter_status);
+          auto sp_iter_state = sp_mapping.sp_iter_state;
+          bool is_sp_mapped = sp_mapping.is_sp_mapped;
+          bool is_sp_edge = sp_mapping.is_sp_edge;
 
 
           if(!is_sp_mapped) {
@@ -969,45 +874,27 @@ namespace  maestro {
             std::shared_ptr<DFA::IterationStatus> iter_status,
             bool for_partial_sum = false
             ) {
-          auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = output_tensor->GetCoupledVariables();
 
           long ret = 1;
 
-          std::shared_ptr<DFA::IterationState> sp_iter_state;
-          bool is_sp_mapped = false;
-          bool is_sp_edge = false;
-
-          for(auto& dim : *coupled_dims) {
-            auto iter_state = iter_status->GetIterState(dim);
-            auto dataflow = target_cluster_->GetDataflow();
-            auto directive = dataflow->FindDirective(dim);
-            auto directive_class = directive->GetClass();
-
-            if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              is_sp_mapped = true;
-              sp_iter_state = iter_status->GetIterState(dim);
-              if(iter_state->IsEdge()) {
-                is_sp_edge = true;
-              }
-            }
-          }
+          auto sp_mapping = GetSpatialMapping(output_tensor, iter_status);
+          auto sp_iter_state = sp_mapping.sp_iter_state;
+          bool is_sp_mapped = sp_mapping.is_sp_mapped;
+          bool is_sp_edge = sp_mapping.is_sp_edge;
 
           if(for_partial_sum) {
-            for(auto& directive : *dataflow) {
-              auto directive_dim = directive->GetVariable();
-              auto directive_class = directive->GetClass();
+            ForEachDirective([&](int, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
               if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-                auto iter_state = iter_status->GetIterState(directive_dim);
+                auto iter_state = iter_status->GetIterState(dim);
                 is_sp_mapped = true;
-                sp_iter_state = iter_status->GetIterState(directive_dim);
+                sp_iter_state = iter_state;
 
                 if(iter_state->IsEdge()) {
                   is_sp_edge = true;
                 }
               }
-            }
+            });
           }
 
           int num_clusters = target_cluster_->GetNumClusters(false);
@@ -1264,34 +1151,93 @@ namespace  maestro {
         bool write_log_file_ = false;
         std::string logfile_ = "";
 
-        std::unique_ptr<std::map<std::string, int>> num_mapped_elements_;
-        std::unique_ptr<std::map<std::string, int>> num_mapped_elements_edge_;
-        std::unique_ptr<std::map<std::string, int>> num_mapped_elements_sp_edge_;
+        DFA::DimensionMap<int> num_mapped_elements_;
+        DFA::DimensionMap<int> num_mapped_elements_edge_;
+        DFA::DimensionMap<int> num_mapped_elements_sp_edge_;
+
+        DFA::DimensionMap<int> num_unique_elements_;
+        DFA::DimensionMap<int> num_unique_elements_edge_;
+        DFA::DimensionMap<int> num_unique_elements_sp_edge_;
 
-        std::unique_ptr<std::map<std::string, int>> num_unique_elements_;
-        std::unique_ptr<std::map<std::string, int>> num_unique_elements_edge_;
-        std::unique_ptr<std::map<std::string, int>> num_unique_elements_sp_edge_;
+        DFA::DimensionMap<int> num_reused_elements_;
+        DFA::DimensionMap<int> num_reused_elements_edge_;
+        DFA::DimensionMap<int> num_reused_elements_sp_edge_;
 
-        std::unique_ptr<std::map<std::string, int>> num_reused_elements_;
-        std::unique_ptr<std::map<std::string, int>> num_reused_elements_edge_;
-        std::unique_ptr<std::map<std::string, int>> num_reused_elements_sp_edge_;
+        std::optional<ClusterLayout<ConvLayout>> conv_layout_;
 
       private:
+        struct SpatialMapping {
+          bool is_sp_mapped = false;
+          bool is_sp_edge = false;
+          std::shared_ptr<DFA::IterationState> sp_iter_state;
+        };
+
+        // Visits (directive index, dimension, directive class) of every directive of the target cluster
+        template<typename Visitor>
+        void ForEachDirective(Visitor&& visit) {
+          if(conv_layout_.has_value()) {
+            int directive_idx = 0;
+            for(auto const & directive : conv_layout_->GetDirectives()) {
+              visit(directive_idx, directive.dim, directive.directive_class);
+              directive_idx++;
+            }
+            return;
+          }
+
+          auto dataflow = target_cluster_->GetDataflow();
+          int directive_idx = 0;
+          for(auto& directive : *dataflow) {
+            visit(directive_idx, directive->GetVariableID(), directive->GetClass());
+            directive_idx++;
+          }
+        }
+
+        // Visits the directives of the dimensions coupled with the tensor, in coupling order
+        template<typename Visitor>
+        void ForEachCoupledDim(std::shared_ptr<DFA::Tensor> const & tensor, Visitor&& visit) {
+          if(conv_layout_.has_value() && conv_layout_->Covers(tensor)) {
+            for(auto const & coupled : conv_layout_->GetCoupling(tensor)) {
+              visit(coupled.directive_idx, coupled.dim, coupled.directive_class);
+            }
+            return;
+          }
+
+          auto dataflow = target_cluster_->GetDataflow();
+          for(auto& var : *tensor->GetCoupledVariables()) {
+            int directive_idx = dataflow->GetDirectiveIdx(var);
+            auto directive = dataflow->at(directive_idx);
+            visit(directive_idx, directive->GetVariableID(), directive->GetClass());
+          }
+        }
+
+        // Whether a dimension coupled with the tensor is spatially mapped, and its iteration state
+        SpatialMapping GetSpatialMapping(
+            std::shared_ptr<DFA::Tensor> const & tensor,
+            std::shared_ptr<DFA::IterationStatus> const & iter_status) {
+          SpatialMapping ret;
+
+          ForEachCoupledDim(tensor, [&](int, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
+            if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
+              auto iter_state = iter_status->GetIterState(dim);
+              ret.is_sp_mapped = true;
+              ret.sp_iter_state = iter_state;
+              if(iter_state->IsEdge()) {
+                ret.is_sp_edge = true;
+              }
+            }
+          });
+
+          return ret;
+        }
 
         int GetInnermostUpdatedDimDirectiveID(
             std::shared_ptr<DFA::Tensor> input_tensor,
             std::shared_ptr<DFA::IterationStatus> iter_status) {
-          auto dataflow = target_cluster_->GetDataflow();
-          auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = input_tensor->GetCoupledVariables();
-
+          (void) input_tensor;
           int prime_change_dim_directive_idx = -1;
 
-          int idx = 0;
-          for(auto& directive : *dataflow) {
-            auto directive_class = directive->GetClass();
+          ForEachDirective([&](int idx, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
             if(directive_class == DFA::directive::DirectiveClass::TemporalMap || directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              auto dim = directive->GetVariable();
               auto iter_state = iter_status->GetIterState(dim);
               auto iter_pos = iter_state->GetIterPosition();
 
@@ -1300,8 +1246,7 @@ namespace  maestro {
               }
 
             }
-            idx++;
-          }
+          });
 
           return prime_change_dim_directive_idx;
         }
@@ -1311,32 +1256,27 @@ namespace  maestro {
             std::shared_ptr<DFA::Tensor> input_tensor,
             std::shared_ptr<DFA::IterationStatus> iter_status,
             int changing_dim_idx) {
-          auto dataflow = target_cluster_->GetDataflow();
-          auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = input_tensor->GetCoupledVariables();
+          auto coupled_dims = input_tensor->GetCoupledVariableMask();
 
           bool tensor_inited = false;
 
-          int directive_idx = 0;
-          for(auto& directive : *dataflow) {
-            auto directive_class = directive->GetClass();
+          ForEachDirective([&](int directive_idx, DFA::DimensionID dim, DFA::directive::DirectiveClass directive_class) {
+            if(tensor_inited) {
+              return;
+            }
             if(directive_class == DFA::directive::DirectiveClass::TemporalMap || directive_class == DFA::directive::DirectiveClass::SpatialMap) {
-              auto dim = directive->GetVariable();
               auto iter_state = iter_status->GetIterState(dim);
               auto iter_pos = iter_state->GetIterPosition();
-              bool is_coupled = std::find(coupled_dims->begin(), coupled_dims->end(), dim) != coupled_dims->end();
+              bool is_coupled = (coupled_dims & DFA::GetDimensionMask(dim)) != 0;
 
               if(iter_pos == DFA::IterationPosition::Init
                   && is_coupled
                   && directive_idx > changing_dim_idx
                   && !iter_state->IsUnrolled()) {
                 tensor_inited = true;
-                break;
               }
             }
-
-            directive_idx++;
-          }
+          });
 
           return tensor_inited;
         }
@@ -1414,17 +1354,17 @@ namespace  maestro {
 
               //Spatial reuse check is always there
               if(is_first_pe) {
-                load_voulme_with_tp_reuse *= (*num_mapped_elements_)[dim];
+                load_voulme_with_tp_reuse *= num_mapped_elements_[dim];
               }
               else {
-                load_voulme_with_tp_reuse *= (*num_unique_elements_)[dim];
+                load_voulme_with_tp_reuse *= num_unique_elements_[dim];
               }
             }
             else {
 //              std::cout << "[ReuseAnalysis-GetPELoadVolume] Dimension " << dim << " is temporally mapped" << std::endl;
               if(is_changing_dim) {
-                //std::cout << "[ReuseAnalysis-GetPELoadVolume] Dimension " << dim << ", multiply unique element counts: " << (*num_unique_elements_)[dim] << std::endl;
-                load_voulme_with_tp_reuse *= (*num_unique_elements_)[dim];
+                //std::cout << "[ReuseAnalysis-GetPELoadVolume] Dimension " << dim << ", multiply unique element counts: " << num_unique_elements_[dim] << std::endl;
+                load_voulme_with_tp_reuse *= num_unique_elements_[dim];
               }
               else {
 
@@ -1432,7 +1372,7 @@ namespace  maestro {
                   load_voulme_with_tp_reuse *= dimensions->GetSize(dim);
                 }
                 else {
-                  load_voulme_with_tp_reuse *= (*num_mapped_elements_)[dim];
+                  load_voulme_with_tp_reuse *= num_mapped_elements_[dim];
                 }
               }
             }
@@ -1469,7 +1409,7 @@ namespace  maestro {
         {
           auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = tensor->GetCoupledVariables();
+          auto coupled_dims = tensor->GetCoupledVariableMask();
 
           int changing_dim_directive_id = -1;
           int directive_id = -1;
@@ -1477,15 +1417,9 @@ namespace  maestro {
           for(auto& dim_iter_status : *iter_status) {
             directive_id++;
             auto directive = dataflow->at(directive_id);
-            auto directive_dim = directive->GetVariable();
+            auto directive_dim = directive->GetVariableID();
 
-            bool found = false;
-            for(auto& dim: *coupled_dims) {
-              if(dim == directive_dim) {
-                found =true;
-                break;
-              }
-            }
+            bool found = (coupled_dims & DFA::GetDimensionMask(directive_dim)) != 0;
 
             if(!found) {
               continue; //To next directive
@@ -1508,7 +1442,7 @@ namespace  maestro {
             std::shared_ptr<std::vector<IterationStatus>> iter_status) {
           auto dataflow = target_cluster_->GetDataflow();
           auto dimensions = target_cluster_->GetDimensions();
-          auto coupled_dims = tensor->GetCoupledVariables();
+          auto coupled_dims = tensor->GetCoupledVariableMask();
 
           bool ret = true;
 
@@ -1516,15 +1450,9 @@ namespace  maestro {
           for(auto& dim_iter_status : *iter_status) {
             directive_id++;
             auto directive = dataflow->at(directive_id);
-            auto directive_dim = directive->GetVariable();
+            auto directive_dim = directive->GetVariableID();
 
-            bool found = false;
-            for(auto& dim: *coupled_dims) {
-              if(dim == directive_dim) {
-                found =true;
-                break;
-              }
-            }
+            bool found = (coupled_dims & DFA::GetDimensionMask(directive_dim)) != 0;
 
             if(!found) {
               continue; //To next directive
@@ -1563,27 +1491,27 @@ namespace  maestro {
 
               if(directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
                 if(is_first_pe) {
-                  load_volume_with_no_reuse *= (*num_mapped_elements_)[var];
+                  load_volume_with_no_reuse *= num_mapped_elements_[var];
                 }
                 else {
-                  load_volume_with_no_reuse *= (*num_unique_elements_)[var]; //Spatial reuse
+                  load_volume_with_no_reuse *= num_unique_elements_[var]; //Spatial reuse
                 }
               }
               else { // Temporal Map
                 if(has_sp_map) {
                   if(target_cluster_->IsInitEdge(var)) {
-                    load_volume_with_no_reuse *= (*num_mapped_elements_edge_)[var];
+                    load_volume_with_no_reuse *= num_mapped_elements_edge_[var];
                   }
                   else {
-                    load_volume_with_no_reuse *= (*num_mapped_elements_)[var];
+                    load_volume_with_no_reuse *= num_mapped_elements_[var];
                   }
                 }
                 else {
                   if(is_first_pe && target_cluster_->IsInitEdge(var)) {
-                    load_volume_with_no_reuse *= (*num_mapped_elements_edge_)[var];
+                    load_volume_with_no_reuse *= num_mapped_elements_edge_[var];
                   }
                   else if(is_first_pe && !target_cluster_->IsInitEdge(var)) {
-                    load_volume_with_no_reuse *= (*num_mapped_elements_)[var];
+                    load_volume_with_no_reuse *= num_mapped_elements_[var];
                   }
                   else {
                     load_volume_with_no_reuse = 0;
@@ -1615,16 +1543,16 @@ namespace  maestro {
               bool has_edge = (num_steady_iterations * ofs_size + map_size < dim_size) || (map_size > dim_size); // the latter one: Init-unroll; reverse_edge
 
               // 1. Steady cases
-              (*num_mapped_elements_)[loop_var] = map_size;
-              (*num_unique_elements_)[loop_var] = std::min(map_size, ofs_size);
-              (*num_reused_elements_)[loop_var] = std::max(map_size - ofs_size, 0);
+              num_mapped_elements_[loop_var] = map_size;
+              num_unique_elements_[loop_var] = std::min(map_size, ofs_size);
+              num_reused_elements_[loop_var] = std::max(map_size - ofs_size, 0);
 
               // 2. Unroll case
               if(directive_class == DFA::directive::DirectiveClass::TemporalMap) {
                 bool is_fully_tp_unrolled = dim_size <= map_size;
                 if(is_fully_tp_unrolled) {
-                  (*num_unique_elements_)[loop_var] = 0;
-                  (*num_reused_elements_)[loop_var] = map_size;
+                  num_unique_elements_[loop_var] = 0;
+                  num_reused_elements_[loop_var] = map_size;
                 }
               }
 
@@ -1633,9 +1561,9 @@ namespace  maestro {
               edge_map_size = (edge_map_size < 0)? dim_size : edge_map_size;
 
               int edge_out_of_bound_size = map_size - edge_map_size;
-              (*num_mapped_elements_edge_)[loop_var] = has_edge? edge_map_size : map_size; // map_size : deals with init-edge
-              (*num_unique_elements_edge_)[loop_var] = std::max(ofs_size - edge_out_of_bound_size, 0);
-              (*num_reused_elements_edge_)[loop_var] = has_edge? (*num_mapped_elements_edge_)[loop_var] - (*num_unique_elements_edge_)[loop_var] : 0;
+              num_mapped_elements_edge_[loop_var] = has_edge? edge_map_size : map_size; // map_size : deals with init-edge
+              num_unique_elements_edge_[loop_var] = std::max(ofs_size - edge_out_of_bound_size, 0);
+              num_reused_elements_edge_[loop_var] = has_edge? num_mapped_elements_edge_[loop_var] - num_unique_elements_edge_[loop_var] : 0;
             } // End of if(directve_class == tMap or sMap)
           } // End of for(auto directive : dataflow)
         } // End of void AnalyzeMappingSizes
@@ -1657,11 +1585,11 @@ namespace  maestro {
                 //TODO: This is only for DNN ops. Generalize this for arbitrary ops. (Mostly, it'll be fine though)
                 auto output_var = (directive_var == DFSL::layer_dim_input_height_)? DFSL::layer_dim_output_height_ : DFSL::layer_dim_output_width_;
 
-                (*num_mapped_elements_)[output_var] = (*num_mapped_elements_)[directive_var] - (*num_mapped_elements_)[sliding_dim] + 1;
-                (*num_unique_elements_)[output_var] = std::min(directive->GetOfs(), directive->GetSize());
+                num_mapped_elements_[output_var] = num_mapped_elements_[directive_var] - num_mapped_elements_[sliding_dim] + 1;
+                num_unique_elements_[output_var] = std::min(directive->GetOfs(), directive->GetSize());
                 //TODO: The following assumes legal dataflow; this will yield wield results for illegal dataflows
-                (*num_mapped_elements_edge_)[output_var] = (*num_mapped_elements_edge_)[directive_var] - (*num_mapped_elements_edge_)[sliding_dim] + 1;
-                (*num_unique_elements_edge_)[output_var] = std::min(directive->GetOfs(), (*num_mapped_elements_edge_)[output_var]);
+                num_mapped_elements_edge_[output_var] = num_mapped_elements_edge_[directive_var] - num_mapped_elements_edge_[sliding_dim] + 1;
+                num_unique_elements_edge_[output_var] = std::min(directive->GetOfs(), num_mapped_elements_edge_[output_var]);
 
               }
             } // End of if(directve_class == tMap or sMap)
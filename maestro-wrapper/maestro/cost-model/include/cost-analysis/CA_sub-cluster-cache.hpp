@@ -0,0 +1,141 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*******************************************************************************/
+
+
+#ifndef MAESTRO_CA_SUB_CLUSTER_CACHE_HPP_
+#define MAESTRO_CA_SUB_CLUSTER_CACHE_HPP_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DFA_dimension-table.hpp"
+#include "DFA_cluster-unit.hpp"
+#include "DFA_cluster-table.hpp"
+
+#include "CA_cost-analysis-results.hpp"
+
+namespace maestro {
+  namespace CA {
+
+    /*
+     * Memoizes the analysis of a sub-cluster level. Different iteration cases of the upper
+     * level frequently produce identical sub-cluster dimension tables, and each of them used
+     * to re-run the full (recursive) analysis of every lower level.
+     *
+     * An entry holds copies of every result the analysis appended to the result list,
+     * innermost level first, so a hit reproduces exactly what a miss would have produced.
+     * Results are copied on insertion and on lookup because callers mutate the returned
+     * results (e.g., SetNumSpatialOccurrences).
+     *
+     * Keys are only meaningful for a fixed set of lower-level clusters, so every
+     * CostAnalysisEngine owns its cache and drops it with its target clusters.
+     */
+    class SubClusterCache {
+      public:
+        using ResultList = std::vector<std::shared_ptr<CostAnalyisResults>>;
+
+        static std::string MakeDimensionKey(int cluster_idx, bool do_double_buffering, std::shared_ptr<DFA::DimensionTable> dimensions) {
+          std::string key = std::to_string(cluster_idx) + (do_double_buffering? "D" : "S");
+          AppendDimensions(key, dimensions);
+          return key;
+        }
+
+        // Describes everything besides the dimension table that the analysis of the given
+        // cluster level depends on
+        static std::string MakeClusterLevelSignature(std::shared_ptr<DFA::ClusterTable> clusters, int cluster_idx, int num_simd_lanes) {
+          std::string signature = std::to_string(static_cast<int>(clusters->GetLayerType())) + "/" + std::to_string(num_simd_lanes);
+          AppendCluster(signature, clusters->GetCluster(cluster_idx));
+          return signature;
+        }
+
+        // Appends copies of the cached results to ret; returns false on a miss
+        bool Lookup(std::string const & key, std::shared_ptr<ResultList> ret, bool & valid) {
+          auto entry = entries_.find(key);
+          if(entry == entries_.end()) {
+            num_misses_++;
+            return false;
+          }
+
+          num_hits_++;
+          for(auto& res : entry->second.results) {
+            ret->push_back(std::make_shared<CostAnalyisResults>(*res));
+          }
+          valid = entry->second.valid;
+          return true;
+        }
+
+        // Caches copies of ret[first_idx:]
+        void Insert(std::string const & key, std::shared_ptr<ResultList> ret, std::size_t first_idx, bool valid) {
+          Entry entry;
+          entry.valid = valid;
+          for(std::size_t idx = first_idx; idx < ret->size(); idx++) {
+            entry.results.push_back(std::make_shared<CostAnalyisResults>(*ret->at(idx)));
+          }
+          entries_.emplace(key, std::move(entry));
+        }
+
+        long GetNumHits() {
+          return num_hits_;
+        }
+
+        long GetNumMisses() {
+          return num_misses_;
+        }
+
+        void Clear() {
+          entries_.clear();
+        }
+
+      protected:
+        struct Entry {
+          ResultList results;
+          bool valid = true;
+        };
+
+        std::unordered_map<std::string, Entry> entries_;
+        long num_hits_ = 0;
+        long num_misses_ = 0;
+
+      private:
+        static void AppendCluster(std::string & key, std::shared_ptr<DFA::ClusterUnit> cluster) {
+          auto noc = cluster->GetNoCModel();
+          key += "/" + std::to_string(cluster->GetNumClusters(false)) + "," + std::to_string(cluster->GetNumClusters(true));
+          key += "," + std::to_string(noc->GetBandwidth()) + "," + std::to_string(noc->GetNumAverageHops());
+          key += "," + std::to_string(noc->GetLatencyPerHops()) + (noc->IsMulticastSupported()? "M" : "U");
+          key += cluster->GetDataflow()->ToString();
+          AppendDimensions(key, cluster->GetDimensions());
+        }
+
+        static void AppendDimensions(std::string & key, std::shared_ptr<DFA::DimensionTable> dimensions) {
+          for(auto& dim : *dimensions) {
+            key += "|" + dim->GetName() + ":" + std::to_string(dim->GetSize()) + ":" + std::to_string(dim->GetOuterStride());
+          }
+          for(auto& overlap : dimensions->GetOverlapTable()->GetOverlappingDimensions()) {
+            key += "|" + overlap->first + "~" + overlap->second;
+          }
+        }
+    }; // End of class SubClusterCache
+
+  }; // End of namespace CA
+}; // End of namespace maestro
+
+#endif
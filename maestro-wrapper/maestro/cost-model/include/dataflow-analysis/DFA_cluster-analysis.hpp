@@ -30,6 +30,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "BASE_constants.hpp"
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_directives.hpp"
@@ -67,7 +68,7 @@ namespace maestro {
           full_dimensions_(full_dimensions),
           full_dataflow_(full_dataflow),
           nocs_(nocs) {
-          clusters_ = std::make_shared<DFA::ClusterTable>(layer_type);
+          clusters_ = MakeShared<DFA::ClusterTable>(layer_type);
           AnalyzeClusters();
         }
 
@@ -115,7 +116,7 @@ namespace maestro {
           int current_cluster_size = num_unit_clusters;
           int last_cluster_size = num_unit_clusters;
 
-          auto cluster_dataflow = std::make_shared<DFA::DirectiveTable>();
+          auto cluster_dataflow = MakeShared<DFA::DirectiveTable>();
           std::shared_ptr<DFA::DirectiveTable> prev_dataflow = nullptr;
           auto cluster_dimensions =full_dimensions_;
           std::shared_ptr<DFA::DimensionTable> prev_cluster_dimensions = nullptr;
@@ -173,7 +174,7 @@ namespace maestro {
                   current_cluster_size = last_cluster_size;
                 }
 
-                auto new_cluster = std::make_shared<DFA::ClusterUnit>(current_cluster_level,
+                auto new_cluster = MakeShared<DFA::ClusterUnit>(current_cluster_level,
                                                                       current_cluster_size,
                                                                       cluster_dataflow,
                                                                       cluster_dimensions,
@@ -189,12 +190,12 @@ namespace maestro {
 
                 clusters_->PutCluster(new_cluster);
                 prev_cluster_dimensions = cluster_dimensions;
-                cluster_dimensions = std::make_shared<DFA::DimensionTable>();
+                cluster_dimensions = MakeShared<DFA::DimensionTable>();
                 cluster_dimensions->SetOverlapTable(prev_cluster_dimensions->GetOverlapTable());
 
                 ConstructLowerClusterDimensionTable(var_list_input_tensor, prev_cluster_dimensions, cluster_dimensions, cluster_dataflow);
                 prev_dataflow = cluster_dataflow;
-                cluster_dataflow = std::make_shared<DFA::DirectiveTable>();
+                cluster_dataflow = MakeShared<DFA::DirectiveTable>();
 
                 current_cluster_level--;
               } // End of case Cluster
@@ -223,7 +224,7 @@ namespace maestro {
 
           // Add the inner-most cluster directive
           std::shared_ptr<DFA::directive::Cluster> last_cluster
-          = std::make_shared<DFA::directive::Cluster>(last_cluster_size, DFA::directive::ClusterType::Physical);
+          = MakeShared<DFA::directive::Cluster>(last_cluster_size, DFA::directive::ClusterType::Physical);
           full_dataflow_->AddDirective(last_cluster);
 
           innermost_cluster_unit_size = last_cluster_size;
@@ -277,7 +278,7 @@ namespace maestro {
                 int upper_map_sz = upper_directive->GetSize();
                 int upper_ofs_sz = upper_directive->GetOfs();
 
-                auto inherited_dataflow = std::make_shared<DFA::directive::TemporalMap>(upper_map_sz, upper_ofs_sz, upper_directive_var);
+                auto inherited_dataflow = MakeShared<DFA::directive::TemporalMap>(upper_map_sz, upper_ofs_sz, upper_directive_var);
                 cluster_dataflow->AddDirectiveFront(inherited_dataflow);
               }
             }
@@ -293,7 +294,7 @@ namespace maestro {
 
               if(cluster_dimensions->HasVar(var)) {
                 int dim_sz = cluster_dimensions->GetSize(var);
-                auto dummy_directive = std::make_shared<DFA::directive::TemporalMap>(dim_sz, dim_sz, var);
+                auto dummy_directive = MakeShared<DFA::directive::TemporalMap>(dim_sz, dim_sz, var);
                 cluster_dataflow->AddDirective(dummy_directive);
               }
             }
@@ -331,11 +332,10 @@ namespace maestro {
             auto directive = cluster_dataflow->FindDirective(var);
 
             //Deal with edge cases
-            int final_dim_sz = std::min(directive->GetSize(), prev_cluster_dimensions->GetSize(var));
-            int inner_stride = prev_cluster_dimensions->GetInnerStride(var);
-            int outer_stride = prev_cluster_dimensions->GetOuterStride(var);
-            auto dim = std::make_shared<DFA::LayerDimension>(var, final_dim_sz, outer_stride, inner_stride);
-            cluster_dimensions->AddDimension(dim);
+            auto dim_id = DFA::GetDimensionID(var);
+            int final_dim_sz = std::min(directive->GetSize(), prev_cluster_dimensions->GetSize(dim_id));
+            int outer_stride = prev_cluster_dimensions->GetOuterStride(dim_id);
+            cluster_dimensions->AddDimension(dim_id, final_dim_sz, outer_stride);
           }
         }
 
@@ -27,6 +27,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <vector>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_layer.hpp"
@@ -94,7 +95,7 @@ namespace maestro {
         ClusterTable(LayerType layer_type) :
           MAESTROClass("ClusterTable"),
           layer_type_(layer_type) {
-          clusters_ = std::make_shared<std::vector<std::shared_ptr<DFA::ClusterUnit>>>();
+          clusters_ = MakeShared<std::vector<std::shared_ptr<DFA::ClusterUnit>>>();
         }
 
         int size() {
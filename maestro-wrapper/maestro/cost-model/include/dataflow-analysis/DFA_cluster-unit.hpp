@@ -32,6 +32,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <string>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "AHW_noc-model.hpp"
@@ -300,7 +301,7 @@ namespace maestro {
         }
 
         std::shared_ptr<std::vector<std::string>> GetAllVarsInDirectiveClass (DFA::directive::DirectiveClass target_class) {
-          std::shared_ptr<std::vector<std::string>> ret = std::make_shared<std::vector<std::string>>();
+          std::shared_ptr<std::vector<std::string>> ret = MakeShared<std::vector<std::string>>();
 
           for(auto directive : *dataflow_) {
             if(target_class == DFA::directive::DirectiveClass::Invalid
@@ -313,7 +314,7 @@ namespace maestro {
         }
 
         std::shared_ptr<std::vector<std::string>> GetAllDimensionVars () {
-          std::shared_ptr<std::vector<std::string>> ret = std::make_shared<std::vector<std::string>>();
+          std::shared_ptr<std::vector<std::string>> ret = MakeShared<std::vector<std::string>>();
 
           for(auto directive : *dataflow_) {
             ret->push_back(directive->GetVariable());
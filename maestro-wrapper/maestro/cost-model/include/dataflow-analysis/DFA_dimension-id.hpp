@@ -0,0 +1,121 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*******************************************************************************/
+
+
+#ifndef MAESTRO_DFA_DIMENSION_ID_HPP_
+#define MAESTRO_DFA_DIMENSION_ID_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace maestro {
+  namespace DFA {
+
+    /*
+     * Compact identifiers for layer dimensions. The order follows the lexicographic order of
+     * the dimension names so that anything indexed by DimensionID iterates in the same order
+     * as the name-keyed std::maps it replaces.
+     */
+    enum class DimensionID : int {C, G, K, M, N, R, S, X, OutputX, Y, OutputY, NumDimensions};
+
+    const int num_dimension_ids = static_cast<int>(DimensionID::NumDimensions);
+    const DimensionID invalid_dimension_id = DimensionID::NumDimensions;
+
+    inline std::string const & GetDimensionName(DimensionID id) {
+      static const std::string names[num_dimension_ids + 1] = {"C", "G", "K", "M", "N", "R", "S", "X", "X'", "Y", "Y'", ""};
+      return names[static_cast<int>(id)];
+    }
+
+    inline DimensionID GetDimensionID(std::string const & name) {
+      if(name.size() == 1) {
+        switch(name[0]) {
+          case 'C': return DimensionID::C;
+          case 'G': return DimensionID::G;
+          case 'K': return DimensionID::K;
+          case 'M': return DimensionID::M;
+          case 'N': return DimensionID::N;
+          case 'R': return DimensionID::R;
+          case 'S': return DimensionID::S;
+          case 'X': return DimensionID::X;
+          case 'Y': return DimensionID::Y;
+          default: return invalid_dimension_id;
+        }
+      }
+      else if(name.size() == 2 && name[1] == '\'') {
+        if(name[0] == 'X') {
+          return DimensionID::OutputX;
+        }
+        else if(name[0] == 'Y') {
+          return DimensionID::OutputY;
+        }
+      }
+      return invalid_dimension_id;
+    }
+
+    /*
+     * Set of dimensions packed into a bitmask, one bit per DimensionID. The invalid ID maps to
+     * its own bit so that it never matches a real dimension.
+     */
+    using DimensionMask = uint32_t;
+
+    inline DimensionMask GetDimensionMask(DimensionID id) {
+      return DimensionMask{1} << static_cast<int>(id);
+    }
+
+    /*
+     * Per-dimension values stored in a flat array indexed by DimensionID. Like the
+     * std::map<std::string, T> it replaces, operator[] creates a value-initialized entry on
+     * first access, and Contains reports whether an entry has been created.
+     */
+    template<typename T>
+    class DimensionMap {
+      public:
+        T& operator[](DimensionID id) {
+          keys_ |= GetDimensionMask(id);
+          return values_[static_cast<int>(id)];
+        }
+
+        T& operator[](std::string const & name) {
+          return (*this)[GetDimensionID(name)];
+        }
+
+        bool Contains(DimensionID id) const {
+          return (keys_ & GetDimensionMask(id)) != 0;
+        }
+
+        bool Contains(std::string const & name) const {
+          return Contains(GetDimensionID(name));
+        }
+
+        void Clear() {
+          values_.fill(T());
+          keys_ = 0;
+        }
+
+      protected:
+        std::array<T, num_dimension_ids + 1> values_ = {};
+        DimensionMask keys_ = 0;
+    };
+
+  }; // End of namespace DFA
+}; // End of namespace maestro
+
+#endif
@@ -28,6 +28,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <utility>
 #include <string>
 
+#include "BASE_memory-arena.hpp"
 
 namespace maestro {
   namespace DFA {
@@ -39,7 +40,7 @@ namespace maestro {
         }
 
         void AddOverlapDimension(std::string reference_dim, std::string sliding_dim) {
-          auto new_overlap_info = std::make_shared<std::pair<std::string, std::string>>(reference_dim, sliding_dim);
+          auto new_overlap_info = MakeShared<std::pair<std::string, std::string>>(reference_dim, sliding_dim);
           overlapping_dimensions_->push_back(new_overlap_info);
         }
 
@@ -94,6 +95,10 @@ namespace maestro {
           return ret;
         }
 
+        std::list<std::shared_ptr<std::pair<std::string, std::string>>>& GetOverlappingDimensions() {
+          return *overlapping_dimensions_;
+        }
+
       protected:
         std::unique_ptr<std::list<std::shared_ptr<std::pair<std::string, std::string>>>> overlapping_dimensions_;
 
@@ -23,14 +23,17 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #ifndef MAESTRO_DFA_DIMENSION_TABLE_HPP_
 #define MAESTRO_DFA_DIMENSION_TABLE_HPP_
 
+#include <array>
 #include <vector>
 #include <memory>
 #include <string>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_layer.hpp"
+#include "DFA_dimension-id.hpp"
 #include "DFA_dimension-overlap-info-table.hpp"
 
 namespace maestro {
@@ -38,119 +41,177 @@ namespace maestro {
 
 		const int invalid_size = -1;
 
+		/*
+		 * Dimension table indexed by DimensionID. Entries are plain structs in a fixed-size
+		 * array, so lookups on the analysis hot path are a single array access; the
+		 * string-based interface is kept as a thin adapter for the DFSL front end.
+		 */
 		class DimensionTable : public MAESTROClass {
 			public:
+        struct Dimension {
+          DimensionID id = invalid_dimension_id;
+          int size = invalid_size;
+          int outer_stride = 1;
+          int inner_stride = 1;
+
+          std::string const & GetName() const {
+            return GetDimensionName(id);
+          }
+
+          DimensionID GetID() const {
+            return id;
+          }
+
+          int GetSize() const {
+            return size;
+          }
+
+          int GetOuterStride() const {
+            return outer_stride;
+          }
+
+          int GetInnerStride() const {
+            return inner_stride;
+          }
+
+          std::string ToString() const {
+            std::string ret = GetName() + ": size = " + std::to_string(size) + ", outer stride = " + std::to_string(outer_stride);
+            return ret;
+          }
+        };
+
         class iterator {
           private:
-            std::map<std::string, std::shared_ptr<LayerDimension>>* map_ptr_;
-            std::map<std::string, std::shared_ptr<LayerDimension>>::iterator map_iterator_;
+            DimensionTable* table_;
+            int idx_;
+            Dimension* curr_ = nullptr;
+
+            void SkipMissing() {
+              while(idx_ < num_dimension_ids && !table_->has_dim_[idx_]) {
+                idx_++;
+              }
+              curr_ = (idx_ < num_dimension_ids)? &table_->dims_[idx_] : nullptr;
+            }
+
           public:
 
-            iterator(std::map<std::string, std::shared_ptr<LayerDimension>>* ptr_layerdim_map) :
-              map_ptr_(ptr_layerdim_map) {
-              map_iterator_ = ptr_layerdim_map->begin();
+            iterator(DimensionTable* table, int idx) :
+              table_(table), idx_(idx) {
+              SkipMissing();
             }
 
             iterator operator++() {
-              map_iterator_++;
+              idx_++;
+              SkipMissing();
               return *this;
-              /*
-              this->curr_idx_++;
-              iterator iter = *this;
-              return iter;
-              */
             }
 
-            std::shared_ptr<LayerDimension>& operator*() {
-              return map_iterator_->second;
+            Dimension*& operator*() {
+              return curr_;
             }
 
             bool operator==(const iterator& rhs) {
-              return (this->map_iterator_ == rhs.map_iterator_);
+              return (this->idx_ == rhs.idx_);
             }
 
             bool operator!=(const iterator& rhs) {
-              return (this->map_iterator_ != rhs.map_iterator_);
-            }
-
-            void set_end () {
-              map_iterator_ = map_ptr_->end();
+              return (this->idx_ != rhs.idx_);
             }
-        }; // End of class iterator for class Directive_table
+        }; // End of class iterator for class DimensionTable
 
         iterator begin() {
-          iterator iter(&dim_table_);
+          iterator iter(this, 0);
           return iter;
         }
 
         iterator end() {
-          iterator iter(&dim_table_);
-          iter.set_end();
+          iterator iter(this, num_dimension_ids);
           return iter;
         }
 
 
 				DimensionTable() :
 					MAESTROClass("Dimension Table") {
-				  dim_overlap_table_ = std::make_shared<DimensionOverlapInfoTable>();
+				  dim_overlap_table_ = MakeShared<DimensionOverlapInfoTable>();
 				}
 
-				// Not a good way to use std::map; will remove after update deprecated code
-				std::shared_ptr<LayerDimension> at (int idx) {
+				Dimension* at (int idx) {
           int count = 0;
 
-				  for(auto iter = dim_table_.begin(); iter != dim_table_.end(); iter++) {
-				    if(count == idx) {
-				      return iter->second;
+				  for(int id = 0; id < num_dimension_ids; id++) {
+				    if(has_dim_[id]) {
+				      if(count == idx) {
+				        return &dims_[id];
+				      }
+				      count ++;
 				    }
-				    count ++;
 				  }
           return nullptr;
         }
 
-				std::shared_ptr<LayerDimension> operator[] (int idx) {
+				Dimension* operator[] (int idx) {
           return this->at(idx);
         }
 
-				bool HasVar(std::string targ) {
-				  return (dim_table_.find(targ) != dim_table_.end());
+				int size() {
+				  return num_dims_;
 				}
 
-				int GetSize(std::string targ) {
-
-				  if(!this->HasVar(targ)) {
-            error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
-            error_handler_->TerminateProgram();
-				  }
-
-					return dim_table_[targ]->GetSize();
+				bool HasVar(DimensionID targ) {
+				  return has_dim_[static_cast<int>(targ)];
 				}
 
-				int GetOuterStride(std::string targ) {
-
-          if(!this->HasVar(targ)) {
-            error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
-            error_handler_->TerminateProgram();
-          }
+				bool HasVar(std::string const & targ) {
+				  return HasVar(GetDimensionID(targ));
+				}
 
-          return dim_table_[targ]->GetOuterStride();
+				int GetSize(DimensionID targ) {
+				  return GetDimension(targ).size;
+				}
 
+				int GetSize(std::string const & targ) {
+				  return GetDimension(targ).size;
 				}
 
-        int GetInnerStride(std::string targ) {
+				int GetOuterStride(DimensionID targ) {
+				  return GetDimension(targ).outer_stride;
+				}
 
-          if(!this->HasVar(targ)) {
-            error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
-            error_handler_->TerminateProgram();
-          }
+				int GetOuterStride(std::string const & targ) {
+				  return GetDimension(targ).outer_stride;
+				}
 
-          return dim_table_[targ]->GetInnerStride();
+        int GetInnerStride(DimensionID targ) {
+          return GetDimension(targ).inner_stride;
+        }
 
+        int GetInnerStride(std::string const & targ) {
+          return GetDimension(targ).inner_stride;
         }
 
+        // Like the std::map::insert it replaces, an existing dimension is never overwritten.
+        // Inner strides are not modeled: LayerDimension has always reported 1.
+				void AddDimension(DimensionID id, int size, int outer_stride = 1) {
+				  if(id == invalid_dimension_id) {
+            error_handler_->PrintErrorMsg(TL::ErrorCode::InvalidDimension, "");
+            error_handler_->TerminateProgram();
+            return;
+				  }
+
+				  int idx = static_cast<int>(id);
+				  if(has_dim_[idx]) {
+				    return;
+				  }
+				  has_dim_[idx] = true;
+				  dims_[idx].id = id;
+				  dims_[idx].size = size;
+				  dims_[idx].outer_stride = outer_stride;
+				  dims_[idx].inner_stride = 1;
+				  num_dims_++;
+				}
 
 				void AddDimension(std::shared_ptr<LayerDimension> new_dimension) {
-				  dim_table_.insert(std::make_pair(new_dimension->GetName(), new_dimension));
+				  AddDimension(GetDimensionID(new_dimension->GetName()), new_dimension->GetSize(), new_dimension->GetOuterStride());
 				}
 
 				void AddOverlapDimension(std::string reference_dim, std::string sliding_dim) {
@@ -187,18 +248,41 @@ namespace maestro {
 
 				std::string ToString() {
 				  std::string ret = "Dimension Table contents\n";
-				  for(auto& it : dim_table_) {
-				    ret += it.second->ToString();
+				  for(auto& it : *this) {
+				    ret += it->ToString();
 				    ret += "\n";
 				  }
 				  return ret;
 				}
 
 			protected:
-        std::map<std::string, std::shared_ptr<LayerDimension>> dim_table_;
+        // The extra entry backs invalid_dimension_id and is never marked present
+        std::array<Dimension, num_dimension_ids + 1> dims_;
+        std::array<bool, num_dimension_ids + 1> has_dim_ = {};
+        int num_dims_ = 0;
 
 				std::shared_ptr<DimensionOverlapInfoTable> dim_overlap_table_;
 
+			private:
+				Dimension& GetDimension(DimensionID targ) {
+				  if(!this->HasVar(targ)) {
+            error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, GetDimensionName(targ));
+            error_handler_->TerminateProgram();
+				  }
+
+				  return dims_[static_cast<int>(targ)];
+				}
+
+				Dimension& GetDimension(std::string const & targ) {
+				  DimensionID id = GetDimensionID(targ);
+				  if(!this->HasVar(id)) {
+            error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
+            error_handler_->TerminateProgram();
+				  }
+
+				  return dims_[static_cast<int>(id)];
+				}
+
 		};
 	};
 };
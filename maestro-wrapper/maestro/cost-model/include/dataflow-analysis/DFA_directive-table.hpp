@@ -29,6 +29,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <vector>
 #include <list>
 
+#include "BASE_memory-arena.hpp"
+
 #include "DFA_analysis-output.hpp"
 #include "DFA_directives.hpp"
 #include "DFSL_syntax_tokens.hpp"
@@ -83,7 +85,7 @@ namespace maestro {
 				}
 
 				DirectiveTable() {
-					directives_ = std::make_shared<std::vector<std::shared_ptr<directive::Directive>>>();
+					directives_ = MakeShared<std::vector<std::shared_ptr<directive::Directive>>>();
 				}
 
 				std::shared_ptr<directive::Directive> at (size_t idx) {
@@ -27,6 +27,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "DFSL_syntax_tokens.hpp"
 
+#include "DFA_dimension-id.hpp"
+
 namespace maestro {
 	namespace DFA {
 
@@ -73,6 +75,10 @@ namespace maestro {
 						return "";
 					}
 
+					virtual DimensionID GetVariableID() {
+						return invalid_dimension_id;
+					}
+
 					virtual ClusterType GetAllocType () {
 						return ClusterType::Invalid;
 					}
@@ -82,7 +88,7 @@ namespace maestro {
 			class Map : public Directive {
 				public:
 					Map(int size, int offset, std::string var) :
-						size_(size), offset_(offset), variable_(var) {
+						size_(size), offset_(offset), variable_(var), variable_id_(GetDimensionID(var)) {
 					}
 
 					virtual DirectiveClass GetClass() {
@@ -101,6 +107,10 @@ namespace maestro {
 						return variable_;
 					}
 
+					virtual DimensionID GetVariableID() {
+						return variable_id_;
+					}
+
 					virtual ClusterType GetAllocType () {
 						return ClusterType::Invalid;
 					}
@@ -112,6 +122,7 @@ namespace maestro {
 
           virtual void SetVariable(std::string new_var) {
             variable_ = new_var;
+            variable_id_ = GetDimensionID(new_var);
           }
 
           virtual void SetSize(int new_size) {
@@ -127,6 +138,7 @@ namespace maestro {
 					int size_;
 					int offset_;
 					std::string variable_;
+					DimensionID variable_id_;
 			}; // End of class Map
 
 			class TemporalMap : public Map {
@@ -159,6 +171,7 @@ namespace maestro {
 
           virtual void SetVariable(std::string new_var) {
             variable_ = new_var;
+            variable_id_ = GetDimensionID(new_var);
           }
 
           virtual void SetSize(int new_size) {
@@ -206,6 +219,7 @@ namespace maestro {
 
           virtual void SetVariable(std::string new_var) {
             variable_ = new_var;
+            variable_id_ = GetDimensionID(new_var);
           }
 
           virtual void SetSize(int new_size) {
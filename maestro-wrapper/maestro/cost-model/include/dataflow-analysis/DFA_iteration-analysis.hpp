@@ -31,6 +31,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <string>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_iteration-status.hpp"
@@ -51,32 +52,87 @@ namespace maestro {
             logfile_.open(logfile, std::fstream::app);
           }
 
-          valid_iteration_states_ = std::make_shared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationState>>>>>();
-          iteration_status_table_ = std::make_shared<std::vector<std::shared_ptr<IterationStatus>>>();
+          valid_iteration_states_ = MakeShared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationState>>>>>();
           AnalyzeIterationStates();
-          ConstructIterationStatusTable();
+          AnalyzeChangeFrequencies();
         }
 
         std::string ToString() {
           std::string ret = "";
 
-          for(auto& iter_status : *iteration_status_table_) {
+          for(auto& iter_status : *GetAllIterationsStatus()) {
             ret += iter_status->ToString();
           }
 
           return ret;
         }
 
+        // The status table is only built on request; the cost analysis walks the cases with
+        // GetFirstIterationCase and GetNextIterationCase instead
         std::shared_ptr<std::vector<std::shared_ptr<IterationStatus>>> GetAllIterationsStatus() {
+          if(iteration_status_table_ == nullptr) {
+            iteration_status_table_ = MakeShared<std::vector<std::shared_ptr<IterationStatus>>>();
+            ConstructIterationStatusTable();
+          }
           return iteration_status_table_;
         }
 
+        int GetNumIterationCases() {
+          return num_total_cases_;
+        }
+
+        // Possible states of the directive at directive_idx, Init first
+        std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationState>>> GetIterationStates(int directive_idx) {
+          return valid_iteration_states_->at(directive_idx);
+        }
+
+        // A case is the state index of every directive; this is case 0 of the status table
+        std::vector<int> GetFirstIterationCase() {
+          return std::vector<int>(valid_iteration_states_->size(), 0);
+        }
+
+        // Moves state_indices from case case_id of the status table to case case_id + 1
+        void GetNextIterationCase(int case_id, std::vector<int>& state_indices) {
+          for(int idx = 0; idx < static_cast<int>(state_indices.size()); idx++) {
+            if(case_id % change_frequencies_[idx] == 0) {
+              int state_idx = state_indices[idx];
+              if(state_idx + 1 == static_cast<int>(valid_iteration_states_->at(idx)->size())) {
+                state_indices[idx] = 0;
+              }
+              else {
+                state_indices[idx] = state_idx + 1;
+              }
+            }
+          }
+        }
+
+        std::shared_ptr<IterationStatus> GetIterationStatus(std::vector<int> const & state_indices) {
+          std::shared_ptr<IterationStatus> iter_status = MakeShared<IterationStatus>();
+          for(int idx = 0; idx < static_cast<int>(state_indices.size()); idx++) {
+            iter_status->AddIterState(valid_iteration_states_->at(idx)->at(state_indices[idx]));
+          }
+          iter_status->SetNumOccurrences(GetNumOccurrences(state_indices));
+          return iter_status;
+        }
+
+        int GetNumOccurrences(std::vector<int> const & state_indices) {
+          int num_occurrence = 1;
+          for(int idx = 0; idx < static_cast<int>(state_indices.size()); idx++) {
+            num_occurrence *= valid_iteration_states_->at(idx)->at(state_indices[idx])->GetNumOccurrence();
+          }
+          return num_occurrence;
+        }
+
       protected:
         std::shared_ptr<DFA::DimensionTable> dimensions_;
         std::shared_ptr<DFA::ClusterUnit> cluster_;
 
         std::shared_ptr<std::vector<std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationState>>>>> valid_iteration_states_;
-        std::shared_ptr<std::vector<std::shared_ptr<IterationStatus>>> iteration_status_table_;
+        std::shared_ptr<std::vector<std::shared_ptr<IterationStatus>>> iteration_status_table_ = nullptr;
+
+        // The state of a directive changes every change_frequencies_[idx] cases
+        std::vector<int> change_frequencies_;
+        int num_total_cases_ = 1;
 
         std::ofstream logfile_;
 
@@ -95,13 +151,13 @@ namespace maestro {
             int map_size = directive->GetSize();
             int map_ofs = directive->GetOfs();
 
-            std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationState>>> iter_state_list = std::make_shared<std::vector<std::shared_ptr<DFA::IterationState>>>();
+            std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationState>>> iter_state_list = MakeShared<std::vector<std::shared_ptr<DFA::IterationState>>>();
 
             if(directive_class == DFA::directive::DirectiveClass::TemporalMap) {
               // 1. Init case
               bool is_init_unroll = dim_size <= map_size;
               bool is_init_edge = dim_size < map_size;
-              auto init_state = std::make_shared<DFA::IterationState>(directive_var, IterationPosition::Init, 1, is_init_unroll, is_init_edge);
+              auto init_state = MakeShared<DFA::IterationState>(directive_var, IterationPosition::Init, 1, is_init_unroll, is_init_edge);
               iter_state_list->push_back(init_state);
 
               // 2. Steady case
@@ -114,14 +170,14 @@ namespace maestro {
 #endif
 
               if(has_tp_steady_state && num_tp_steady_iters > 0) {
-                auto steady_state = std::make_shared<DFA::IterationState>(directive_var, IterationPosition::Steady, num_tp_steady_iters, false, false);
+                auto steady_state = MakeShared<DFA::IterationState>(directive_var, IterationPosition::Steady, num_tp_steady_iters, false, false);
 
                 iter_state_list->push_back(steady_state);
               }
 
               // 3. Edge case
               if(!is_init_edge && has_tp_edge_state) {
-                auto edge_state = std::make_shared<DFA::IterationState>(directive_var, IterationPosition::Edge, 1, false, false);
+                auto edge_state = MakeShared<DFA::IterationState>(directive_var, IterationPosition::Edge, 1, false, false);
                 iter_state_list->push_back(edge_state);
               }
             }  // End of if (directive_class == TemporalMap)
@@ -136,7 +192,7 @@ namespace maestro {
               bool has_init_sp_edge_edge = is_init_edge;
 //              bool has_init_sp_edge_edge = is_init_edge && (init_edge_normal_sp_iters * map_ofs + map_size > dim_size);
 
-              auto init_state = std::make_shared<DFA::IterationState>(directive_var, IterationPosition::Init, 1, is_init_unroll, is_init_edge, has_init_sp_edge_edge);
+              auto init_state = MakeShared<DFA::IterationState>(directive_var, IterationPosition::Init, 1, is_init_unroll, is_init_edge, has_init_sp_edge_edge);
               iter_state_list->push_back(init_state);
 
               // 2. Steady case
@@ -161,7 +217,7 @@ namespace maestro {
 #endif
 
               if(has_sp_steady_state && num_sp_steady_iters > 0) {
-                auto steady_state = std::make_shared<DFA::IterationState>(directive_var, IterationPosition::Steady, num_sp_steady_iters, false, false);
+                auto steady_state = MakeShared<DFA::IterationState>(directive_var, IterationPosition::Steady, num_sp_steady_iters, false, false);
                 iter_state_list->push_back(steady_state);
               }
 
@@ -192,7 +248,7 @@ namespace maestro {
               }
 
               if(!is_init_edge && has_sp_edge_state) {
-                auto edge_state = std::make_shared<DFA::IterationState>(directive_var, IterationPosition::Edge, 1, false, false, has_sp_edge_edge);
+                auto edge_state = MakeShared<DFA::IterationState>(directive_var, IterationPosition::Edge, 1, false, false, has_sp_edge_edge);
                 iter_state_list->push_back(edge_state);
               }
             } // End of else if (directive_class == SpatialMap)
@@ -201,60 +257,25 @@ namespace maestro {
           } // End of for_each (directive in dataflow)
         } // End of void AnalyzeIterationStates
 
-        void ConstructIterationStatusTable() {
-          int num_dimensions = valid_iteration_states_->size();
-
-          int num_total_cases = 1;
+        void AnalyzeChangeFrequencies() {
+          num_total_cases_ = 1;
           for(auto& dim_iter_states : *valid_iteration_states_) {
-            num_total_cases *=  dim_iter_states->size();
+            num_total_cases_ *=  dim_iter_states->size();
           }
 
-          std::unique_ptr<std::vector<int>> recursive_occurrence_counters = std::make_unique<std::vector<int>>();
-
-          std::reverse(valid_iteration_states_->begin(), valid_iteration_states_->end());
+          change_frequencies_.resize(valid_iteration_states_->size());
           int num_accumulative_occurrences = 1;
-          for(auto& dim_iter_states : *valid_iteration_states_) {
-            recursive_occurrence_counters->push_back(num_accumulative_occurrences);
-            num_accumulative_occurrences *= dim_iter_states->size();
-          }
-          std::reverse(valid_iteration_states_->begin(), valid_iteration_states_->end());
-          std::reverse(recursive_occurrence_counters->begin(), recursive_occurrence_counters->end());
-
-          std::unique_ptr<std::vector<int>> iteration_counters = std::make_unique<std::vector<int>>();
-          for(int i = 0; i < num_dimensions; i++) {
-            iteration_counters->push_back(0);
+          for(int idx = valid_iteration_states_->size() - 1; idx >= 0; idx--) {
+            change_frequencies_[idx] = num_accumulative_occurrences;
+            num_accumulative_occurrences *= valid_iteration_states_->at(idx)->size();
           }
+        } // End of void AnalyzeChangeFrequencies
 
-
-          for(int case_id = 0; case_id < num_total_cases; case_id++) {
-            std::shared_ptr<IterationStatus> iter_status_this_case = std::make_shared<IterationStatus>();
-
-            int num_occurrence = 1;
-            int idx = 0;
-
-            for(auto& dim_iter_states : *valid_iteration_states_) {
-              int change_frequency = recursive_occurrence_counters->at(idx);
-              int state_idx = iteration_counters->at(idx);
-
-              auto this_state = dim_iter_states->at(state_idx);
-              iter_status_this_case->AddIterState(this_state);
-
-              num_occurrence *= this_state->GetNumOccurrence();
-
-              if(case_id % change_frequency == 0) {
-                if(state_idx + 1 == ((int) dim_iter_states->size())) {
-                  iteration_counters->at(idx) = 0;
-                }
-                else {
-                  iteration_counters->at(idx) = state_idx + 1;
-                }
-              }
-
-              idx++;
-            }
-
-            iter_status_this_case->SetNumOccurrences(num_occurrence);
-            iteration_status_table_->push_back(iter_status_this_case);
+        void ConstructIterationStatusTable() {
+          std::vector<int> state_indices = GetFirstIterationCase();
+          for(int case_id = 0; case_id < num_total_cases_; case_id++) {
+            iteration_status_table_->push_back(GetIterationStatus(state_indices));
+            GetNextIterationCase(case_id, state_indices);
           }
         } // End of void ConstructIterationStatusTable
     }; // End of class IterationAnalysis
@@ -23,6 +23,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #ifndef MAESTRO_DFA_ITERATION_STATUS_HPP_
 #define MAESTRO_DFA_ITERATION_STATUS_HPP_
 
+#include <array>
 #include <memory>
 
 #include "BASE_constants.hpp"
@@ -30,6 +31,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include "BASE_maestro-class.hpp"
 #include "TL_error-handler.hpp"
 
+#include "DFA_dimension-id.hpp"
+
 namespace maestro {
   namespace DFA {
     enum class IterationPosition {Init, Steady, Edge, NumIterationPosition};
@@ -47,6 +50,7 @@ namespace maestro {
         ) :
             MAESTROClass("IterationState"),
             dimension_variable_(dimension_variable),
+            dimension_id_(GetDimensionID(dimension_variable)),
             iter_position_(iter_position),
             num_occurrence_(num_occurrence),
             is_unrolled_(is_unrolled),
@@ -115,6 +119,10 @@ namespace maestro {
           return dimension_variable_;
         }
 
+        DimensionID GetDimID() {
+          return dimension_id_;
+        }
+
         IterationPosition GetIterPosition() {
           return iter_position_;
         }
@@ -137,6 +145,7 @@ namespace maestro {
 
       protected:
         std::string dimension_variable_;
+        DimensionID dimension_id_;
         IterationPosition iter_position_;
         int num_occurrence_;
         bool is_unrolled_;
@@ -150,60 +159,58 @@ namespace maestro {
         IterationStatus() :
           MAESTROClass("IterationStatus"),
           num_occurrences_(1) {
-          iter_states_ = std::make_shared<std::map<std::string, std::shared_ptr<IterationState>>>();
         }
 
         IterationStatus(int num_occurrences) :
           num_occurrences_(num_occurrences) {
-          iter_states_ = std::make_shared<std::map<std::string, std::shared_ptr<IterationState>>>();
         }
 
+        // Visits the iteration states in DimensionID order, skipping dimensions without a state
         class iterator {
           private:
-            std::shared_ptr<std::map<std::string, std::shared_ptr<IterationState>>> map_ptr_;
-            std::map<std::string, std::shared_ptr<IterationState>>::iterator map_iterator_;
+            IterationStatus* status_;
+            int curr_idx_;
+
+            void SkipMissing() {
+              while(curr_idx_ < num_dimension_ids && status_->iter_states_[curr_idx_] == nullptr) {
+                curr_idx_++;
+              }
+            }
+
           public:
 
-            iterator(std::shared_ptr<std::map<std::string, std::shared_ptr<IterationState>>> ptr_iter_states_) :
-              map_ptr_(ptr_iter_states_) {
-              map_iterator_ = ptr_iter_states_->begin();
+            iterator(IterationStatus* status, int idx) :
+              status_(status),
+              curr_idx_(idx) {
+              SkipMissing();
             }
 
             iterator operator++() {
-              map_iterator_++;
+              curr_idx_++;
+              SkipMissing();
               return *this;
-              /*
-              this->curr_idx_++;
-              iterator iter = *this;
-              return iter;
-              */
             }
 
             std::shared_ptr<IterationState>& operator*() {
-              return map_iterator_->second;
+              return status_->iter_states_[curr_idx_];
             }
 
             bool operator==(const iterator& rhs) {
-              return (this->map_iterator_ == rhs.map_iterator_);
+              return (this->curr_idx_ == rhs.curr_idx_);
             }
 
             bool operator!=(const iterator& rhs) {
-              return (this->map_iterator_ != rhs.map_iterator_);
-            }
-
-            void set_end () {
-              map_iterator_ = map_ptr_->end();
+              return (this->curr_idx_ != rhs.curr_idx_);
             }
-        }; // End of class iterator for class Directive_table
+        }; // End of class iterator for class IterationStatus
 
         iterator begin() {
-          iterator iter(iter_states_);
+          iterator iter(this, 0);
           return iter;
         }
 
         iterator end() {
-          iterator iter(iter_states_);
-          iter.set_end();
+          iterator iter(this, num_dimension_ids);
           return iter;
         }
 
@@ -213,8 +220,8 @@ namespace maestro {
           ret += "Num status occurrences: " + std::to_string(num_occurrences_) + " \n";
           ret += "Iteration states: \n";
 
-          for(auto& iter_state: *iter_states_) {
-            ret += iter_state.second->ToString();
+          for(auto& iter_state: *this) {
+            ret += iter_state->ToString();
           }
 
           ret += "----------------------------\n";
@@ -231,18 +238,22 @@ namespace maestro {
         }
 
         void AddIterState(std::shared_ptr<IterationState> iter_state) {
-          (*iter_states_)[iter_state->GetDimVariable()] = iter_state;
+          iter_states_[static_cast<int>(iter_state->GetDimID())] = iter_state;
+        }
+
+        std::shared_ptr<IterationState> GetIterState(DimensionID dim_id) {
+          return iter_states_[static_cast<int>(dim_id)];
         }
 
         std::shared_ptr<IterationState> GetIterState(std::string dim_var) {
-          return (*iter_states_)[dim_var];
+          return GetIterState(GetDimensionID(dim_var));
         }
 
         bool isAllInit() {
           bool ret = true;
 
-          for(auto& iter_state : *iter_states_ ) {
-            if(iter_state.second->GetIterPosition() != DFA::IterationPosition::Init) {
+          for(auto& iter_state : *this) {
+            if(iter_state->GetIterPosition() != DFA::IterationPosition::Init) {
               ret = false;
             }
           }
@@ -253,8 +264,8 @@ namespace maestro {
         bool HasSpEdgeEdgeCase() {
           bool ret = false;
 
-          for(auto& iter_state : *iter_states_ ) {
-            if(iter_state.second->HasSpEdgeEdge()) {
+          for(auto& iter_state : *this) {
+            if(iter_state->HasSpEdgeEdge()) {
               ret = true;
             }
           }
@@ -264,7 +275,7 @@ namespace maestro {
 
       protected:
         int num_occurrences_ = 1;
-        std::shared_ptr<std::map<std::string, std::shared_ptr<IterationState>>> iter_states_;
+        std::array<std::shared_ptr<IterationState>, num_dimension_ids + 1> iter_states_;
 
     }; // End of class IterationStatus
 
@@ -27,6 +27,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include<memory>
 #include<vector>
 
+#include "BASE_memory-arena.hpp"
+
 #include "DFA_layer.hpp"
 
 namespace maestro{
@@ -86,12 +88,12 @@ namespace maestro{
         }
 
     		NeuralNetwork() {
-    		  layers_ = std::make_shared<std::vector<std::shared_ptr<Layer>>>();
+    		  layers_ = MakeShared<std::vector<std::shared_ptr<Layer>>>();
     		}
 
     		NeuralNetwork(std::string name) :
     			name_(name) {
-    		  layers_ = std::make_shared<std::vector<std::shared_ptr<Layer>>>();
+    		  layers_ = MakeShared<std::vector<std::shared_ptr<Layer>>>();
     		}
 
     		std::string GetName() {
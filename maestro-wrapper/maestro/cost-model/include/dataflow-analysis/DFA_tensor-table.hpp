@@ -27,6 +27,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <vector>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_memory-arena.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_tensor.hpp"
@@ -82,7 +83,7 @@ namespace maestro {
 
 
         TensorTable() {
-          tensors_ = std::make_shared<std::vector<std::shared_ptr<DFA::Tensor>>>();
+          tensors_ = MakeShared<std::vector<std::shared_ptr<DFA::Tensor>>>();
         }
 
         std::shared_ptr<DFA::Tensor> at (size_t idx) {
@@ -105,13 +106,13 @@ namespace maestro {
 
         void AddTensor(std::string tensor_name, DFA::TensorClass tensor_class, DataClass data_class, std::vector<std::string> correlated_varaibles) {
 
-          std::shared_ptr<std::list<std::string>> corr_vars_to_be_added = std::make_shared<std::list<std::string>>();
+          std::shared_ptr<std::list<std::string>> corr_vars_to_be_added = MakeShared<std::list<std::string>>();
 
           for(auto var : correlated_varaibles) {
             corr_vars_to_be_added->push_back(var);
           }
 
-          auto new_tensor = std::make_shared<DFA::Tensor>(tensor_name, tensor_class, data_class, corr_vars_to_be_added);
+          auto new_tensor = MakeShared<DFA::Tensor>(tensor_name, tensor_class, data_class, corr_vars_to_be_added);
           tensors_->push_back(new_tensor);
         }
 
@@ -128,7 +129,7 @@ namespace maestro {
         }
 
         std::shared_ptr<std::list<std::string>> GetTensorVarsInClass(DFA::TensorClass tensor_class) {
-          std::shared_ptr<std::list<std::string>> ret = std::make_shared<std::list<std::string>>();
+          std::shared_ptr<std::list<std::string>> ret = MakeShared<std::list<std::string>>();
 
           for(auto& tensor : *tensors_) {
             if(tensor->GetTensorClass() == tensor_class) {
@@ -146,7 +147,7 @@ namespace maestro {
         }
 
         std::shared_ptr<std::list<std::shared_ptr<DFA::Tensor>>> GetTensorsInClass(DFA::TensorClass tensor_class) {
-          std::shared_ptr<std::list<std::shared_ptr<DFA::Tensor>>> ret = std::make_shared<std::list<std::shared_ptr<DFA::Tensor>>>();
+          std::shared_ptr<std::list<std::shared_ptr<DFA::Tensor>>> ret = MakeShared<std::list<std::shared_ptr<DFA::Tensor>>>();
 
           for(auto& tensor : *tensors_) {
             if(tensor->GetTensorClass() == tensor_class) {
@@ -28,6 +28,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "BASE_constants.hpp"
 
+#include "DFA_dimension-id.hpp"
+
 namespace maestro {
 	namespace DFA {
 
@@ -43,6 +45,9 @@ namespace maestro {
 				  tensor_class_(tensor_class),
 				  data_class_(data_class),
 				  coupled_variables_(correlated_variables) {
+				  for(auto& var : *coupled_variables_) {
+				    coupled_variable_mask_ |= GetDimensionMask(GetDimensionID(var));
+				  }
 				}
 
 				std::string GetTensorName() {
@@ -61,15 +66,16 @@ namespace maestro {
 				  return coupled_variables_;
 				}
 
+				DimensionMask GetCoupledVariableMask() {
+				  return coupled_variable_mask_;
+				}
+
+				bool HasVariable(DimensionID search_var) {
+				  return (coupled_variable_mask_ & GetDimensionMask(search_var)) != 0;
+				}
+
 				bool HasVariable(std::string search_var) {
-				  bool ret =false;
-				  for(auto& var : *coupled_variables_) {
-				    if(var == search_var) {
-				      ret = true;
-				      break;
-				    }
-				  }
-				  return ret;
+				  return HasVariable(GetDimensionID(search_var));
 				}
 
 			protected:
@@ -77,6 +83,7 @@ namespace maestro {
 				TensorClass tensor_class_;
 				DataClass data_class_;
 				std::shared_ptr<std::list<std::string>> coupled_variables_;
+				DimensionMask coupled_variable_mask_ = 0;
 		}; // End of class Tensor
 
 	}; // End of namespace DFA
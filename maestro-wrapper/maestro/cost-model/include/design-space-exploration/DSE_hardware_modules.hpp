@@ -27,6 +27,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <vector>
 #include <memory>
 
+#include "BASE_memory-arena.hpp"
+
 #include "DSE_scaling-coefficients.hpp"
 #include "DSE_cost-database.hpp"
 
@@ -212,40 +214,52 @@ namespace maestro {
 
 		      num_pes_ = num_pes;
 		      vector_width_ = vector_width;
+		      bit_width_ = bit_width;
 		      noc_bw_ = noc_bw;
+		      l1_sram_byte_size_ = l1_sram_byte_size;
+		      l2_sram_byte_size_ = l2_sram_byte_size;
 
-		      auto pe_array = std::make_shared<DSE::HardwareModule>();
-
-		      for(int peID = 0; peID < num_pes; peID++) {
-		        std::shared_ptr<DSE::HardwareModule> pe = std::make_shared<DSE::HardwareModule>();
-		        std::shared_ptr<DSE::HardwareModule> mac = std::make_shared<DSE::MAC>(cost::mac_area, cost::mac_power, bit_width, vector_width);
-		        std::shared_ptr<DSE::HardwareModule> l1_sram = std::make_shared<DSE::SRAM>(cost::sram_area_64, cost::sram_power_64, cost::sram_unit_size_64, bit_width, l1_sram_byte_size);
+		      pe_array_ = BuildPEArray();
+		      l2_sram_ = BuildL2SRAM();
+		      noc_ = BuildNoC();
 
-		        pe->AddSubmodule(mac);
-		        pe->AddSubmodule(l1_sram);
-		        pe_array->AddSubmodule(pe);
+		      this->AddSubmodule(pe_array_);
+          this->AddSubmodule(l2_sram_);
+          this->AddSubmodule(noc_);
+		    }
 
-            l1_sram_power_ += l1_sram->GetPower();
-            pe_power_ += mac->GetPower();
+		    // Rebuilds only the parts of a model built by ReconstructAccelerator above whose
+		    // parameters changed; the model ends up the same as a new one with these parameters
+		    void UpdateAccelerator (int num_pes, int vector_width, int bit_width, int noc_bw, int l1_sram_byte_size, int l2_sram_byte_size) {
+		      if(pe_array_ == nullptr) {
+		        ReconstructAccelerator(num_pes, vector_width, bit_width, noc_bw, l1_sram_byte_size, l2_sram_byte_size);
+		        return;
 		      }
 
-		      /* L2 Buffer */
-          auto l2_sram = std::make_shared<DSE::SRAM>(cost::sram_area_32768, cost::sram_power_32768, cost::sram_unit_size_32768, bit_width, l2_sram_byte_size);
-          l2_sram_power_ = l2_sram->GetPower();
-
-		      /* NoC */
-          auto noc = std::make_shared<DSE::HardwareModule>();
-          std::shared_ptr<DSE::HardwareModule> bus = std::make_shared<DSE::Bus>(cost::bus_unit_area, cost::bus_unit_power, num_pes, noc_bw);
-          std::shared_ptr<DSE::HardwareModule> arbiter = std::make_shared<DSE::MatrixArbiter>(cost::arbiter_unit_area, cost::arbiter_unit_power, num_pes);
-
-		      noc->AddSubmodule(bus);
-		      noc->AddSubmodule(arbiter);
+		      bool pe_array_changed = num_pes != num_pes_ || vector_width != vector_width_ || bit_width != bit_width_
+		          || l1_sram_byte_size != l1_sram_byte_size_;
+		      bool l2_sram_changed = bit_width != bit_width_ || l2_sram_byte_size != l2_sram_byte_size_;
+		      bool noc_changed = num_pes != num_pes_ || noc_bw != noc_bw_;
 
-		      noc_power_ = noc->GetPower();
+		      num_pes_ = num_pes;
+		      vector_width_ = vector_width;
+		      bit_width_ = bit_width;
+		      noc_bw_ = noc_bw;
+		      l1_sram_byte_size_ = l1_sram_byte_size;
+		      l2_sram_byte_size_ = l2_sram_byte_size;
 
-		      this->AddSubmodule(pe_array);
-          this->AddSubmodule(l2_sram);
-          this->AddSubmodule(noc);
+		      if(pe_array_changed) {
+		        pe_array_ = BuildPEArray();
+		        submodules_[0] = pe_array_;
+		      }
+		      if(l2_sram_changed) {
+		        l2_sram_ = BuildL2SRAM();
+		        submodules_[1] = l2_sram_;
+		      }
+		      if(noc_changed) {
+		        noc_ = BuildNoC();
+		        submodules_[2] = noc_;
+		      }
 		    }
 
 		    void ReconstructAccelerator (int num_pes,  int vector_width, int bit_width,
@@ -253,17 +267,18 @@ namespace maestro {
 		        int l1_sram_byte_size, int l2_sram_byte_size) {
 
           this->ClearSubmodules();
+          pe_array_ = nullptr;
 
           num_pes_ = num_pes;
           vector_width_ = vector_width;
           noc_bw_ = noc_bw->at(0);
 
-          auto pe_array = std::make_shared<DSE::HardwareModule>();
+          auto pe_array = MakeShared<DSE::HardwareModule>();
 
           for(int peID = 0; peID < num_pes; peID++) {
-            std::shared_ptr<DSE::HardwareModule> pe = std::make_shared<DSE::HardwareModule>();
-            std::shared_ptr<DSE::HardwareModule> mac = std::make_shared<DSE::MAC>(cost::mac_area, cost::mac_power, bit_width, vector_width);
-            std::shared_ptr<DSE::HardwareModule> l1_sram = std::make_shared<DSE::SRAM>(cost::sram_area_64, cost::sram_power_64, cost::sram_unit_size_64, bit_width, l1_sram_byte_size);
+            std::shared_ptr<DSE::HardwareModule> pe = MakeShared<DSE::HardwareModule>();
+            std::shared_ptr<DSE::HardwareModule> mac = MakeShared<DSE::MAC>(cost::mac_area, cost::mac_power, bit_width, vector_width);
+            std::shared_ptr<DSE::HardwareModule> l1_sram = MakeShared<DSE::SRAM>(cost::sram_area_64, cost::sram_power_64, cost::sram_unit_size_64, bit_width, l1_sram_byte_size);
 
             pe->AddSubmodule(mac);
             pe->AddSubmodule(l1_sram);
@@ -274,11 +289,11 @@ namespace maestro {
           }
 
           /* L2 Buffer */
-          auto l2_sram = std::make_shared<DSE::SRAM>(cost::sram_area_32768, cost::sram_power_32768, cost::sram_unit_size_32768, bit_width, l2_sram_byte_size);
+          auto l2_sram = MakeShared<DSE::SRAM>(cost::sram_area_32768, cost::sram_power_32768, cost::sram_unit_size_32768, bit_width, l2_sram_byte_size);
           l2_sram_power_ = l2_sram->GetPower();
 
           /* NoC */
-          auto noc = std::make_shared<DSE::HardwareModule>();
+          auto noc = MakeShared<DSE::HardwareModule>();
 
           int num_target_clusters = num_pes;
           for(int cluster_lv = cluster_sizes->size()-1; cluster_lv >= 0; cluster_lv--) {
@@ -294,8 +309,8 @@ namespace maestro {
             int num_sub_clusters_per_clsuter = cluster_sizes->at(cluster_lv);
             num_target_clusters = num_target_clusters /cluster_sizes->at(cluster_lv);
             for(int num_sub_nocs = 0; num_sub_nocs < num_target_clusters; num_sub_nocs ++) {
-              std::shared_ptr<DSE::HardwareModule> bus = std::make_shared<DSE::Bus>(cost::bus_unit_area, cost::bus_unit_power, num_sub_clusters_per_clsuter, bw);
-              std::shared_ptr<DSE::HardwareModule> arbiter = std::make_shared<DSE::MatrixArbiter>(cost::arbiter_unit_area, cost::arbiter_unit_power, num_sub_clusters_per_clsuter);
+              std::shared_ptr<DSE::HardwareModule> bus = MakeShared<DSE::Bus>(cost::bus_unit_area, cost::bus_unit_power, num_sub_clusters_per_clsuter, bw);
+              std::shared_ptr<DSE::HardwareModule> arbiter = MakeShared<DSE::MatrixArbiter>(cost::arbiter_unit_area, cost::arbiter_unit_power, num_sub_clusters_per_clsuter);
 
               noc->AddSubmodule(bus);
               noc->AddSubmodule(arbiter);
@@ -343,10 +358,58 @@ namespace maestro {
 		    int vector_width_;
 		    int bit_width_;
 		    int noc_bw_;
+		    int l1_sram_byte_size_ = 0;
+		    int l2_sram_byte_size_ = 0;
 		    double l2_sram_power_ = 0;
 		    double l1_sram_power_ = 0;
 		    double pe_power_ = 0;
 		    double noc_power_ = 0;
+
+		    // Parts of a model built by the single-NoC ReconstructAccelerator
+		    std::shared_ptr<HardwareModule> pe_array_;
+		    std::shared_ptr<HardwareModule> l2_sram_;
+		    std::shared_ptr<HardwareModule> noc_;
+
+		  private:
+		    // Every PE is the same, so the array holds one PE num_pes_ times
+		    std::shared_ptr<HardwareModule> BuildPEArray() {
+		      auto pe_array = MakeShared<DSE::HardwareModule>();
+
+		      std::shared_ptr<DSE::HardwareModule> pe = MakeShared<DSE::HardwareModule>();
+		      std::shared_ptr<DSE::HardwareModule> mac = MakeShared<DSE::MAC>(cost::mac_area, cost::mac_power, bit_width_, vector_width_);
+		      std::shared_ptr<DSE::HardwareModule> l1_sram = MakeShared<DSE::SRAM>(cost::sram_area_64, cost::sram_power_64, cost::sram_unit_size_64, bit_width_, l1_sram_byte_size_);
+		      pe->AddSubmodule(mac);
+		      pe->AddSubmodule(l1_sram);
+
+		      l1_sram_power_ = 0;
+		      pe_power_ = 0;
+		      for(int peID = 0; peID < num_pes_; peID++) {
+		        pe_array->AddSubmodule(pe);
+
+		        l1_sram_power_ += l1_sram->GetPower();
+		        pe_power_ += mac->GetPower();
+		      }
+
+		      return pe_array;
+		    }
+
+		    std::shared_ptr<HardwareModule> BuildL2SRAM() {
+		      auto l2_sram = MakeShared<DSE::SRAM>(cost::sram_area_32768, cost::sram_power_32768, cost::sram_unit_size_32768, bit_width_, l2_sram_byte_size_);
+		      l2_sram_power_ = l2_sram->GetPower();
+		      return l2_sram;
+		    }
+
+		    std::shared_ptr<HardwareModule> BuildNoC() {
+		      auto noc = MakeShared<DSE::HardwareModule>();
+		      std::shared_ptr<DSE::HardwareModule> bus = MakeShared<DSE::Bus>(cost::bus_unit_area, cost::bus_unit_power, num_pes_, noc_bw_);
+		      std::shared_ptr<DSE::HardwareModule> arbiter = MakeShared<DSE::MatrixArbiter>(cost::arbiter_unit_area, cost::arbiter_unit_power, num_pes_);
+
+		      noc->AddSubmodule(bus);
+		      noc->AddSubmodule(arbiter);
+
+		      noc_power_ = noc->GetPower();
+		      return noc;
+		    }
 		}; // End of class Accelerator
 
 
@@ -88,8 +88,11 @@ namespace maestro {
       uint64_t n_parallel = 1;
       uint64_t space_id_start = 0;
       uint64_t space_id_end = std::numeric_limits<uint64_t>::max();
+      uint64_t top_k = 1;
+      uint64_t num_workers = 0;
 
       std::string result_file = "";
+      std::string coordinator = "";
       std::string analysis_layer = "alexnet_conv2";
       std::string analysis_accelerator = "eyeriss_validation";
       std::string analysis_mode = "single";
@@ -164,6 +167,9 @@ namespace maestro {
             ("n_parallel", po::value<uint64_t>(&n_parallel), "Number of parallel threads")
             ("space_id_start", po::value<uint64_t>(&space_id_start), "Start index of space partition")
             ("space_id_end", po::value<uint64_t>(&space_id_end), "End index of space partition")
+            ("top_k", po::value<uint64_t>(&top_k), "Number of best points to report")
+            ("num_workers", po::value<uint64_t>(&num_workers), "Number of local sweep worker processes, which split the cores between them")
+            ("coordinator", po::value<std::string>(&coordinator), "Address of the sweep coordinator, unix:<path> or <host>:<port>")
             ("result_file", po::value<std::string>(&result_file), "CSV to write DSE results to")
           ;
 
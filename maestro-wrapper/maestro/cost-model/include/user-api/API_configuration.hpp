@@ -29,6 +29,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 //#include "option.hpp"
 
 #include "BASE_base-objects.hpp"
+#include "BASE_memory-arena.hpp"
 
 #include "DFA_tensor.hpp"
 #include "DFA_neural-network.hpp"
@@ -47,11 +48,11 @@ namespace maestro {
     public:
       Configuration(int num_pes, int vector_width, int bit_width, int top_noc_bw, int l1_sram_byte_size, int l2_sram_byte_size)
       : num_pes_(num_pes) {
-        network_= std::make_shared<DFA::NeuralNetwork>();
-        tensors_ = std::make_shared<DFA::TensorTable>();
-        nocs_ = std::make_shared<std::vector<std::shared_ptr<AHW::NetworkOnChipModel>>>();
-        cluster_analysis_= std::make_shared<std::vector<std::shared_ptr<DFA::ClusterAnalysis>>>();
-        target_accelerator_ = std::make_shared<DSE::Accelerator>
+        network_= MakeShared<DFA::NeuralNetwork>();
+        tensors_ = MakeShared<DFA::TensorTable>();
+        nocs_ = MakeShared<std::vector<std::shared_ptr<AHW::NetworkOnChipModel>>>();
+        cluster_analysis_= MakeShared<std::vector<std::shared_ptr<DFA::ClusterAnalysis>>>();
+        target_accelerator_ = MakeShared<DSE::Accelerator>
                                 (num_pes, vector_width, bit_width, top_noc_bw, l1_sram_byte_size, l2_sram_byte_size);
 
 
@@ -100,12 +101,12 @@ namespace maestro {
         simd_width_(simd_width),
         l1_size_(l1_sram_byte_size),
         l2_size_(l2_sram_byte_size) {
-        network_= std::make_shared<DFA::NeuralNetwork>();
-        tensors_ = std::make_shared<std::vector<std::shared_ptr<DFA::TensorTable>>>();
-        nocs_ = std::make_shared<std::vector<std::shared_ptr<AHW::NetworkOnChipModel>>>();
-        cluster_analysis_= std::make_shared<std::vector<std::shared_ptr<DFA::ClusterAnalysis>>>();
+        network_= MakeShared<DFA::NeuralNetwork>();
+        tensors_ = MakeShared<std::vector<std::shared_ptr<DFA::TensorTable>>>();
+        nocs_ = MakeShared<std::vector<std::shared_ptr<AHW::NetworkOnChipModel>>>();
+        cluster_analysis_= MakeShared<std::vector<std::shared_ptr<DFA::ClusterAnalysis>>>();
         //TODO: Update NoC setup processes
-        target_accelerator_ = std::make_shared<DSE::Accelerator>
+        target_accelerator_ = MakeShared<DSE::Accelerator>
                                 (num_pes, simd_width, bit_width, top_noc_bw, l1_sram_byte_size, l2_sram_byte_size);
       }
 
@@ -24,6 +24,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #define API_USER_INTERFACE_V2_HPP_
 
 #include <algorithm>
+#include <bitset>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -33,6 +34,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "BASE_maestro-class.hpp"
 #include "BASE_base-objects.hpp"
+#include "BASE_memory-arena.hpp"
 
 #include "TL_generic-csv-writer.hpp"
 
@@ -83,6 +85,9 @@ namespace maestro {
         MetricEnd
     };
 
+    // A set of MetricTypes, indexed by the metric
+    using MetricMask = std::bitset<MetricEnd>;
+
   class APIV2 : public MAESTROClass {
 
     public:
@@ -128,7 +133,11 @@ namespace maestro {
 
         assert(! print_log_to_file || logfile != "");
 //        std::shared_ptr<std::vector<std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>>>>
-        auto ret = std::make_shared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>>>>();
+        auto ret = MakeShared<std::vector<std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>>>>();
+
+        if(reuse_analysis_cache_ != nullptr) {
+          reuse_analysis_cache_->BeginEvaluation();
+        }
 
         int layer_id = 0;
         for(auto layer : *(configuration_->network_)) {
@@ -249,184 +258,207 @@ namespace maestro {
         return 0;
       }
 
+      // CostsT is anything indexable by MetricType, e.g. std::map<MetricType, long double> or a
+      // std::array<long double, MetricEnd>. Only the metrics in the mask are derived and assigned;
+      // the rest of costs is left untouched.
+      template<typename CostsT>
       void GetCostsFromAnalysisResultsSingleCluster(
               std::shared_ptr<CA::CostAnalyisResults> results,
-              std::map<maestro::MetricType, long double> &costs) {
+              CostsT &costs,
+              MetricMask const & metrics = MetricMask().set()) {
+        auto wants_any = [&](MetricType first, MetricType last) {
+          for(int metric = first; metric <= last; metric++) {
+            if(metrics.test(metric)) return true;
+          }
+          return false;
+        };
+
         long num_computations = results->GetNumComputations();
-        costs[Computations] = num_computations;
+        if(metrics.test(Computations)) costs[Computations] = num_computations;
 
         long num_abs_computations = results->GetTopNumComputations();
-        costs[AbsComputations] = (num_abs_computations);
-
-        costs[ExactRunTime] = results->GetRuntime(CA::EstimationType::Exact);
-        costs[MaxRunTime] = results->GetRuntime(CA::EstimationType::Max);
-        costs[MinRunTime] = results->GetRuntime(CA::EstimationType::Min);
+        if(metrics.test(AbsComputations)) costs[AbsComputations] = (num_abs_computations);
+
+        if(metrics.test(ExactRunTime)) costs[ExactRunTime] = results->GetRuntime(CA::EstimationType::Exact);
+        if(metrics.test(MaxRunTime)) costs[MaxRunTime] = results->GetRuntime(CA::EstimationType::Max);
+        if(metrics.test(MinRunTime)) costs[MinRunTime] = results->GetRuntime(CA::EstimationType::Min);
+
+        if(wants_any(Throughput, ThroughputMax)) {
+          long double throughput = static_cast<double>(num_computations) / results->GetRuntime(CA::EstimationType::Exact);
+          costs[Throughput] = throughput;
+          long double throughput_min = static_cast<double>(num_computations) / results->GetRuntime(CA::EstimationType::Max);
+          costs[ThroughputMin] = throughput_min;
+          long double throughput_max = static_cast<double>(num_computations) / results->GetRuntime(CA::EstimationType::Min);
+          costs[ThroughputMax] = throughput_max;
+        }
 
-        long double throughput = static_cast<double>(num_computations) / results->GetRuntime(CA::EstimationType::Exact);
-        costs[Throughput] = throughput;
-        long double throughput_min = static_cast<double>(num_computations) / results->GetRuntime(CA::EstimationType::Max);
-        costs[ThroughputMin] = throughput_min;
-        long double throughput_max = static_cast<double>(num_computations) / results->GetRuntime(CA::EstimationType::Min);
-        costs[ThroughputMax] = throughput_max;
-
-        long double abs_throughput = static_cast<long double>(num_abs_computations) / results->GetRuntime(CA::EstimationType::Exact);
-        costs[AbsThroughput] = (abs_throughput);
-        long double abs_throughput_min = static_cast<long double>(num_abs_computations) / results->GetRuntime(CA::EstimationType::Max);
-        costs[AbsThroughputMin] = (abs_throughput_min);
-        long double abs_throughput_max = static_cast<long double>(num_abs_computations) / results->GetRuntime(CA::EstimationType::Min);
-        costs[AbsThroughputMax] = (abs_throughput_max);
+        if(wants_any(AbsThroughput, AbsThroughputMax)) {
+          long double abs_throughput = static_cast<long double>(num_abs_computations) / results->GetRuntime(CA::EstimationType::Exact);
+          costs[AbsThroughput] = (abs_throughput);
+          long double abs_throughput_min = static_cast<long double>(num_abs_computations) / results->GetRuntime(CA::EstimationType::Max);
+          costs[AbsThroughputMin] = (abs_throughput_min);
+          long double abs_throughput_max = static_cast<long double>(num_abs_computations) / results->GetRuntime(CA::EstimationType::Min);
+          costs[AbsThroughputMax] = (abs_throughput_max);
+        }
 
         // int num_data_classes = static_cast<int>(DataClass::NumDataClasses);
 
-        long total_l1_write = 0;
-        long total_l1_read = 0;
-
         auto layer_type = results->GetLayerType();
         int tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
 
-        for(auto tensor : *(configuration_->tensors_->at(tensor_info_idx))) {
-          auto dataclass = tensor->GetDataClass();
+        if(wants_any(InputL2BufferReq, OverallReuseFactor)) {
+          long total_l1_write = 0;
+          long total_l1_read = 0;
+
+          for(auto tensor : *(configuration_->tensors_->at(tensor_info_idx))) {
+            auto dataclass = tensor->GetDataClass();
+
+            auto l2_buffer_req = results->GetBufferSizeReq(CA::BufferType::Upstream, dataclass);
+            auto l1_buffer_req = results->GetBufferSizeReq(CA::BufferType::Downstream, dataclass);
+
+            //L2 buffer write
+            auto l2_buffer_write = (results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, dataclass));
+
+            //L2 buffer read
+            auto l2_buffer_read = (results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, dataclass));
+
+            //L1 buffer write
+            auto l1_buffer_write = (results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, dataclass));
+
+            //L1 buffer read
+            auto l1_buffer_read = (results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, dataclass));
+
+            //Data reuse factor
+            auto reuse_factor = static_cast<double>(l1_buffer_read) / l1_buffer_write;
+            total_l1_write += l1_buffer_write;
+            total_l1_read += l1_buffer_read;
+
+            if(tensor->GetTensorName() == "input") {
+              costs[InputL2BufferReq] = l2_buffer_req;
+              costs[InputL1BufferReq] = l1_buffer_req;
+              costs[InputL2BufferWrite] = l2_buffer_write;
+              costs[InputL2BufferRead] = l2_buffer_read;
+              costs[InputL1BufferWrite] = l1_buffer_write;
+              costs[InputL1BufferRead] = l1_buffer_read;
+              costs[InputReuseFactor] = reuse_factor;
+            } else if(tensor->GetTensorName() == "filter") {
+              costs[FilterL2BufferReq] = l2_buffer_req;
+              costs[FilterL1BufferReq] = l1_buffer_req;
+              costs[FilterL2BufferWrite] = l2_buffer_write;
+              costs[FilterL2BufferRead] = l2_buffer_read;
+              costs[FilterL1BufferWrite] = l1_buffer_write;
+              costs[FilterL1BufferRead] = l1_buffer_read;
+              costs[FilterReuseFactor] = reuse_factor;
+            } else if(tensor->GetTensorName() == "output") {
+              costs[OutputL2BufferReq] = l2_buffer_req;
+              costs[OutputL1BufferReq] = l1_buffer_req;
+              costs[OutputL2BufferWrite] = l2_buffer_write;
+              costs[OutputL2BufferRead] = l2_buffer_read;
+              costs[OutputL1BufferWrite] = l1_buffer_write;
+              costs[OutputL1BufferRead] = l1_buffer_read;
+              costs[OutputReuseFactor] = reuse_factor;
+            } else {
+              assert(false);
+            }
+          }
 
-          auto l2_buffer_req = results->GetBufferSizeReq(CA::BufferType::Upstream, dataclass);
-          auto l1_buffer_req = results->GetBufferSizeReq(CA::BufferType::Downstream, dataclass);
-          
-          //L2 buffer write
-          auto l2_buffer_write = (results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, dataclass));
+          //Overall reuse factor
+          costs[OverallReuseFactor] = (static_cast<double>(total_l1_read) / static_cast<double>(total_l1_write));
+        }
 
-          //L2 buffer read
-          auto l2_buffer_read = (results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, dataclass));
+        if(wants_any(InputL2BufferWriteEnergy, OverallEnergy)) {
+          bool per_tensor_energy = wants_any(InputL2BufferWriteEnergy, OutputL1BufferReadEnergy);
 
-          //L1 buffer write
-          auto l1_buffer_write = (results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, dataclass));
+          long double l2_write_energy = 0;
+          long double l2_read_energy = 0;
+          long double l1_write_energy = 0;
+          long double l1_read_energy = 0;
+          long double total_energy = 0;
 
-          //L1 buffer read
-          auto l1_buffer_read = (results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, dataclass));
+          long double tmp;
+          for(auto tensor : *(configuration_->tensors_->at(tensor_info_idx))) {
+            auto dataclass = tensor->GetDataClass();
 
-          //Data reuse factor
-          auto reuse_factor = static_cast<double>(results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, dataclass))
-                      / results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, dataclass);
-          total_l1_write += results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, dataclass);
-          total_l1_read += results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, dataclass);
-          
-          if(tensor->GetTensorName() == "input") {
-            costs[InputL2BufferReq] = l2_buffer_req;
-            costs[InputL1BufferReq] = l1_buffer_req;
-            costs[InputL2BufferWrite] = l2_buffer_write;
-            costs[InputL2BufferRead] = l2_buffer_read;
-            costs[InputL1BufferWrite] = l1_buffer_write;
-            costs[InputL1BufferRead] = l1_buffer_read;
-            costs[InputReuseFactor] = reuse_factor;
-          } else if(tensor->GetTensorName() == "filter") {
-            costs[FilterL2BufferReq] = l2_buffer_req;
-            costs[FilterL1BufferReq] = l1_buffer_req;
-            costs[FilterL2BufferWrite] = l2_buffer_write;
-            costs[FilterL2BufferRead] = l2_buffer_read;
-            costs[FilterL1BufferWrite] = l1_buffer_write;
-            costs[FilterL1BufferRead] = l1_buffer_read;
-            costs[FilterReuseFactor] = reuse_factor;
-          } else if(tensor->GetTensorName() == "output") {
-            costs[OutputL2BufferReq] = l2_buffer_req;
-            costs[OutputL1BufferReq] = l1_buffer_req;
-            costs[OutputL2BufferWrite] = l2_buffer_write;
-            costs[OutputL2BufferRead] = l2_buffer_read;
-            costs[OutputL1BufferWrite] = l1_buffer_write;
-            costs[OutputL1BufferRead] = l1_buffer_read;
-            costs[OutputReuseFactor] = reuse_factor;
-          } else {
-            assert(false);
-          }
-        }
 
-        //Overall reuse factor
-        costs[OverallReuseFactor] = (static_cast<double>(total_l1_read) / static_cast<double>(total_l1_write));
+            tmp = results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, dataclass) * l2_energy_multiplier * (configuration_->bit_width_ / 8.0);
 
-        long double l2_write_energy = 0;
-        long double l2_read_energy = 0;
-        long double l1_write_energy = 0;
-        long double l1_read_energy = 0;
-        long double total_energy = 0;
+            //L2 buffer write energy
+            auto tensor_l2_buffer_write_energy = tmp;
 
-        long double tmp;
-        for(auto tensor : *(configuration_->tensors_->at(tensor_info_idx))) {
-          auto dataclass = tensor->GetDataClass();
+            l2_write_energy += tmp;
 
+            tmp = results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, dataclass)  * l2_energy_multiplier * (configuration_->bit_width_ / 8.0);
 
-          tmp = results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, dataclass) * l2_energy_multiplier * (configuration_->bit_width_ / 8.0);
+            //L2 buffer read energy
+            auto tensor_l2_buffer_read_energy = tmp;
 
-          //L2 buffer write energy
-          auto tensor_l2_buffer_write_energy = tmp;
+            l2_read_energy += tmp;
 
-          l2_write_energy += tmp;
+            // CS TODO: maybe scale L1 energy too?
+            tmp = results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, dataclass) * l1_energy_multiplier;
 
-          tmp = results->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, dataclass)  * l2_energy_multiplier * (configuration_->bit_width_ / 8.0);
+            //L1 buffer write energy
+            auto tensor_l1_buffer_write_energy = tmp;
 
-          //L2 buffer read energy
-          auto tensor_l2_buffer_read_energy = tmp;
+            l1_write_energy += tmp;
 
-          l2_read_energy += tmp;
+            tmp = results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, dataclass) * l1_energy_multiplier;
 
-          // CS TODO: maybe scale L1 energy too?
-          tmp = results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, dataclass) * l1_energy_multiplier;
+            //L1 buffer read energy
+            auto tensor_l1_buffer_read_energy = tmp;
 
-          //L1 buffer write energy
-          auto tensor_l1_buffer_write_energy = tmp;
+            l1_read_energy += tmp;
 
-          l1_write_energy += tmp;
+            if(! per_tensor_energy) {
+              continue;
+            } else if(tensor->GetTensorName() == "input") {
+              costs[InputL2BufferWriteEnergy] = tensor_l2_buffer_write_energy;
+              costs[InputL2BufferReadEnergy] = tensor_l2_buffer_read_energy;
+              costs[InputL1BufferWriteEnergy] = tensor_l1_buffer_write_energy;
+              costs[InputL1BufferReadEnergy] = tensor_l1_buffer_read_energy;
+            } else if(tensor->GetTensorName() == "filter") {
+              costs[FilterL2BufferWriteEnergy] = tensor_l2_buffer_write_energy;
+              costs[FilterL2BufferReadEnergy] = tensor_l2_buffer_read_energy;
+              costs[FilterL1BufferWriteEnergy] = tensor_l1_buffer_write_energy;
+              costs[FilterL1BufferReadEnergy] = tensor_l1_buffer_read_energy;
+            } else if(tensor->GetTensorName() == "output") {
+              costs[OutputL2BufferWriteEnergy] = tensor_l2_buffer_write_energy;
+              costs[OutputL2BufferReadEnergy] = tensor_l2_buffer_read_energy;
+              costs[OutputL1BufferWriteEnergy] = tensor_l1_buffer_write_energy;
+              costs[OutputL1BufferReadEnergy] = tensor_l1_buffer_read_energy;
+            } else {
+              assert(false);
+            }
+          }
 
-          tmp = results->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, dataclass) * l1_energy_multiplier;
+          costs[OverallL2WriteEnergy] =  (l2_write_energy);
+          costs[OverallL2ReadEnergy] = (l2_read_energy);
+          costs[OverallL1WriteEnergy] = (l1_write_energy);
+          costs[OverallL1ReadEnergy] = (l1_read_energy);
 
-          //L1 buffer read energy
-          auto tensor_l1_buffer_read_energy = tmp;
-          
-          l1_read_energy += tmp;
+          double compute_energy = num_computations * (configuration_->bit_width_ / 32.0) * (configuration_->bit_width_ / 32.0);
+          total_energy = l2_write_energy + l2_read_energy + l1_write_energy + l1_read_energy + compute_energy;
+          costs[OverallEnergy] = (total_energy);
+        }
 
-          if(tensor->GetTensorName() == "input") {
-            costs[InputL2BufferWriteEnergy] = tensor_l2_buffer_write_energy;
-            costs[InputL2BufferReadEnergy] = tensor_l2_buffer_read_energy;
-            costs[InputL1BufferWriteEnergy] = tensor_l1_buffer_write_energy;
-            costs[InputL1BufferReadEnergy] = tensor_l1_buffer_read_energy;
-          } else if(tensor->GetTensorName() == "filter") {
-            costs[FilterL2BufferWriteEnergy] = tensor_l2_buffer_write_energy;
-            costs[FilterL2BufferReadEnergy] = tensor_l2_buffer_read_energy;
-            costs[FilterL1BufferWriteEnergy] = tensor_l1_buffer_write_energy;
-            costs[FilterL1BufferReadEnergy] = tensor_l1_buffer_read_energy;
-          } else if(tensor->GetTensorName() == "output") {
-            costs[OutputL2BufferWriteEnergy] = tensor_l2_buffer_write_energy;
-            costs[OutputL2BufferReadEnergy] = tensor_l2_buffer_read_energy;
-            costs[OutputL1BufferWriteEnergy] = tensor_l1_buffer_write_energy;
-            costs[OutputL1BufferReadEnergy] = tensor_l1_buffer_read_energy;
-          } else {
-            assert(false);
-          }
+        if(metrics.test(PeakBWReq)) costs[PeakBWReq] = (results->GetPeakBWReq());
+        if(metrics.test(AvgBWReq)) costs[AvgBWReq] = (results->GetAvgBWReq());
 
+        // None of the delays depend on the tensor
+        if(wants_any(IngressDelayMin, ComputationDelayAvg)) {
           costs[IngressDelayMin] = results->GetDelay(CA::DelayType::Ingress, CA::ValueType::Min);
           costs[IngressDelayMax] = results->GetDelay(CA::DelayType::Ingress, CA::ValueType::Max);
           costs[IngressDelayAvg] = results->GetDelay(CA::DelayType::Ingress, CA::ValueType::Avg);
 
-
           costs[EgressDelayMin] = results->GetDelay(CA::DelayType::Egress, CA::ValueType::Min);
           costs[EgressDelayMax] = results->GetDelay(CA::DelayType::Egress, CA::ValueType::Max);
           costs[EgressDelayAvg] = results->GetDelay(CA::DelayType::Egress, CA::ValueType::Avg);
 
           costs[ComputationDelayMin] = results->GetDelay(CA::DelayType::Computation, CA::ValueType::Min);
           costs[ComputationDelayAvg] = results->GetDelay(CA::DelayType::Computation, CA::ValueType::Avg);
-
         }
 
-
-        costs[OverallL2WriteEnergy] =  (l2_write_energy);
-        costs[OverallL2ReadEnergy] = (l2_read_energy);
-        costs[OverallL1WriteEnergy] = (l1_write_energy);
-        costs[OverallL1ReadEnergy] = (l1_read_energy);
-
-        costs[PeakBWReq] = (results->GetPeakBWReq());
-        costs[AvgBWReq] = (results->GetAvgBWReq());
-
-        double compute_energy = num_computations * (configuration_->bit_width_ / 32.0) * (configuration_->bit_width_ / 32.0);
-        total_energy = l2_write_energy + l2_read_energy + l1_write_energy + l1_read_energy + compute_energy;
-        costs[OverallEnergy] = (total_energy);
-
-        costs[NumUtilizedPEs] = results->GetNumAvgActiveClusters();
+        if(metrics.test(NumUtilizedPEs)) costs[NumUtilizedPEs] = results->GetNumAvgActiveClusters();
       }
 
 
@@ -435,7 +467,68 @@ namespace maestro {
       std::shared_ptr<maestro::DSE::Accelerator> accelerator;
       std::unique_ptr<std::map<LayerType, int>> tensor_info_mapping_table_;
 
+      // Rebinds the hardware parameters of an already analyzed network so it can be re-evaluated
+      // without re-parsing the network or redoing the cluster analysis. NoC models are updated in
+      // place, since cluster units hold on to them. The number of PEs is fixed at construction,
+      // since the cluster analysis of every layer depends on it.
+      // Objects built here outlive the next analysis, so do not call this inside an ArenaScope.
+      void ReconfigureHardware(int simd_width, int bit_width, int l1_size, int l2_size,
+                               int offchip_bw, int noc_bw, int noc_latency) {
+        bool accelerator_changed = simd_width != configuration_->simd_width_ || bit_width != configuration_->bit_width_
+            || l1_size != configuration_->l1_size_ || l2_size != configuration_->l2_size_
+            || noc_bw != configuration_->noc_bw_->at(0);
+
+        for(size_t noc_lv = 0; noc_lv < configuration_->nocs_->size(); noc_lv++) {
+          configuration_->noc_bw_->at(noc_lv) = noc_bw;
+          configuration_->noc_latency_->at(noc_lv) = noc_latency;
+          configuration_->nocs_->at(noc_lv)->SetBandwidth(noc_bw);
+          configuration_->nocs_->at(noc_lv)->SetLatencyPerHops(noc_latency);
+        }
+
+        configuration_->bit_width_ = bit_width;
+        configuration_->simd_width_ = simd_width;
+        configuration_->l1_size_ = l1_size;
+        configuration_->l2_size_ = l2_size;
+        configuration_->offchip_bw_ = offchip_bw;
+
+        if(accelerator_changed) {
+          configuration_->target_accelerator_ = MakeShared<DSE::Accelerator>
+                                                  (configuration_->num_pes_, simd_width, bit_width, noc_bw, l1_size, l2_size);
+        }
+      }
+
+      // Replaces the dataflow of a layer and redoes only its cluster analysis; the network,
+      // tensors, NoCs and accelerator model are kept. The cluster analysis rewrites the dataflow
+      // it is given, so pass a fresh directive table every time. Do not call this inside an
+      // ArenaScope either.
+      void SetLayerDataflow(int layer_id, std::shared_ptr<DFA::DirectiveTable> dataflow) {
+        auto layer = configuration_->network_->at(layer_id);
+        layer->SetDataflow(dataflow);
+        configuration_->cluster_analysis_->at(layer_id) = AnalyzeLayerClusters(layer);
+      }
+
+      // Optional cache of the reuse analysis of every cluster level, kept from one analysis to
+      // the next so that re-evaluating a point that differs in a few tile sizes only redoes
+      // the levels it changed. Owned by this APIV2 alone.
+      void SetReuseAnalysisCache(std::shared_ptr<CA::ReuseAnalysisCache> cache) {
+        reuse_analysis_cache_ = cache;
+      }
+
     private:
+      std::shared_ptr<CA::ReuseAnalysisCache> reuse_analysis_cache_;
+
+      // The accelerator model is kept from one analysis to the next, and only its parts whose
+      // parameters changed are rebuilt. It is built on the heap so that it outlives the
+      // ArenaScope of the analysis.
+      void UpdateAcceleratorModel(int num_pes, int vector_width, int bit_width, int noc_bw, int l1_size, int l2_size) {
+        HeapScope heap;
+        if(accelerator == nullptr) {
+          accelerator = MakeShared<maestro::DSE::Accelerator>(num_pes, vector_width, bit_width, noc_bw, l1_size, l2_size);
+        }
+        else {
+          accelerator->UpdateAccelerator(num_pes, vector_width, bit_width, noc_bw, l1_size, l2_size);
+        }
+      }
 
       void ParseDFSL()
       {
@@ -498,9 +591,9 @@ namespace maestro {
       }
 
       void ConfigConvOverlapDimensions(std::shared_ptr<DFA::DimensionTable> target_dim_table) {
-        std::shared_ptr<std::list<std::shared_ptr<std::pair<std::string, std::string>>>> overlap_dim_list = std::make_shared<std::list<std::shared_ptr<std::pair<std::string, std::string>>>>();
-        auto output_column_overlap = std::make_shared<std::pair<std::string, std::string>>("X", "S");
-        auto output_row_overlap = std::make_shared<std::pair<std::string, std::string>>("Y", "R");
+        std::shared_ptr<std::list<std::shared_ptr<std::pair<std::string, std::string>>>> overlap_dim_list = MakeShared<std::list<std::shared_ptr<std::pair<std::string, std::string>>>>();
+        auto output_column_overlap = MakeShared<std::pair<std::string, std::string>>("X", "S");
+        auto output_row_overlap = MakeShared<std::pair<std::string, std::string>>("Y", "R");
         overlap_dim_list->push_back(output_column_overlap);
         overlap_dim_list->push_back(output_row_overlap);
 
@@ -565,7 +658,7 @@ namespace maestro {
         }
 
 
-        auto conv_tensor_table = std::make_shared<DFA::TensorTable>();
+        auto conv_tensor_table = MakeShared<DFA::TensorTable>();
 
         auto input_tensor = ConstructTensor("input", DFA::TensorClass::InputTensor, DataClass::Input, input_coupled_vars);
         auto filter_tensor = ConstructTensor("filter", DFA::TensorClass::InputTensor, DataClass::Weight, weight_coupled_vars);
@@ -586,9 +679,9 @@ namespace maestro {
           DataClass data_class,
           std::list<std::string> coupled_var_list) {
 
-        auto coupled_var_list_ptr = std::make_shared<std::list<std::string>>(coupled_var_list);
+        auto coupled_var_list_ptr = MakeShared<std::list<std::string>>(coupled_var_list);
 
-        auto ret = std::make_shared<DFA::Tensor>(tensor_name, tensor_class, data_class, coupled_var_list_ptr);
+        auto ret = MakeShared<DFA::Tensor>(tensor_name, tensor_class, data_class, coupled_var_list_ptr);
 
         return ret;
       }
@@ -596,7 +689,7 @@ namespace maestro {
       std::shared_ptr<DFA::DimensionTable> ConstructConvDimensionTable (
           std::shared_ptr<std::vector<std::shared_ptr<DFA::LayerDimension>>> dimensions,
           LayerType layer_type) {
-        auto dimension_table = std::make_shared<DFA::DimensionTable>();
+        auto dimension_table = MakeShared<DFA::DimensionTable>();
 
         switch(layer_type) {
             case (LayerType::CONV) :
@@ -664,26 +757,26 @@ namespace maestro {
               }
 
               if(has_IX && !has_OX) {
-                auto ox_dim = std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_output_width_, IX_size - S_size +1, x_outer_stride, x_inner_stride);
+                auto ox_dim = MakeShared<DFA::LayerDimension>(DFSL::layer_dim_output_width_, IX_size - S_size +1, x_outer_stride, x_inner_stride);
                 dimension_table->AddDimension(ox_dim);
               }
               if(has_IY && !has_OY) {
-                auto oy_dim = std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_output_height_, IY_size - R_size +1, y_outer_stride, y_inner_stride);
+                auto oy_dim = MakeShared<DFA::LayerDimension>(DFSL::layer_dim_output_height_, IY_size - R_size +1, y_outer_stride, y_inner_stride);
                 dimension_table->AddDimension(oy_dim);
               }
               if(!has_IX && has_OX) {
-                auto ix_dim = std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_input_width_, OX_size + S_size -1, x_outer_stride, x_inner_stride);
+                auto ix_dim = MakeShared<DFA::LayerDimension>(DFSL::layer_dim_input_width_, OX_size + S_size -1, x_outer_stride, x_inner_stride);
                 dimension_table->AddDimension(ix_dim);
               }
               if(!has_IY && has_OY) {
-                auto iy_dim = std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_input_height_, OY_size + R_size -1, y_outer_stride, y_inner_stride);
+                auto iy_dim = MakeShared<DFA::LayerDimension>(DFSL::layer_dim_input_height_, OY_size + R_size -1, y_outer_stride, y_inner_stride);
                 dimension_table->AddDimension(iy_dim);
               }
               break;
             }
             case (LayerType::GEMM) : {
               for(auto dim : *dimensions) {
-                auto dimtbl_entry = std::make_shared<DFA::LayerDimension>(dim->GetName(), dim->GetSize(), dim->GetOuterStride(), dim->GetInnerStride());
+                auto dimtbl_entry = MakeShared<DFA::LayerDimension>(dim->GetName(), dim->GetSize(), dim->GetOuterStride(), dim->GetInnerStride());
                 dimension_table->AddDimension(dimtbl_entry);
               }
               break;
@@ -710,7 +803,7 @@ namespace maestro {
         assert(noc_levels == configuration_->noc_multcast_->size());
 
         for(size_t noc_lv = 0; noc_lv < noc_levels; noc_lv++) {
-          auto noc = std::make_shared<maestro::AHW::NetworkOnChipModel>(
+          auto noc = MakeShared<maestro::AHW::NetworkOnChipModel>(
               configuration_->noc_bw_->at(noc_lv),
               1,
               configuration_->noc_latency_->at(noc_lv),
@@ -721,71 +814,71 @@ namespace maestro {
       } // End of function void ConstructNoCs()
 
       void AnalyzeClusters() {
-        int layer_id = -1;
         for(auto layer: *(configuration_->network_)) {
-          layer_id++;
-          auto dataflow = layer->GetDataflow();
-          auto dimensions = layer->GetDimensions();
-          auto layer_type = layer->GetLayerType();
-          int tensor_info_idx = 0;
+          configuration_->cluster_analysis_->push_back(AnalyzeLayerClusters(layer));
+        }
 
-          std::shared_ptr<DFA::DimensionTable> dimension_table = ConstructConvDimensionTable(dimensions, layer_type);
+        message_printer_->PrintMsg(1, "Cluster construction and analysis is done");
+      }
 
-          switch(layer_type) {
-            case (LayerType::CONV) :
-            case (LayerType::DSCONV) :
-            case (LayerType::NGCONV) : {
-              ConfigConvOverlapDimensions(dimension_table);
+      std::shared_ptr<DFA::ClusterAnalysis> AnalyzeLayerClusters(std::shared_ptr<DFA::Layer> layer) {
+        auto dataflow = layer->GetDataflow();
+        auto dimensions = layer->GetDimensions();
+        auto layer_type = layer->GetLayerType();
+        int tensor_info_idx = 0;
 
-              bool has_batch = false;
+        std::shared_ptr<DFA::DimensionTable> dimension_table = ConstructConvDimensionTable(dimensions, layer_type);
 
-              for(auto dim : *dimensions) {
-                if(dim->GetName() == DFSL::layer_dim_input_batch_) {
-                  has_batch = true;
-                  break;
-                }
-              }
+        switch(layer_type) {
+          case (LayerType::CONV) :
+          case (LayerType::DSCONV) :
+          case (LayerType::NGCONV) : {
+            ConfigConvOverlapDimensions(dimension_table);
 
-              if(tensor_info_mapping_table_->find(layer_type) == tensor_info_mapping_table_->end()) {
-                tensor_info_idx = ConfigConvTensors(layer_type, has_batch);
-                (*tensor_info_mapping_table_)[layer_type] = tensor_info_idx;
-              }
-              else {
-                tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
+            bool has_batch = false;
+
+            for(auto dim : *dimensions) {
+              if(dim->GetName() == DFSL::layer_dim_input_batch_) {
+                has_batch = true;
+                break;
               }
-              break;
             }
-            case (LayerType::GEMM): {
-              if(tensor_info_mapping_table_->find(layer_type) == tensor_info_mapping_table_->end()) {
-                tensor_info_idx = ConfigConvTensors(layer_type, false);
-                (*tensor_info_mapping_table_)[layer_type] = tensor_info_idx;
-              }
-              else {
-                tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
-              }
-              break;
+
+            if(tensor_info_mapping_table_->find(layer_type) == tensor_info_mapping_table_->end()) {
+              tensor_info_idx = ConfigConvTensors(layer_type, has_batch);
+              (*tensor_info_mapping_table_)[layer_type] = tensor_info_idx;
             }
-            default: {
-              //TODO: Add generic/custom dimension table construction
-//              dimension_table->AddOverlapDimensions(overlap_dim_list);
-              error_handler_->PrintErrorMsg(TL::ErrorCode::NotSupportedLayerType,"", this->GetName());
+            else {
+              tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
             }
+            break;
           }
+          case (LayerType::GEMM): {
+            if(tensor_info_mapping_table_->find(layer_type) == tensor_info_mapping_table_->end()) {
+              tensor_info_idx = ConfigConvTensors(layer_type, false);
+              (*tensor_info_mapping_table_)[layer_type] = tensor_info_idx;
+            }
+            else {
+              tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
+            }
+            break;
+          }
+          default: {
+            //TODO: Add generic/custom dimension table construction
+//              dimension_table->AddOverlapDimensions(overlap_dim_list);
+            error_handler_->PrintErrorMsg(TL::ErrorCode::NotSupportedLayerType,"", this->GetName());
+          }
+        }
 
-          std::string print_msg_0 = "Layer " + layer->GetName();
-          std::string print_msg_1 = "<Dataflow>\n" + dataflow->ToString();
-
-          message_printer_->PrintMsg(1, print_msg_0);
-          message_printer_->PrintMsg(1, print_msg_1);
-
-          auto cluster_analysis = std::make_shared<DFA::ClusterAnalysis>(
-              layer_type, configuration_->num_pes_, configuration_->tensors_->at(tensor_info_idx),
-              dimension_table, dataflow, configuration_->nocs_);
+        std::string print_msg_0 = "Layer " + layer->GetName();
+        std::string print_msg_1 = "<Dataflow>\n" + dataflow->ToString();
 
-          configuration_->cluster_analysis_->push_back(cluster_analysis);
-        }
+        message_printer_->PrintMsg(1, print_msg_0);
+        message_printer_->PrintMsg(1, print_msg_1);
 
-        message_printer_->PrintMsg(1, "Cluster construction and analysis is done");
+        return MakeShared<DFA::ClusterAnalysis>(
+            layer_type, configuration_->num_pes_, configuration_->tensors_->at(tensor_info_idx),
+            dimension_table, dataflow, configuration_->nocs_);
       }
 
       std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>> AnalyzeCostAllClusters(bool & valid, int layer_id, bool print_results = false, bool write_log_file = false, std::string const & logfile = "") {
@@ -798,6 +891,9 @@ namespace maestro {
 //                               (configuration_->tensors_->at(tensor_info_idx), clusters, configuration_->target_accelerator_->GetVectorWidth());
         auto perf_analysis = std::make_unique<CA::CostAnalysisEngine>
                                (configuration_, configuration_->tensors_->at(tensor_info_idx), clusters);
+        if(reuse_analysis_cache_ != nullptr) {
+          perf_analysis->SetReuseAnalysisCache(reuse_analysis_cache_);
+        }
 
         assert(! write_log_file || logfile != "");
         auto results = perf_analysis->AnalyzeEntireCluster(valid, write_log_file, logfile);
@@ -982,14 +1078,14 @@ namespace maestro {
           // long input_tensor_size = GetTensorSize(layer_id-1, maestro::DataClass::Input, tensor_info_idx);
           // long weight_tensor_size = GetTensorSize(layer_id-1, maestro::DataClass::Weight, tensor_info_idx);
 
-          this->accelerator = std::make_shared<maestro::DSE::Accelerator>(num_pes, vector_width, configuration_->bit_width_, noc_bw, l1_size, l2_size);
+          UpdateAcceleratorModel(num_pes, vector_width, configuration_->bit_width_, noc_bw, l1_size, l2_size);
           area = accelerator->GetArea();
           power = accelerator->GetPower();
 
           // long double ops_per_joule = num_psums / layer_energy * 1000000000; //nJ -> J
 
 
-          auto layer_dp = std::make_shared<maestro::DSE::DesignPoint>(
+          auto layer_dp = MakeShared<maestro::DSE::DesignPoint>(
               maestro::DSE::OptimizationTarget::Runtime, layer_runtime, layer_energy,
               layer_perf_per_energy, area, power, num_pes, noc_bw, vector_width, l2_size, l1_size);
 
@@ -1045,7 +1141,7 @@ namespace maestro {
 
       void OutputResults(std::shared_ptr<std::vector<std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalyisResults>>>>> analysis_result, std::string const & csvfile) {
         // auto csv_writer = std::make_shared<maestro::DSE::CSVWriter>(configuration_, ConstructOutputFileName());
-        auto csv_writer = std::make_shared<maestro::DSE::CSVWriter>(configuration_, csvfile);
+        auto csv_writer = MakeShared<maestro::DSE::CSVWriter>(configuration_, csvfile);
 
         long total_runtime = 0;
 
@@ -1186,14 +1282,14 @@ namespace maestro {
           long input_tensor_size = GetTensorSize(layer_id-1, maestro::DataClass::Input, tensor_info_idx);
           long weight_tensor_size = GetTensorSize(layer_id-1, maestro::DataClass::Weight, tensor_info_idx);
 
-          this->accelerator = std::make_shared<maestro::DSE::Accelerator>(num_pes, vector_width, configuration_->bit_width_, noc_bw, l1_size, l2_size);
+          UpdateAcceleratorModel(num_pes, vector_width, configuration_->bit_width_, noc_bw, l1_size, l2_size);
           area = accelerator->GetArea();
           power = accelerator->GetPower();
 
           long double ops_per_joule = num_psums / layer_energy * 1000000000; //nJ -> J
 
 
-          auto layer_dp = std::make_shared<maestro::DSE::DesignPoint>(
+          auto layer_dp = MakeShared<maestro::DSE::DesignPoint>(
               maestro::DSE::OptimizationTarget::Runtime, layer_runtime, layer_energy,
               layer_perf_per_energy, area, power, num_pes, noc_bw, vector_width, l2_size, l1_size);
 
@@ -19,21 +19,26 @@ SOFTWARE.
 Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 *******************************************************************************/
 
-#include <memory>
-
+#include "BASE_base-objects.hpp"
 #include "TL_error-handler.hpp"
 #include "TL_message-printer.hpp"
 
 namespace maestro {
 
-  //Singleton objects for common functionalities
-	std::shared_ptr<TL::ErrorHandler> error_handler;
-	std::shared_ptr<TL::MessagePrinter> message_printer;
 	int printout_level = 0;
 
-	void InitializeBaseObjects(int print_lv = 0) {
-		error_handler = std::make_shared<TL::ErrorHandler>();
-		message_printer = std::make_shared<TL::MessagePrinter>(print_lv);
+	TL::ErrorHandler& GetErrorHandler() {
+		thread_local TL::ErrorHandler error_handler_instance;
+		return error_handler_instance;
+	}
+
+	TL::MessagePrinter& GetMessagePrinter() {
+		thread_local TL::MessagePrinter message_printer_instance(printout_level);
+		return message_printer_instance;
+	}
+
+	void InitializeBaseObjects(int print_lv) {
+		GetMessagePrinter() = TL::MessagePrinter(print_lv);
 	}
 
 	void SetPrintOutLevel(int new_lv) {
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spotlight-common.hpp"
+
+// Microbenchmarks for the cost-model hot path.
+//
+// Every benchmark cycles over a fixed corpus of ResNet-50, MobileNetV2 and Transformer layers
+// (taken from src/layers.py), each mapped with the same two-level dataflow on a fixed
+// accelerator, so numbers are comparable across builds. Each benchmark warms up, then runs
+// until --min-time seconds have passed, and reports nanoseconds and heap allocations per
+// evaluation. The end-to-end run<false> benchmark is repeated for 1, 2, 4, ... threads (up to
+// --max-threads) and also reports the aggregate evaluations per second; run<false> neighbors
+// evaluates points one directive apart, as local search does, and the batch rows evaluate a
+// shuffled batch as given and in the order runBatch uses.
+//
+// Usage: spotlight-bench [--min-time SECONDS] [--max-threads N] [--filter SUBSTRING]
+
+// Heap allocations made by the calling thread
+static thread_local uint64_t num_allocations = 0;
+
+void * operator new(std::size_t size)
+{
+  ++num_allocations;
+  if(void * ptr = std::malloc(size == 0 ? 1 : size)) { return ptr; }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::size_t) noexcept { std::free(ptr); }
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint64_t num_warmup_evals = 20;
+
+struct Layer
+{
+  char const * name;
+  ShapeT shape;
+};
+
+struct Prepared
+{
+  Layer const * layer;
+  Point point;
+  std::shared_ptr<maestro::APIV2> api;
+  std::shared_ptr<maestro::DFA::TensorTable> tensors;
+  std::shared_ptr<maestro::DFA::ClusterTable> clusters;
+  std::shared_ptr<maestro::DFA::ClusterUnit> top_cluster;
+  std::shared_ptr<maestro::DFA::DimensionTable> dimensions;
+  std::shared_ptr<maestro::DFA::IterationAnalysis> iterations;
+  // One iteration case of every class of the top cluster, as AnalyzeClusterLevel_V2 analyzes them
+  std::vector<std::shared_ptr<maestro::DFA::IterationStatus>> case_classes;
+};
+
+struct Measurement
+{
+  uint64_t num_evals = 0;
+  double seconds = 0;
+  uint64_t num_allocations = 0;
+  uint64_t num_threads = 1;
+};
+
+static volatile long sink;
+
+static ShapeT makeShape(uint64_t n, uint64_t k, uint64_t c, uint64_t y, uint64_t x, uint64_t r, uint64_t s)
+{
+  return ShapeT{
+    {'N', {n, 1}}, {'K', {k, 1}}, {'C', {c, 1}}, {'X', {x, 1}}, {'Y', {y, 1}}, {'R', {r, 1}}, {'S', {s, 1}}
+  };
+}
+
+static std::vector<Layer> const & corpus(void)
+{
+  static std::vector<Layer> const layers{
+    {"resnet50_early", makeShape(1, 64, 3, 224, 224, 7, 7)},
+    {"resnet50_mid", makeShape(1, 128, 64, 56, 56, 1, 1)},
+    {"resnet50_late", makeShape(1, 512, 256, 1, 1, 1, 1)},
+    {"mobilenet_early", makeShape(1, 16, 32, 112, 112, 1, 1)},
+    {"mobilenet_mid", makeShape(1, 192, 192, 14, 14, 1, 1)},
+    {"mobilenet_late", makeShape(1, 1280, 320, 7, 7, 1, 1)},
+    {"transformer_early", makeShape(128, 1536, 1, 512, 1, 1, 512)},
+    {"transformer_mid", makeShape(1, 128, 1, 64, 128, 128, 1)},
+    {"transformer_late", makeShape(128, 512, 1, 2048, 1, 1, 2048)},
+  };
+  return layers;
+}
+
+// Output-stationary two-level mapping: K across clusters of 16 PEs, C across the PEs of a cluster
+static Point makePoint(ShapeT const & shape)
+{
+  auto size = [&](char dim) { return shape.at(dim).first; };
+  auto tile = [&](char dim, uint64_t max_size) { return std::min(size(dim), max_size); };
+
+  Point point;
+  point.num_pes = 256;
+  point.num_simd_lanes = 1;
+  point.l1_size = 512;
+  point.l2_size = 100000;
+  point.bit_width = 8;
+  point.bw = 64;
+  point.latency = 1;
+  point.dataflow = {
+    {'S', tile('K', 16), "K"}, {'T', 1, "N"}, {'T', tile('C', 8), "C"},
+    {'T', tile('Y', size('R') + 7), "Y"}, {'T', tile('X', size('S') + 7), "X"},
+    {'T', size('R'), "R"}, {'T', size('S'), "S"},
+    {'C', 16, "P"},
+    {'S', 1, "C"}, {'T', 1, "N"}, {'T', 1, "K"},
+    {'T', tile('Y', size('R') + 7), "Y"}, {'T', tile('X', size('S') + 7), "X"},
+    {'T', size('R'), "R"}, {'T', size('S'), "S"},
+  };
+  return point;
+}
+
+// Builds everything the component benchmarks start from, outside of any arena
+static std::vector<Prepared> prepareCorpus(void)
+{
+  std::vector<Prepared> prepared;
+  for(auto const & layer : corpus()) {
+    Prepared p;
+    p.layer = &layer;
+    p.point = makePoint(layer.shape);
+    p.api = configure(p.point.num_pes, p.point.num_simd_lanes, p.point.l1_size, p.point.l2_size, p.point.bit_width,
+      p.point.bw, p.point.offchip_bw, p.point.latency, layer.shape, "CONV", p.point.dataflow);
+
+    auto config = p.api->configuration_;
+    p.tensors = config->tensors_->at((*p.api->tensor_info_mapping_table_)[maestro::LayerType::CONV]);
+    p.clusters = config->cluster_analysis_->at(0)->GetClusters();
+    p.top_cluster = p.clusters->GetCluster(0);
+    p.dimensions = p.top_cluster->GetDimensions();
+    p.iterations = std::make_shared<maestro::DFA::IterationAnalysis>(p.dimensions, p.top_cluster);
+
+    maestro::CA::IterationCaseClasses classes(p.iterations, p.top_cluster->GetDataflow());
+    std::vector<bool> is_seen(p.iterations->GetNumIterationCases(), false);
+    std::vector<int> state_indices = p.iterations->GetFirstIterationCase();
+    for(int case_id = 0; case_id < p.iterations->GetNumIterationCases(); ++case_id) {
+      if(case_id > 0) { p.iterations->GetNextIterationCase(case_id - 1, state_indices); }
+      int class_id = classes.GetClassID(state_indices);
+      if(! is_seen[class_id]) { p.case_classes.push_back(p.iterations->GetIterationStatus(state_indices)); }
+      is_seen[class_id] = true;
+    }
+    prepared.push_back(std::move(p));
+  }
+  return prepared;
+}
+
+// Times body(i) for i = 0, 1, 2, ... until min_time has passed; setup(i) runs before each call
+// and is neither timed nor counted
+template<typename Setup, typename Body>
+static Measurement measure(double min_time, Setup && setup, Body && body)
+{
+  for(uint64_t i = 0; i < num_warmup_evals; ++i) {
+    setup(i);
+    body(i);
+  }
+
+  Measurement m;
+  Clock::duration elapsed{0};
+  while(std::chrono::duration<double>(elapsed).count() < min_time) {
+    setup(m.num_evals);
+    uint64_t allocations_before = num_allocations;
+    auto start = Clock::now();
+    body(m.num_evals);
+    elapsed += Clock::now() - start;
+    m.num_allocations += num_allocations - allocations_before;
+    ++m.num_evals;
+  }
+  m.seconds = std::chrono::duration<double>(elapsed).count();
+  return m;
+}
+
+template<typename Body>
+static Measurement measure(double min_time, Body && body)
+{
+  return measure(min_time, [](uint64_t) {}, std::forward<Body>(body));
+}
+
+static void printHeader(void)
+{
+  std::cout << std::left << std::setw(32) << "benchmark" << std::right
+            << std::setw(14) << "ns/eval" << std::setw(14) << "allocs/eval" << std::setw(14) << "evals/sec" << '\n';
+}
+
+// ns/eval is the latency seen by one thread, evals/sec the throughput of all of them
+static void printRow(std::string const & name, Measurement const & m)
+{
+  double ns_per_eval = m.seconds * 1e9 * m.num_threads / m.num_evals;
+  double allocs_per_eval = static_cast<double>(m.num_allocations) / m.num_evals;
+  double evals_per_sec = m.num_evals / m.seconds;
+  std::cout << std::left << std::setw(32) << name << std::right << std::fixed
+            << std::setw(14) << std::setprecision(0) << ns_per_eval
+            << std::setw(14) << std::setprecision(1) << allocs_per_eval
+            << std::setw(14) << std::setprecision(0) << evals_per_sec << '\n';
+}
+
+// Runs run<false> over the corpus on num_threads threads at once
+static Measurement measureRun(double min_time, uint64_t num_threads, std::vector<Prepared> const & prepared)
+{
+  std::vector<Measurement> per_thread(num_threads);
+  std::atomic<uint64_t> num_ready{0};
+  std::atomic<bool> go{false};
+
+  auto work = [&](uint64_t t) {
+    ++num_ready;
+    while(! go.load()) { std::this_thread::yield(); }
+    per_thread[t] = measure(min_time, [&](uint64_t i) {
+      auto const & p = prepared[(i + t) % prepared.size()];
+      run<false>(p.layer->shape, "CONV", p.point, false, false, false, "");
+    });
+  };
+
+  std::vector<std::thread> threads;
+  for(uint64_t t = 1; t < num_threads; ++t) { threads.emplace_back(work, t); }
+  while(num_ready.load() + 1 < num_threads) { std::this_thread::yield(); }
+  go = true;
+  work(0);
+  for(auto & thread : threads) { thread.join(); }
+
+  Measurement total;
+  total.num_threads = num_threads;
+  for(auto const & m : per_thread) {
+    total.num_evals += m.num_evals;
+    total.num_allocations += m.num_allocations;
+    total.seconds = std::max(total.seconds, m.seconds);
+  }
+  return total;
+}
+
+int main(int argc, char ** argv)
+{
+  double min_time = 1.0;
+  uint64_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string filter = "";
+  for(int i = 1; i + 1 < argc; i += 2) {
+    if(std::strcmp(argv[i], "--min-time") == 0) { min_time = std::atof(argv[i + 1]); }
+    else if(std::strcmp(argv[i], "--max-threads") == 0) { max_threads = std::max(1l, std::atol(argv[i + 1])); }
+    else if(std::strcmp(argv[i], "--filter") == 0) { filter = argv[i + 1]; }
+    else {
+      std::cerr << "Unknown option " << argv[i] << '\n';
+      return 1;
+    }
+  }
+  auto enabled = [&](std::string const & name) { return name.find(filter) != std::string::npos; };
+
+  maestro::InitializeBaseObjects(0);
+
+  auto prepared = prepareCorpus();
+  uint64_t num_valid = 0;
+  for(auto const & p : prepared) {
+    num_valid += run<false>(p.layer->shape, "CONV", p.point, false, false, false, "").valid;
+  }
+  std::cout << "Corpus: " << prepared.size() << " layers (" << num_valid << " valid mappings)\n\n";
+  printHeader();
+
+  auto at = [&](uint64_t i) -> Prepared const & { return prepared[i % prepared.size()]; };
+
+  if(enabled("configure")) {
+    printRow("configure", measure(min_time, [&](uint64_t i) {
+      auto const & p = at(i);
+      configure(p.point.num_pes, p.point.num_simd_lanes, p.point.l1_size, p.point.l2_size, p.point.bit_width,
+        p.point.bw, p.point.offchip_bw, p.point.latency, p.layer->shape, "CONV", p.point.dataflow);
+    }));
+  }
+
+  if(enabled("ClusterAnalysis")) {
+    // Cluster analysis rewrites the dataflow it is given, so every evaluation gets a fresh copy
+    std::shared_ptr<maestro::DFA::DirectiveTable> dataflow;
+    printRow("ClusterAnalysis", measure(min_time,
+      [&](uint64_t i) { dataflow = buildDirectiveTable(at(i).point.dataflow); },
+      [&](uint64_t i) {
+        auto const & p = at(i);
+        maestro::DFA::ClusterAnalysis analysis(maestro::LayerType::CONV, p.point.num_pes, p.tensors, p.dimensions,
+          dataflow, p.api->configuration_->nocs_);
+      }));
+  }
+
+  if(enabled("IterationAnalysis")) {
+    printRow("IterationAnalysis", measure(min_time, [&](uint64_t i) {
+      auto const & p = at(i);
+      maestro::ArenaScope arena;
+      maestro::DFA::IterationAnalysis analysis(p.dimensions, p.top_cluster);
+    }));
+  }
+
+  if(enabled("ReuseAnalysis")) {
+    // The queries AnalyzeClusterLevel_V2 makes for every iteration case class of the top cluster
+    printRow("ReuseAnalysis", measure(min_time, [&](uint64_t i) {
+      auto const & p = at(i);
+      maestro::ArenaScope arena;
+      maestro::CA::ReuseAnalysis analysis(p.top_cluster);
+      auto output_tensors = p.tensors->GetTensorsInClass(maestro::DFA::TensorClass::OutputTensor);
+      auto input_tensors = p.tensors->GetTensorsInClass(maestro::DFA::TensorClass::InputTensor);
+      long sum = 0;
+      for(auto & iteration_case : p.case_classes) {
+        for(auto & tensor : *output_tensors) {
+          sum += analysis.GetSpatialEgressTraffic(tensor, iteration_case);
+          sum += analysis.GetOutputTensorSpatialMappingSize(tensor, iteration_case);
+          sum += analysis.GetOutputTensorSpatialMappingSize(tensor, iteration_case, true);
+          sum += analysis.GetNumCriticalPathPartialSums(tensor, iteration_case);
+        }
+        for(auto & tensor : *input_tensors) {
+          sum += analysis.GetSpatialIngressTraffic(tensor, iteration_case);
+          sum += analysis.GetInputTensorSpatialMappingSize(tensor, iteration_case);
+        }
+      }
+      sink = sum;
+    }));
+  }
+
+  if(enabled("AnalyzeClusterLevel_V2")) {
+    printRow("AnalyzeClusterLevel_V2", measure(min_time, [&](uint64_t i) {
+      auto const & p = at(i);
+      maestro::ArenaScope arena;
+      maestro::CA::CostAnalysisEngine engine(p.api->configuration_, p.tensors, p.clusters);
+      bool valid = true;
+      engine.AnalyzeEntireCluster(valid);
+    }));
+  }
+
+  if(enabled("run<false> neighbors")) {
+    // Hill climbing over one layer at a time: every other evaluation is the layer's point, the
+    // ones between change one of its tile sizes or its sub-cluster size
+    static constexpr uint64_t evals_per_layer = 64;
+    printRow("run<false> neighbors", measure(min_time, [&](uint64_t i) {
+      auto const & p = at(i / evals_per_layer);
+      Point point = p.point;
+      if(i % 2 == 1) {
+        auto & directive = point.dataflow[(i / 2) % point.dataflow.size()];
+        std::get<1>(directive) = std::get<0>(directive) == 'C' ? std::get<1>(directive) / 2 : std::get<1>(directive) + 1;
+      }
+      run<false>(p.layer->shape, "CONV", point, false, false, false, "");
+    }));
+  }
+
+  if(enabled("batch")) {
+    // A batch of variants of every layer's point, differing in an outer and two inner tile
+    // sizes, as runBatch gets it and in the order it evaluates it in
+    std::vector<ShapeT> shapes;
+    std::vector<Point> points;
+    for(auto const & p : prepared) {
+      for(uint64_t variant = 0; variant < 16; ++variant) {
+        Point point = p.point;
+        auto & outer = std::get<1>(point.dataflow[2]);
+        outer = variant % 2 == 0 ? outer : std::max<uint64_t>(outer / 2, 1);
+        std::get<1>(point.dataflow[11]) += variant / 2 % 4;
+        std::get<1>(point.dataflow[12]) += variant / 8;
+        shapes.push_back(p.layer->shape);
+        points.push_back(point);
+      }
+    }
+    std::vector<uint64_t> shuffled(points.size());
+    std::iota(shuffled.begin(), shuffled.end(), 0);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(0));
+    std::vector<Point> shuffled_points;
+    std::vector<ShapeT> shuffled_shapes;
+    for(uint64_t i : shuffled) {
+      shuffled_points.push_back(points[i]);
+      shuffled_shapes.push_back(shapes[i]);
+    }
+    std::vector<uint64_t> order = evaluationOrder(shuffled_points.size(),
+      [&](uint64_t i) -> ShapeT const & { return shuffled_shapes[i]; }, "CONV", shuffled_points);
+
+    printRow("batch as given", measure(min_time, [&](uint64_t i) {
+      uint64_t j = i % shuffled_points.size();
+      run<false>(shuffled_shapes[j], "CONV", shuffled_points[j], false, false, false, "");
+    }));
+    printRow("batch in evaluation order", measure(min_time, [&](uint64_t i) {
+      uint64_t j = order[i % order.size()];
+      run<false>(shuffled_shapes[j], "CONV", shuffled_points[j], false, false, false, "");
+    }));
+  }
+
+  if(enabled("run<false> x")) {
+    for(uint64_t num_threads = 1; ; num_threads = std::min(num_threads * 2, max_threads)) {
+      printRow("run<false> x" + std::to_string(num_threads) + " threads",
+        measureRun(min_time, num_threads, prepared));
+      if(num_threads == max_threads) { break; }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,189 @@
+#ifndef _SPOTLIGHT_CACHE_HPP
+#define _SPOTLIGHT_CACHE_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Hash128
+{
+  uint64_t lo = 0;
+  uint64_t hi = 0;
+
+  bool operator==(Hash128 const & other) const { return lo == other.lo && hi == other.hi; }
+};
+
+// Incremental 128-bit hash built from two independently seeded 64-bit lanes.
+class Hasher128
+{
+public:
+  Hasher128 & add(uint64_t value)
+  {
+    lo_ = mix(lo_ ^ value) * 0x9e3779b97f4a7c15ull;
+    hi_ = mix(hi_ + value * 0xc2b2ae3d27d4eb4full) ^ (hi_ >> 29);
+    return *this;
+  }
+
+  Hasher128 & add(std::string const & value)
+  {
+    add(value.size());
+    for(unsigned char c : value) { add(c); }
+    return *this;
+  }
+
+  Hash128 get(void) const { return Hash128{mix(lo_ ^ hi_), mix(hi_ + lo_)}; }
+
+private:
+  static uint64_t mix(uint64_t x)
+  {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+  }
+
+  uint64_t lo_ = 0x243f6a8885a308d3ull;
+  uint64_t hi_ = 0x13198a2e03707344ull;
+};
+
+// Bounded cache of evaluation results keyed by a 128-bit hash of the design point.
+//
+// Entries are spread over a fixed number of shards, each guarded by its own mutex, so
+// concurrent evaluations rarely contend. Each shard evicts with the CLOCK algorithm: a hit
+// sets the entry's reference bit, and the clock hand clears bits until it finds an
+// unreferenced victim. The capacity comes from SPOTLIGHT_CACHE_SIZE (entries); 0 disables
+// the cache.
+template<typename ValueT>
+class ResultCache
+{
+public:
+  static constexpr uint64_t num_shards = 16;
+  static constexpr uint64_t default_capacity = 1 << 16;
+
+  struct Stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t size = 0;
+    uint64_t capacity = 0;
+  };
+
+  ResultCache(void) : ResultCache(defaultCapacity()) {}
+
+  explicit ResultCache(uint64_t capacity)
+  {
+    for(auto & shard : shards_) {
+      shard.capacity = (capacity + num_shards - 1) / num_shards;
+    }
+  }
+
+  bool enabled(void) const { return shards_[0].capacity != 0; }
+
+  bool lookup(Hash128 const & key, ValueT & value)
+  {
+    Shard & shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if(it == shard.index.end()) {
+      ++shard.misses;
+      return false;
+    }
+    ++shard.hits;
+    Slot & slot = shard.slots[it->second];
+    slot.referenced = true;
+    value = slot.value;
+    return true;
+  }
+
+  void insert(Hash128 const & key, ValueT const & value)
+  {
+    Shard & shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if(shard.capacity == 0 || shard.index.count(key) != 0) { return; }
+
+    uint64_t idx;
+    if(shard.slots.size() < shard.capacity) {
+      idx = shard.slots.size();
+      shard.slots.push_back(Slot{key, value, false});
+    } else {
+      while(shard.slots[shard.hand].referenced) {
+        shard.slots[shard.hand].referenced = false;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+      }
+      idx = shard.hand;
+      shard.hand = (shard.hand + 1) % shard.slots.size();
+      shard.index.erase(shard.slots[idx].key);
+      shard.slots[idx] = Slot{key, value, false};
+    }
+    shard.index.emplace(key, idx);
+  }
+
+  Stats stats(void)
+  {
+    Stats ret;
+    for(auto & shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      ret.hits += shard.hits;
+      ret.misses += shard.misses;
+      ret.size += shard.slots.size();
+      ret.capacity += shard.capacity;
+    }
+    return ret;
+  }
+
+  void clear(void)
+  {
+    for(auto & shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.index.clear();
+      shard.slots.clear();
+      shard.hand = 0;
+      shard.hits = 0;
+      shard.misses = 0;
+    }
+  }
+
+private:
+  struct KeyHash
+  {
+    size_t operator()(Hash128 const & key) const { return key.hi; }
+  };
+
+  struct Slot
+  {
+    Hash128 key;
+    ValueT value;
+    bool referenced;
+  };
+
+  struct alignas(64) Shard
+  {
+    std::mutex mutex;
+    std::unordered_map<Hash128, uint64_t, KeyHash> index;
+    std::vector<Slot> slots;
+    uint64_t hand = 0;
+    uint64_t capacity = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  static uint64_t defaultCapacity(void)
+  {
+    if(char const * env = std::getenv("SPOTLIGHT_CACHE_SIZE")) {
+      return std::strtoull(env, nullptr, 10);
+    }
+    return default_capacity;
+  }
+
+  Shard & shardOf(Hash128 const & key) { return shards_[key.lo % num_shards]; }
+
+  std::array<Shard, num_shards> shards_;
+};
+
+#endif
@@ -1,6 +1,6 @@
 #include "spotlight-common.hpp"
 
-std::string MetricTypeToString(maestro::MetricType const & t)
+char const * MetricTypeName(maestro::MetricType const & t)
 {
   using namespace maestro;
 
@@ -70,10 +70,47 @@ std::string MetricTypeToString(maestro::MetricType const & t)
   };
 
   auto it = convert.find(t);
-  return it == convert.end() ? "Invalid" : std::string(it->second);
+  return it == convert.end() ? "Invalid" : it->second;
+}
+
+std::string MetricTypeToString(maestro::MetricType const & t)
+{
+  return std::string(MetricTypeName(t));
 }
 
 
+static void hashLayer(Hasher128 & hasher, ShapeT const & shape, std::string const & layer_type)
+{
+  // ShapeT is unordered, so visit dimensions in a fixed order
+  for(char dim : {'N', 'K', 'C', 'X', 'Y', 'R', 'S'}) {
+    auto it = shape.find(dim);
+    if(it == shape.end()) {
+      hasher.add(uint64_t{0});
+    } else {
+      hasher.add(dim).add(it->second.first).add(it->second.second);
+    }
+  }
+  hasher.add(layer_type);
+}
+
+static void hashDataflow(Hasher128 & hasher, DataflowT const & dataflow)
+{
+  hasher.add(dataflow.size());
+  for(auto const & directive : dataflow) {
+    hasher.add(std::get<0>(directive)).add(std::get<1>(directive)).add(std::get<2>(directive));
+  }
+}
+
+Hash128 hashDesignPoint(ShapeT const & shape, std::string const & layer_type, Point const & point)
+{
+  Hasher128 hasher;
+  hashLayer(hasher, shape, layer_type);
+  hasher.add(point.num_pes).add(point.num_simd_lanes).add(point.l1_size).add(point.l2_size);
+  hasher.add(point.bit_width).add(point.bw).add(point.offchip_bw).add(point.latency);
+  hashDataflow(hasher, point.dataflow);
+  return hasher.get();
+}
+
 std::ostream & operator<<(std::ostream & out, Point const & point)
 {
 #ifdef _DEBUG_OUT
@@ -103,9 +140,9 @@ std::ostream & operator<<(std::ostream & out, Point const & point)
 
 std::shared_ptr<maestro::ConfigurationV2> setupConfig(uint64_t num_pe, uint64_t num_simd_lanes, uint64_t l1_size, uint64_t l2_size, uint64_t bit_width, uint64_t bw, uint64_t offchip_bw, uint64_t hops)
 {
-  auto noc_multcast = std::make_shared<std::vector<bool>>();
-  auto noc_latency = std::make_shared<std::vector<int>>();
-  auto noc_bw = std::make_shared<std::vector<int>>();
+  auto noc_multcast = maestro::MakeShared<std::vector<bool>>();
+  auto noc_latency = maestro::MakeShared<std::vector<int>>();
+  auto noc_bw = maestro::MakeShared<std::vector<int>>();
   noc_bw->push_back(bw);
   noc_bw->push_back(bw);
   noc_bw->push_back(bw);
@@ -119,49 +156,58 @@ std::shared_ptr<maestro::ConfigurationV2> setupConfig(uint64_t num_pe, uint64_t
   noc_multcast->push_back(true);
   noc_multcast->push_back(true);
 
-  auto config = std::make_shared<maestro::ConfigurationV2>("", "", bit_width, noc_bw, noc_latency, noc_multcast, num_pe, num_simd_lanes, bw, l1_size, l2_size, offchip_bw);
+  auto config = maestro::MakeShared<maestro::ConfigurationV2>("", "", bit_width, noc_bw, noc_latency, noc_multcast, num_pe, num_simd_lanes, bw, l1_size, l2_size, offchip_bw);
 
   return config;
 }
 
-void setupDFSL(std::shared_ptr<maestro::ConfigurationV2> config, ShapeT const & shape, std::string const & layer_type, DataflowT const & dataflow)
+std::shared_ptr<maestro::DFA::DirectiveTable> buildDirectiveTable(DataflowT const & dataflow)
 {
   using namespace maestro;
 
-  auto dim_vector = std::make_shared<std::vector<std::shared_ptr<DFA::LayerDimension>>>();
-
-  for(auto const & elem : shape) {
-    std::string dim(1, elem.first);
-    dim_vector->push_back(std::make_shared<DFA::LayerDimension>(dim, elem.second.first, elem.second.second, 1));
-  }
-
-  auto directive_table = std::make_shared<DFA::DirectiveTable>();
+  auto directive_table = MakeShared<DFA::DirectiveTable>();
   for(auto const & elem : dataflow) {
     char type = std::get<0>(elem);
     uint64_t extent = std::get<1>(elem);
     std::string const & var = std::get<2>(elem);
 
     if (type == 'S') {
-      directive_table->AddDirective(std::make_shared<DFA::directive::SpatialMap>(extent, extent, var));
+      directive_table->AddDirective(MakeShared<DFA::directive::SpatialMap>(extent, extent, var));
     } else if (type == 'T') {
       if (var == "X" || var == "Y") {
         directive_table->AddDirective(
-            std::make_shared<DFA::directive::TemporalMap>(extent, 1, var));
+            MakeShared<DFA::directive::TemporalMap>(extent, 1, var));
       } else {
         directive_table->AddDirective(
-            std::make_shared<DFA::directive::TemporalMap>(extent, extent, var));
+            MakeShared<DFA::directive::TemporalMap>(extent, extent, var));
       }
     } else if (type == 'C') {
       if (var == "P") {
-        directive_table->AddDirective(std::make_shared<DFA::directive::Cluster>(extent, DFA::directive::ClusterType::Physical));
+        directive_table->AddDirective(MakeShared<DFA::directive::Cluster>(extent, DFA::directive::ClusterType::Physical));
       } else if (var == "L") {
-        directive_table->AddDirective(std::make_shared<DFA::directive::Cluster>(extent, DFA::directive::ClusterType::Logical));
+        directive_table->AddDirective(MakeShared<DFA::directive::Cluster>(extent, DFA::directive::ClusterType::Logical));
       }
     }
   }
 
+  return directive_table;
+}
+
+void setupDFSL(std::shared_ptr<maestro::ConfigurationV2> config, ShapeT const & shape, std::string const & layer_type, DataflowT const & dataflow)
+{
+  using namespace maestro;
+
+  auto dim_vector = MakeShared<std::vector<std::shared_ptr<DFA::LayerDimension>>>();
+
+  for(auto const & elem : shape) {
+    std::string dim(1, elem.first);
+    dim_vector->push_back(MakeShared<DFA::LayerDimension>(dim, elem.second.first, elem.second.second, 1));
+  }
+
+  auto directive_table = buildDirectiveTable(dataflow);
+
   if(layer_type == "CONV") {
-    auto curr_layer = std::make_shared<DFA::ConvLayer>("Conv");
+    auto curr_layer = MakeShared<DFA::ConvLayer>("Conv");
     curr_layer->SetDimensions(dim_vector);
     curr_layer->SetDataflow(directive_table);
     curr_layer->SetLayerType(LayerType::CONV);
@@ -174,7 +220,7 @@ void setupDFSL(std::shared_ptr<maestro::ConfigurationV2> config, ShapeT const &
     std::cout << "=== MAESTRO Setup End\n\n";
 #endif
   } else if(layer_type == "DSCONV") {
-    auto curr_layer = std::make_shared<DFA::DSConvLayer>("DSConv");
+    auto curr_layer = MakeShared<DFA::DSConvLayer>("DSConv");
     curr_layer->SetDimensions(dim_vector);
     curr_layer->SetDataflow(directive_table);
     curr_layer->SetLayerType(LayerType::DSCONV);
@@ -196,7 +242,78 @@ std::shared_ptr<maestro::APIV2> configure(uint64_t num_pe, uint64_t num_simd_lan
   auto config = setupConfig(num_pe, num_simd_lanes, l1_size, l2_size, bit_width, bw, offchip_bw, hops);
   setupDFSL(config, shape, layer_type, dataflow);
 
-  std::shared_ptr<maestro::APIV2> api = std::make_shared<maestro::APIV2>(config, false);
+  std::shared_ptr<maestro::APIV2> api = maestro::MakeShared<maestro::APIV2>(config, false);
 
   return api;
 }
+
+DataflowPlan::DataflowPlan(ShapeT const & shape, std::string const & layer_type, Point const & point)
+{
+  api_ = configure(point.num_pes, point.num_simd_lanes, point.l1_size, point.l2_size, point.bit_width, point.bw, point.offchip_bw, point.latency, shape, layer_type, point.dataflow);
+  api_->SetReuseAnalysisCache(std::make_shared<maestro::CA::ReuseAnalysisCache>());
+  for(auto const & directive : point.dataflow) {
+    sizes_.push_back(std::get<1>(directive));
+  }
+}
+
+Hash128 DataflowPlan::key(ShapeT const & shape, std::string const & layer_type, Point const & point)
+{
+  Hasher128 hasher;
+  hashLayer(hasher, shape, layer_type);
+  hasher.add(point.num_pes);
+  hasher.add(point.dataflow.size());
+  for(auto const & directive : point.dataflow) {
+    hasher.add(std::get<0>(directive)).add(std::get<2>(directive));
+  }
+  return hasher.get();
+}
+
+void DataflowPlan::bind(Point const & point)
+{
+  bool sizes_changed = false;
+  for(uint64_t i = 0; i < sizes_.size(); ++i) {
+    if(sizes_[i] != std::get<1>(point.dataflow[i])) {
+      sizes_[i] = std::get<1>(point.dataflow[i]);
+      sizes_changed = true;
+    }
+  }
+  if(sizes_changed) {
+    api_->SetLayerDataflow(0, buildDirectiveTable(point.dataflow));
+  }
+
+  api_->ReconfigureHardware(point.num_simd_lanes, point.bit_width, point.l1_size, point.l2_size, point.offchip_bw, point.bw, point.latency);
+}
+
+struct PreparedPlan
+{
+  Hash128 key;
+  std::unique_ptr<DataflowPlan> plan;
+};
+
+static constexpr uint64_t num_prepared_plans = 4;
+static thread_local std::array<PreparedPlan, num_prepared_plans> prepared_plans;
+static thread_local uint64_t prepared_plans_hand = 0;
+
+std::unique_ptr<DataflowPlan> acquirePlan(Hash128 const & key, ShapeT const & shape, std::string const & layer_type, Point const & point)
+{
+  for(auto & prepared : prepared_plans) {
+    if(prepared.plan != nullptr && prepared.key == key) {
+      return std::move(prepared.plan);
+    }
+  }
+
+  return std::make_unique<DataflowPlan>(shape, layer_type, point);
+}
+
+void releasePlan(Hash128 const & key, std::unique_ptr<DataflowPlan> plan)
+{
+  for(auto & prepared : prepared_plans) {
+    if(prepared.plan == nullptr) {
+      prepared = PreparedPlan{key, std::move(plan)};
+      return;
+    }
+  }
+
+  prepared_plans[prepared_plans_hand] = PreparedPlan{key, std::move(plan)};
+  prepared_plans_hand = (prepared_plans_hand + 1) % num_prepared_plans;
+}
@@ -1,21 +1,25 @@
 #ifndef _SPOTLIGHT_COMMON_HPP
 #define _SPOTLIGHT_COMMON_HPP
 
-#include <future>
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <string>
-#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 
-#include "ctpl_stl.h"
+#include "spotlight-cache.hpp"
+#include "spotlight-executor.hpp"
 
 #include "AHW_noc-model.hpp"
 #include "API_configuration.hpp"
 #include "API_user-interface-v2.hpp"
 #include "BASE_base-objects.hpp"
 #include "BASE_constants.hpp"
+#include "BASE_memory-arena.hpp"
 #include "CA_cost-analysis-results.hpp"
 #include "DFA_tensor.hpp"
 #include "DSE_cost-database.hpp"
@@ -51,19 +55,25 @@ struct CostSmall
   double area;
   double power;
   double throughput;
+  // Lower bound on the delay of any order of the inner cluster levels
+  double min_delay = 0;
   bool valid = false;
 
   double getFitness(void) const { return delay * energy; }
 };
 
+// Every MAESTRO metric indexed by maestro::MetricType; metrics that were not computed are NaN
+static constexpr uint64_t num_metrics = maestro::MetricEnd;
+using MetricsT = std::array<long double, num_metrics>;
+
 struct CostFull
 {
-  std::map<maestro::MetricType, long double> costs;
+  MetricsT costs;
   bool valid = false;
 
   double getFitness(void) const
   {
-    if(valid) { return costs.at(maestro::ExactRunTime) * costs.at(maestro::OverallEnergy); }
+    if(valid) { return costs[maestro::ExactRunTime] * costs[maestro::OverallEnergy]; }
     else { return 0; }
   }
 };
@@ -118,8 +128,12 @@ std::ostream & printCost(std::ostream & out, Cost<DumpFull> const & cost)
 }
 
 
+char const * MetricTypeName(maestro::MetricType const & t);
 std::string MetricTypeToString(maestro::MetricType const & t);
 
+// MAESTRO directive table for a dataflow; spatial and temporal maps of X and Y slide by one
+std::shared_ptr<maestro::DFA::DirectiveTable> buildDirectiveTable(DataflowT const & dataflow);
+
 std::shared_ptr<maestro::APIV2> configure(
   uint64_t num_pe,
   uint64_t num_simd_lanes,
@@ -134,6 +148,117 @@ std::shared_ptr<maestro::APIV2> configure(
   DataflowT const & dataflow
 );
 
+template<bool DumpAll>
+Cost<DumpAll> analyze(maestro::APIV2 & api,
+  bool print_results_to_screen,
+  bool print_results_to_file,
+  bool print_log_to_file,
+  std::string const & logfile
+)
+{
+  bool valid = true;
+  auto res = api.AnalyzeNeuralNetwork(valid, print_results_to_screen, print_results_to_file, print_log_to_file, logfile);
+
+  if(res == nullptr || res->size() == 0 || ! valid) { return Cost<DumpAll>{}; }
+  auto layer_res = (*res)[0];
+  if(layer_res == nullptr || layer_res->size() == 0) { return Cost<DumpAll>{}; }
+  auto cluster_res = (*layer_res)[layer_res->size() - 1];
+
+  MetricsT costs;
+  costs.fill(std::numeric_limits<long double>::quiet_NaN());
+  maestro::MetricMask metrics;
+  if constexpr (DumpAll) {
+    metrics.set();
+  } else {
+    // Area and power come from the accelerator model
+    metrics.set(maestro::ExactRunTime).set(maestro::OverallEnergy).set(maestro::Throughput);
+  }
+  api.GetCostsFromAnalysisResultsSingleCluster(cluster_res, costs, metrics);
+
+  Cost<DumpAll> cost;
+  if(api.accelerator) {
+    cost.valid = true;
+    if constexpr (DumpAll) {
+      cost.costs = costs;
+      cost.costs[maestro::Area] = api.accelerator->GetArea();
+    } else {
+      cost.delay = costs[maestro::ExactRunTime];
+      cost.energy = costs[maestro::OverallEnergy];
+      cost.area = api.accelerator->GetArea();
+      cost.power = api.accelerator->GetPower();
+      cost.throughput = costs[maestro::Throughput];
+      cost.min_delay = cluster_res->GetMinRuntime();
+    }
+  }
+  // std::cout << costs[maestro::NumUtilizedPEs] << " utilized PEs\n";
+  // std::cout << costs[maestro::Throughput] << " MACs/cycle\n";
+  // std::cout << costs[maestro::ExactRunTime] << " cycles\n";
+  // std::cout << costs[maestro::OverallEnergy] << " x MAC energy\n";
+  // if (api.accelerator) {
+  //   std::cout << api.accelerator->GetArea() << " um^2\n";
+  //   std::cout << api.accelerator->GetPower() << " mW\n";
+  // }
+
+  return cost;
+}
+
+// A MAESTRO instance prepared for one layer, number of PEs and loop-order template, i.e. the
+// kind and dimension of every directive and the position of the cluster boundaries. Evaluating
+// a point with the same template only redoes what the point changes: new tile or cluster sizes
+// rebuild the directive table and the layer's cluster analysis, and new hardware parameters are
+// rebound in place. The network, tensors, NoCs and accelerator setup are built once per plan.
+// The analysis keeps the reuse analysis of every cluster level and the accelerator model of the
+// last point, so a neighbor of it, e.g. with one tile size changed, only re-analyzes the levels
+// whose dimensions changed and rebuilds the parts of the model whose buffer sizes changed.
+class DataflowPlan
+{
+public:
+  // Must not be called inside an ArenaScope
+  DataflowPlan(ShapeT const & shape, std::string const & layer_type, Point const & point);
+
+  // Points with equal keys share a loop-order template and can be evaluated by the same plan
+  static Hash128 key(ShapeT const & shape, std::string const & layer_type, Point const & point);
+
+  // Evaluates the plan for the sizes in point's dataflow and point's hardware parameters. Must
+  // not be called inside an ArenaScope; the analysis runs in one of its own.
+  template<bool DumpAll>
+  Cost<DumpAll> evaluate(Point const & point,
+    bool print_results_to_screen,
+    bool print_results_to_file,
+    bool print_log_to_file,
+    std::string const & logfile
+  );
+
+private:
+  void bind(Point const & point);
+
+  std::shared_ptr<maestro::APIV2> api_;
+  std::vector<uint64_t> sizes_;
+};
+
+template<bool DumpAll>
+Cost<DumpAll> DataflowPlan::evaluate(Point const & point,
+  bool print_results_to_screen,
+  bool print_results_to_file,
+  bool print_log_to_file,
+  std::string const & logfile
+)
+{
+  bind(point);
+
+  // Every MAESTRO object built by the analysis is allocated from this thread's arena and
+  // released in one shot when the scope ends, except for what api_ keeps for the next point
+  // (the accelerator model and the reuse analysis of each cluster level), which is built on
+  // the heap.
+  maestro::ArenaScope arena;
+  return analyze<DumpAll>(*api_, print_results_to_screen, print_results_to_file, print_log_to_file, logfile);
+}
+
+// Each thread keeps a few plans. acquirePlan takes out the one for key, or builds a new one, and
+// releasePlan hands it back once an evaluation succeeded.
+std::unique_ptr<DataflowPlan> acquirePlan(Hash128 const & key, ShapeT const & shape, std::string const & layer_type, Point const & point);
+void releasePlan(Hash128 const & key, std::unique_ptr<DataflowPlan> plan);
+
 template<bool DumpAll>
 Cost<DumpAll> run(ShapeT const & shape,
   std::string const & layer_type,
@@ -144,46 +269,30 @@ Cost<DumpAll> run(ShapeT const & shape,
   std::string logfile
 )
 {
+  Hash128 key = DataflowPlan::key(shape, layer_type, point);
+  std::unique_ptr<DataflowPlan> plan;
+  Cost<DumpAll> cost;
   try {
-    bool valid = true;
-    auto api = configure(point.num_pes, point.num_simd_lanes, point.l1_size, point.l2_size, point.bit_width, point.bw, point.offchip_bw, point.latency, shape, layer_type, point.dataflow);
-    auto res = api->AnalyzeNeuralNetwork(valid, print_results_to_screen, print_results_to_file, print_log_to_file, logfile);
-
-    if(res == nullptr || res->size() == 0 || ! valid) { return Cost<DumpAll>{}; }
-    auto layer_res = (*res)[0];
-    if(layer_res == nullptr || layer_res->size() == 0) { return Cost<DumpAll>{}; }
-    auto cluster_res = (*layer_res)[layer_res->size() - 1];
-
-    std::map<maestro::MetricType, long double> costs;
-    api->GetCostsFromAnalysisResultsSingleCluster(cluster_res, costs);
-
-    Cost<DumpAll> cost;
-    if(api->accelerator) {
-      cost.valid = true;
-      if constexpr (DumpAll) {
-        cost.costs = costs;
-        cost.costs[maestro::Area] = api->accelerator->GetArea();
-      } else {
-        cost.delay = costs[maestro::ExactRunTime];
-        cost.energy = costs[maestro::OverallEnergy];
-        cost.area = api->accelerator->GetArea();
-        cost.power = api->accelerator->GetPower();
-        cost.throughput = costs[maestro::Throughput];
-      }
-    }
-    // std::cout << costs[maestro::NumUtilizedPEs] << " utilized PEs\n";
-    // std::cout << costs[maestro::Throughput] << " MACs/cycle\n";
-    // std::cout << costs[maestro::ExactRunTime] << " cycles\n";
-    // std::cout << costs[maestro::OverallEnergy] << " x MAC energy\n";
-    // if (api->accelerator) {
-    //   std::cout << api->accelerator->GetArea() << " um^2\n";
-    //   std::cout << api->accelerator->GetPower() << " mW\n";
-    // }
-
-    return cost;
+    plan = acquirePlan(key, shape, layer_type, point);
+    cost = plan->evaluate<DumpAll>(point, print_results_to_screen, print_results_to_file, print_log_to_file, logfile);
   } catch(std::exception const & e) {
+    // A plan that threw may be half-updated, so it is not reused
     return Cost<DumpAll>{};
   }
+
+  releasePlan(key, std::move(plan));
+  return cost;
+}
+
+// Hash of the normalized design point (shape, layer type and every field of the point)
+Hash128 hashDesignPoint(ShapeT const & shape, std::string const & layer_type, Point const & point);
+
+// Process-wide cache of results, shared by every entry point that goes through runWrapper
+template<bool DumpAll>
+ResultCache<Cost<DumpAll>> & resultCache(void)
+{
+  static ResultCache<Cost<DumpAll>> cache;
+  return cache;
 }
 
 template<bool DumpAll>
@@ -194,13 +303,63 @@ Cost<DumpAll> runWrapper(int id, ShapeT const & shape, std::string const & layer
 #ifdef _DEBUG_OUT
   output_logs = true;
 #endif
-  return run<DumpAll>(shape, layer_type, point, output_logs, output_logs && logfile != "", output_logs && logfile != "", logfile);
+  auto & cache = resultCache<DumpAll>();
+  if(output_logs || ! cache.enabled()) {
+    return run<DumpAll>(shape, layer_type, point, output_logs, output_logs && logfile != "", output_logs && logfile != "", logfile);
+  }
+
+  Hash128 key = hashDesignPoint(shape, layer_type, point);
+  Cost<DumpAll> cost;
+  if(cache.lookup(key, cost)) { return cost; }
+
+  cost = run<DumpAll>(shape, layer_type, point, false, false, false, logfile);
+  cache.insert(key, cost);
+  return cost;
 }
 
-template<bool DumpAll>
-void runBatch(
+// Whether dataflow a comes before dataflow b, which has as many directives, when comparing the
+// sizes of their directives from the outermost one in
+inline bool sizesBefore(DataflowT const & a, DataflowT const & b)
+{
+  for(uint64_t d = 0; d < a.size(); ++d) {
+    if(std::get<1>(a[d]) != std::get<1>(b[d])) { return std::get<1>(a[d]) < std::get<1>(b[d]); }
+  }
+  return false;
+}
+
+// Order in which runBatch evaluates a batch: by DataflowPlan, i.e. by layer and loop-order
+// template, then by hardware parameters, then by directive sizes from the outermost directive
+// in. Consecutive points of a thread thus share a plan, and mostly differ in the sizes of their
+// inner cluster levels, which are the only ones that the plan re-analyzes.
+template<typename ShapeOf>
+std::vector<uint64_t> evaluationOrder(
   uint64_t batch_size,
-  ShapeT const & shape,
+  ShapeOf const & shape_of,
+  std::string const & layer_type,
+  std::vector<Point> const & points
+)
+{
+  std::vector<Hash128> keys(batch_size);
+  for(uint64_t i = 0; i < batch_size; ++i) { keys[i] = DataflowPlan::key(shape_of(i), layer_type, points[i]); }
+
+  auto hardware = [](Point const & point) {
+    return std::tie(point.num_simd_lanes, point.bit_width, point.bw, point.latency, point.offchip_bw, point.l1_size, point.l2_size);
+  };
+
+  std::vector<uint64_t> order(batch_size);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) {
+    if(! (keys[a] == keys[b])) { return std::tie(keys[a].hi, keys[a].lo) < std::tie(keys[b].hi, keys[b].lo); }
+    if(hardware(points[a]) != hardware(points[b])) { return hardware(points[a]) < hardware(points[b]); }
+    return sizesBefore(points[a].dataflow, points[b].dataflow);
+  });
+  return order;
+}
+
+template<bool DumpAll, typename ShapeOf>
+void runBatchImpl(
+  uint64_t batch_size,
+  ShapeOf const & shape_of,
   std::string const & layer_type,
   std::vector<Point> const & points,
   std::vector<Cost<DumpAll>> & costs,
@@ -210,19 +369,18 @@ void runBatch(
   std::string const & logfile
 )
 {
-  assert(shape.size() != batch_size || points.size() != batch_size);
+  assert(points.size() >= batch_size && costs.size() >= batch_size);
 
-#ifdef MULTICORE
-  ctpl::thread_pool pool(std::min<uint64_t>(batch_size, std::thread::hardware_concurrency()));
-  std::vector<std::future<Cost<DumpAll>>> results(batch_size);
+  // Every thread works through a contiguous range of the order
+  std::vector<uint64_t> order = evaluationOrder(batch_size, shape_of, layer_type, points);
 
-  for(uint64_t i = 0; i < batch_size; ++i) {
-    Point const & point = points[i];
-    results[i] = pool.push(runWrapper<DumpAll>, shape, layer_type, point, logfile);
-  }
+#ifdef MULTICORE
+  Executor::instance().parallelFor(batch_size, [&](uint64_t i) {
+    uint64_t j = order[i];
+    costs[j] = runWrapper<DumpAll>(0, shape_of(j), layer_type, points[j], logfile);
+  });
 
   for(uint64_t i = 0; i < batch_size; ++i) {
-    costs[i] = results[i].get();
     if(result_file.is_open()) {
       printCost(result_file, costs[i]) << ',' << points[i] << '\n';
     }
@@ -232,12 +390,16 @@ void runBatch(
     }
   }
 #else
-  bool first = true;
-  Point best_point_tmp;
-  Cost<DumpAll> best_cost_tmp;
+  for(uint64_t j : order) {
+    costs[j] = runWrapper<DumpAll>(0, shape_of(j), layer_type, points[j], logfile);
+  }
+
+  // Like above, keep the best point of earlier batches unless this one beats it
+  bool first = ! best_cost.valid;
+  Point best_point_tmp = best_point;
+  Cost<DumpAll> best_cost_tmp = best_cost;
   for(uint64_t i = 0; i < batch_size; ++i) {
     Point const & point = points[i];
-    costs[i] = runWrapper<DumpAll>(0, shape, layer_type, point, logfile);
     if(result_file.is_open()) {
       printCost(result_file, costs[i]) << ',' << points[i] << '\n';
     }
@@ -252,4 +414,39 @@ void runBatch(
 #endif
 }
 
+template<bool DumpAll>
+void runBatch(
+  uint64_t batch_size,
+  ShapeT const & shape,
+  std::string const & layer_type,
+  std::vector<Point> const & points,
+  std::vector<Cost<DumpAll>> & costs,
+  std::ofstream & result_file,
+  Point & best_point,
+  Cost<DumpAll> & best_cost,
+  std::string const & logfile
+)
+{
+  runBatchImpl<DumpAll>(batch_size, [&](uint64_t) -> ShapeT const & { return shape; },
+    layer_type, points, costs, result_file, best_point, best_cost, logfile);
+}
+
+// Same as above, but each point is evaluated against its own layer shape.
+template<bool DumpAll>
+void runBatch(
+  uint64_t batch_size,
+  std::vector<ShapeT> const & shapes,
+  std::string const & layer_type,
+  std::vector<Point> const & points,
+  std::vector<Cost<DumpAll>> & costs,
+  std::ofstream & result_file,
+  Point & best_point,
+  Cost<DumpAll> & best_cost,
+  std::string const & logfile
+)
+{
+  runBatchImpl<DumpAll>(batch_size, [&](uint64_t i) -> ShapeT const & { return shapes[i]; },
+    layer_type, points, costs, result_file, best_point, best_cost, logfile);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+#ifndef _SPOTLIGHT_CONSTRAINTS_HPP
+#define _SPOTLIGHT_CONSTRAINTS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "spotlight-common.hpp"
+
+// Checks of a design point that need no analysis, to reject infeasible points before run().
+//
+// The area and power that MAESTRO reports come from the accelerator model, which sizes the L1
+// and L2 SRAMs by the buffer requirements of the analysis. Every other part of the model only
+// depends on the hardware parameters, so the same model with the smallest SRAMs is a lower bound
+// that points over the area or power budget are rejected on. MAESTRO itself only warns when a
+// tile overflows its buffer, so the footprints of check_buffer_usage in src/constraints.py and
+// the tile nesting of _verify_input_constraints in src/interface.py are reported, and only
+// enforced on request. The points rejected are therefore a subset of those that _filter_cost
+// rejects after run(): by default only the ones whose hardware alone is over budget, and
+// points that MAESTRO fails on still reach run().
+struct ConstraintLimits
+{
+  double max_area = std::numeric_limits<double>::infinity();
+  double max_power = std::numeric_limits<double>::infinity();
+  bool enforce_footprints = false;
+  // Largest footprint over buffer size that passes, as in _verify_input_constraints
+  double max_footprint = 2;
+};
+
+struct HardwareBounds
+{
+  double area;
+  double power;
+};
+
+struct ConstraintUsage
+{
+  // Input, weight and output footprint of every cluster level over its buffer size
+  std::vector<double> footprints;
+  // Lower bounds on the area and power over their budgets
+  double area = 0;
+  double power = 0;
+  // Every tile is at most the tile of the same dimension one level up
+  bool tiles_nested = true;
+  bool feasible = true;
+};
+
+namespace constraints {
+
+// Dimensions of the tiles in check_buffer_usage; primed ones are tiled like their base
+static constexpr std::array<char, 7> tile_dims{ {'N', 'K', 'C', 'X', 'Y', 'R', 'S'} };
+static constexpr uint64_t num_tensors = 3;
+
+inline uint64_t dimIndex(char dim)
+{
+  return std::find(tile_dims.begin(), tile_dims.end(), dim) - tile_dims.begin();
+}
+
+}  // namespace constraints
+
+// Area and power of the accelerator model of MAESTRO with one-byte SRAMs, summed in the same
+// order as DSE::Accelerator so that a point with the smallest buffers gets exactly its area.
+inline HardwareBounds hardwareBounds(uint64_t num_pes, uint64_t num_simd_lanes, uint64_t bit_width, uint64_t bandwidth)
+{
+  namespace cost = maestro::DSE::cost;
+
+  maestro::DSE::MAC mac(cost::mac_area, cost::mac_power, bit_width, num_simd_lanes);
+  maestro::DSE::SRAM l1_sram(cost::sram_area_64, cost::sram_power_64, cost::sram_unit_size_64, bit_width, 0);
+  maestro::DSE::SRAM l2_sram(cost::sram_area_32768, cost::sram_power_32768, cost::sram_unit_size_32768, bit_width, 0);
+  maestro::DSE::Bus bus(cost::bus_unit_area, cost::bus_unit_power, num_pes, bandwidth);
+  maestro::DSE::MatrixArbiter arbiter(cost::arbiter_unit_area, cost::arbiter_unit_power, num_pes);
+
+  double pe_area = 0, pe_power = 0;
+  pe_area += mac.GetArea();
+  pe_area += l1_sram.GetArea();
+  pe_power += mac.GetPower();
+  pe_power += l1_sram.GetPower();
+
+  double pe_array_area = 0, pe_array_power = 0;
+  for(uint64_t pe = 0; pe < num_pes; ++pe) {
+    pe_array_area += pe_area;
+    pe_array_power += pe_power;
+  }
+
+  double noc_area = 0, noc_power = 0;
+  noc_area += bus.GetArea();
+  noc_area += arbiter.GetArea();
+  noc_power += bus.GetPower();
+  noc_power += arbiter.GetPower();
+
+  HardwareBounds bounds{0, 0};
+  bounds.area += pe_array_area;
+  bounds.area += l2_sram.GetArea();
+  bounds.area += noc_area;
+  bounds.power += pe_array_power;
+  bounds.power += l2_sram.GetPower();
+  bounds.power += noc_power;
+  return bounds;
+}
+
+// buf_sizes and num_sub_clusters hold num_levels entries, ordered like the cluster levels of
+// dataflow. A dimension without a directive at some level keeps the tile of the level above.
+inline ConstraintUsage checkConstraints(
+  ShapeT const & shape,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t const * buf_sizes,
+  uint64_t const * num_sub_clusters,
+  DataflowT const & dataflow,
+  ConstraintLimits const & limits
+)
+{
+  using namespace constraints;
+
+  ConstraintUsage usage;
+  usage.footprints.reserve(num_levels * num_tensors);
+
+  std::array<uint64_t, tile_dims.size()> tiles;
+  for(uint64_t d = 0; d < tile_dims.size(); ++d) {
+    auto extent = shape.find(tile_dims[d]);
+    tiles[d] = extent != shape.end() ? extent->second.first : 1;
+  }
+
+  auto directive = dataflow.begin();
+  for(uint64_t level = 0; level < num_levels; ++level) {
+    std::array<uint64_t, tile_dims.size()> level_tiles = tiles;
+    uint64_t spatial_dim = tile_dims.size();
+    for(; directive != dataflow.end() && std::get<0>(*directive) != 'C'; ++directive) {
+      auto const & [kind, size, dim] = *directive;
+      uint64_t d = dimIndex(dim[0]);
+      if(d == tile_dims.size()) { continue; }
+      level_tiles[d] = size;
+      if(kind == 'S') { spatial_dim = d; }
+    }
+    if(directive != dataflow.end()) { ++directive; }
+
+    std::array<double, tile_dims.size()> actual;
+    for(uint64_t d = 0; d < tile_dims.size(); ++d) {
+      usage.tiles_nested &= level_tiles[d] <= tiles[d];
+      double unroll = d == spatial_dim ? num_sub_clusters[level] : 1;
+      if(tile_dims[d] == 'X' || tile_dims[d] == 'Y') { actual[d] = level_tiles[d] + unroll - 1; }
+      else { actual[d] = level_tiles[d] * unroll; }
+    }
+    tiles = level_tiles;
+
+    auto [n, k, c, x, y, r, s] = actual;
+    double inp = 2 * (n * c * x * y);
+    double wgt = 2 * (k * c * r * s);
+    double out = 2 * (n * k * (x - std::min(r, x) + 1) * (y - std::min(s, y) + 1));
+    double buf_size = buf_sizes[level];
+    for(double footprint : {inp, wgt, out}) { usage.footprints.push_back(footprint / buf_size); }
+  }
+
+  HardwareBounds bounds = hardwareBounds(num_pes, num_simd_lanes, bit_width, bandwidth);
+  usage.area = bounds.area / limits.max_area;
+  usage.power = bounds.power / limits.max_power;
+
+  usage.feasible = bounds.area <= limits.max_area && bounds.power <= limits.max_power;
+  if(limits.enforce_footprints) {
+    usage.feasible &= usage.tiles_nested;
+    for(double footprint : usage.footprints) { usage.feasible &= footprint <= limits.max_footprint; }
+  }
+  return usage;
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef _SPOTLIGHT_EXECUTOR_HPP
+#define _SPOTLIGHT_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Process-wide work-stealing executor shared by every batch entry point.
+//
+// Workers are spawned once (SPOTLIGHT_NUM_THREADS, or hardware_concurrency by default) and
+// persist for the lifetime of the process. A call to parallelFor splits its index range evenly
+// into one deque per worker plus one for the calling thread, which participates in the work.
+// Each deque is a single packed (begin, end) word: the owner pops from the front and thieves
+// steal the back half, both with a single CAS, so no per-task allocation or locking is needed.
+// Several threads may call parallelFor concurrently, and a task may itself call parallelFor.
+class Executor
+{
+public:
+  static Executor & instance(void)
+  {
+    static Executor executor(defaultNumThreads());
+    return executor;
+  }
+
+  // Total number of threads that execute tasks, including the calling thread.
+  uint64_t numThreads(void) const { return workers_.size() + 1; }
+
+  // Runs func(i) for every i in [0, num_tasks) and returns once all of them have finished.
+  // func must not throw.
+  template<typename F>
+  void parallelFor(uint64_t num_tasks, F && func)
+  {
+    if(num_tasks == 0) { return; }
+    if(workers_.empty() || num_tasks == 1) {
+      for(uint64_t i = 0; i < num_tasks; ++i) { func(i); }
+      return;
+    }
+    assert(num_tasks <= UINT32_MAX);
+
+    using FuncT = std::remove_reference_t<F>;
+    Job job(workers_.size() + 1, num_tasks);
+    job.invoke = [](void * ctx, uint64_t i) { (*static_cast<FuncT *>(ctx))(i); };
+    job.ctx = static_cast<void *>(&func);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job.next = jobs_;
+      jobs_ = &job;
+    }
+    work_cv_.notify_all();
+
+    work(job, workers_.size());
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(Job ** it = &jobs_; *it != nullptr; it = &(*it)->next) {
+      if(*it == &job) { *it = job.next; break; }
+    }
+    done_cv_.wait(lock, [&] { return job.remaining.load() == 0 && job.refs == 0; });
+  }
+
+  ~Executor()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_cv_.notify_all();
+    for(auto & worker : workers_) { worker.join(); }
+  }
+
+  Executor(Executor const &) = delete;
+  Executor & operator=(Executor const &) = delete;
+
+private:
+  struct alignas(64) Deque
+  {
+    std::atomic<uint64_t> range{0};
+  };
+
+  struct Job
+  {
+    Job(uint64_t num_deques, uint64_t num_tasks) : deques(new Deque[num_deques]), num_deques(num_deques), remaining(num_tasks)
+    {
+      for(uint64_t d = 0; d < num_deques; ++d) {
+        deques[d].range = pack(num_tasks * d / num_deques, num_tasks * (d + 1) / num_deques);
+      }
+    }
+
+    void (*invoke)(void *, uint64_t) = nullptr;
+    void * ctx = nullptr;
+    std::unique_ptr<Deque[]> deques;
+    uint64_t num_deques;
+    std::atomic<uint64_t> remaining;
+    std::atomic<bool> exhausted{false};
+    uint64_t refs = 0;  // Guarded by mutex_
+    Job * next = nullptr;  // Guarded by mutex_
+  };
+
+  static uint64_t pack(uint64_t begin, uint64_t end) { return (begin << 32) | end; }
+  static uint64_t begin(uint64_t range) { return range >> 32; }
+  static uint64_t end(uint64_t range) { return range & 0xffffffff; }
+
+  static uint64_t defaultNumThreads(void)
+  {
+    if(char const * env = std::getenv("SPOTLIGHT_NUM_THREADS")) {
+      long num_threads = std::atol(env);
+      if(num_threads > 0) { return num_threads; }
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  explicit Executor(uint64_t num_threads)
+  {
+    for(uint64_t i = 0; i + 1 < num_threads; ++i) {
+      workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+  }
+
+  // Pops tasks from the given deque, stealing from the others once it runs dry.
+  static void work(Job & job, uint64_t self)
+  {
+    std::atomic<uint64_t> & own = job.deques[self].range;
+    while(true) {
+      uint64_t range = own.load();
+      if(begin(range) < end(range)) {
+        if(own.compare_exchange_weak(range, pack(begin(range) + 1, end(range)))) {
+          job.invoke(job.ctx, begin(range));
+          job.remaining.fetch_sub(1);
+        }
+        continue;
+      }
+      if(! steal(job, self)) {
+        job.exhausted = true;
+        return;
+      }
+    }
+  }
+
+  // Moves the back half of some other deque into the (empty) deque owned by self.
+  static bool steal(Job & job, uint64_t self)
+  {
+    for(uint64_t offset = 1; offset < job.num_deques; ++offset) {
+      std::atomic<uint64_t> & victim = job.deques[(self + offset) % job.num_deques].range;
+      uint64_t range = victim.load();
+      while(begin(range) < end(range)) {
+        uint64_t mid = begin(range) + (end(range) - begin(range)) / 2;
+        if(victim.compare_exchange_weak(range, pack(begin(range), mid))) {
+          job.deques[self].range = pack(mid, end(range));
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void workerLoop(uint64_t self)
+  {
+    while(true) {
+      Job * job = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [&] { return stop_ || (job = findJob()) != nullptr; });
+        if(stop_) { return; }
+        ++job->refs;
+      }
+
+      work(*job, self);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(--job->refs == 0 && job->remaining.load() == 0) { done_cv_.notify_all(); }
+    }
+  }
+
+  Job * findJob(void)
+  {
+    for(Job * job = jobs_; job != nullptr; job = job->next) {
+      if(! job->exhausted) { return job; }
+    }
+    return nullptr;
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  Job * jobs_ = nullptr;
+  bool stop_ = false;
+};
+
+#endif
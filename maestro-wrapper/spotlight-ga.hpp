@@ -0,0 +1,344 @@
+#ifndef _SPOTLIGHT_GA_HPP
+#define _SPOTLIGHT_GA_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "spotlight-common.hpp"
+
+// Genetic search over the software space that src/space.py builds for the "searched" dataflow:
+// every dimension is split into num_levels + 1 tile factors, and every cluster level maps one
+// dimension spatially. An individual is a genome of indices, one per parameter of that space.
+//
+// The search follows src/ga.py. The first generation is drawn uniformly from the space, and
+// each later one is bred from the valid individuals of the one before. Every child starts as a
+// copy of a parent, taken in turn from a shuffled order. With probability cross_rate it then
+// takes each gene from a mate that is picked by a geometric distribution over the fitness ranks,
+// and at last each gene mutates into that of a random parent with probability mutation_rate.
+// A generation is evaluated in parallel, in slices no larger than the number of valid
+// individuals still needed, so the search evaluates as many points as one that went one by one.
+struct GeneticOptions
+{
+  uint64_t population = 1000;    // Individuals per generation
+  uint64_t num_trials = 100;     // Valid individuals to evaluate
+  uint64_t max_invalid = 2500;   // The search fails once this many individuals were invalid
+  bool delay_only = false;       // Fitness is the delay instead of the energy-delay product
+  double max_area = std::numeric_limits<double>::infinity();
+  double max_power = std::numeric_limits<double>::infinity();
+  // Lower bounds on the area and power of every individual, see hardwareBounds
+  double min_area = 0;
+  double min_power = 0;
+  double cross_rate = 0.8;
+  double mutation_rate = 0.05;
+  double parent_p = 0.2;
+  uint64_t seed = 0;
+};
+
+struct GeneticStats
+{
+  uint64_t num_generations = 0;
+  uint64_t num_valid = 0;
+  uint64_t num_invalid = 0;
+  // Reasons for the invalid individuals, counted like in src/interface.py
+  uint64_t num_maestro_failures = 0;
+  uint64_t num_area_failures = 0;
+  uint64_t num_power_failures = 0;
+};
+
+struct GeneticElite
+{
+  std::vector<uint32_t> genome;
+  Cost<false> cost;
+  double fitness;
+  uint64_t order;    // Position in the order of evaluation
+};
+
+namespace genetic_search {
+
+// Dimensions of the tile genes, which come first in a genome, and the ones that a spatial gene
+// may pick. Both follow the parameters of src/space.py.
+inline constexpr std::array<char, 7> tile_dims{ {'K', 'C', 'N', 'X', 'Y', 'R', 'S'} };
+inline constexpr std::array<char, 6> spatial_dims{ {'K', 'C', 'X', 'Y', 'R', 'S'} };
+
+// Order of the temporal maps of a cluster level, as in src/interface.py
+inline constexpr std::array<char, 7> tile_order{ {'N', 'K', 'C', 'X', 'Y', 'R', 'S'} };
+
+inline uint64_t orderIndex(char dim) { return std::find(tile_order.begin(), tile_order.end(), dim) - tile_order.begin(); }
+
+}  // namespace genetic_search
+
+class SoftwareSpace
+{
+public:
+  SoftwareSpace(ShapeT const & shape, uint64_t num_levels) : num_levels_(num_levels)
+  {
+    for(uint64_t gene = 0; gene < genetic_search::tile_dims.size(); ++gene) {
+      std::vector<uint64_t> prefix;
+      factorize(num_levels + 1, shape.at(genetic_search::tile_dims[gene]).first, prefix, factorizations_[gene]);
+    }
+  }
+
+  // Tile genes in the order of genetic_search::tile_dims, then the spatial gene of every level
+  uint64_t numGenes(void) const { return genetic_search::tile_dims.size() + num_levels_; }
+  uint64_t numLevels(void) const { return num_levels_; }
+
+  uint64_t numValues(uint64_t gene) const
+  {
+    if(gene < genetic_search::tile_dims.size()) { return factorizations_[gene].size(); }
+    return genetic_search::spatial_dims.size();
+  }
+
+  // Tile factors of every level, innermost first, that value of a tile gene stands for
+  std::vector<uint64_t> const & factors(uint64_t gene, uint32_t value) const { return factorizations_[gene][value]; }
+
+  // Spatially mapped dimension that value of a spatial gene stands for
+  static char spatialDim(uint32_t value) { return genetic_search::spatial_dims[value]; }
+
+  // Directives of a genome with the outermost cluster level first, built like
+  // _build_dataflow_list in src/interface.py. Clusters take their size from num_sub_clusters,
+  // which is ordered like the levels.
+  DataflowT dataflow(uint32_t const * genome, uint64_t const * num_sub_clusters) const
+  {
+    using namespace genetic_search;
+
+    // Level j of the dataflow is level num_levels - 1 - j of the space, whose tiles are the
+    // products of the factors of the levels below it
+    std::vector<std::array<uint64_t, tile_order.size()>> tiles(num_levels_);
+    for(uint64_t gene = 0; gene < tile_dims.size(); ++gene) {
+      std::vector<uint64_t> const & dim_factors = factors(gene, genome[gene]);
+      uint64_t tile = 1;
+      for(uint64_t level = 0; level < num_levels_; ++level) {
+        tile *= dim_factors[level];
+        tiles[num_levels_ - 1 - level][orderIndex(tile_dims[gene])] = tile;
+      }
+    }
+
+    DataflowT ret;
+    ret.reserve(num_levels_ * (tile_order.size() + 1));
+    for(uint64_t j = 0; j < num_levels_; ++j) {
+      char spatial_dim = spatialDim(genome[tile_dims.size() + num_levels_ - 1 - j]);
+      uint64_t spatial = orderIndex(spatial_dim);
+      ret.emplace_back('S', tiles[j][spatial], std::string(1, spatial_dim));
+      for(uint64_t dim = 0; dim < tile_order.size(); ++dim) {
+        if(dim != spatial) { ret.emplace_back('T', tiles[j][dim], std::string(1, tile_order[dim])); }
+      }
+      if(j + 1 < num_levels_) {
+        tiles[j + 1][spatial] = std::min(tiles[j + 1][spatial], tiles[j][spatial]);
+        ret.emplace_back('C', num_sub_clusters[j + 1], "P");
+      }
+    }
+    return ret;
+  }
+
+private:
+  // Every way to split value into n ordered factors, in the order of get_all_combinations in
+  // src/space.py
+  static void factorize(uint64_t n, uint64_t value, std::vector<uint64_t> & prefix, std::vector<std::vector<uint64_t>> & ret)
+  {
+    if(n == 1) {
+      ret.push_back(prefix);
+      ret.back().push_back(value);
+      return;
+    }
+    for(uint64_t factor = value; factor > 0; --factor) {
+      if(value % factor != 0) { continue; }
+      prefix.push_back(factor);
+      factorize(n - 1, value / factor, prefix, ret);
+      prefix.pop_back();
+    }
+  }
+
+  uint64_t num_levels_;
+  std::array<std::vector<std::vector<uint64_t>>, genetic_search::tile_dims.size()> factorizations_;
+};
+
+namespace genetic_search {
+
+// Fills children with population genomes bred from parents, or drawn uniformly if there are none
+inline void breed(
+  SoftwareSpace const & space,
+  GeneticOptions const & options,
+  std::vector<uint32_t> const & parents,
+  std::vector<double> const & parent_fitness,
+  std::vector<uint32_t> & children,
+  std::mt19937_64 & rng
+)
+{
+  uint64_t num_genes = space.numGenes();
+  std::uniform_real_distribution<double> uniform(0, 1);
+
+  if(parents.empty()) {
+    for(uint64_t child = 0; child < options.population; ++child) {
+      for(uint64_t gene = 0; gene < num_genes; ++gene) {
+        children[child * num_genes + gene] = std::uniform_int_distribution<uint32_t>(0, space.numValues(gene) - 1)(rng);
+      }
+    }
+    return;
+  }
+
+  uint64_t num_parents = parent_fitness.size();
+  std::vector<uint64_t> ranks(num_parents);
+  std::iota(ranks.begin(), ranks.end(), 0);
+  std::stable_sort(ranks.begin(), ranks.end(), [&](uint64_t a, uint64_t b) { return parent_fitness[a] < parent_fitness[b]; });
+
+  std::vector<uint64_t> fathers(num_parents);
+  std::iota(fathers.begin(), fathers.end(), 0);
+  std::geometric_distribution<uint64_t> mate_rank(options.parent_p);
+  std::uniform_int_distribution<uint64_t> random_parent(0, num_parents - 1);
+  std::bernoulli_distribution coin(0.5);
+
+  for(uint64_t child = 0; child < options.population; ++child) {
+    if(child % num_parents == 0) { std::shuffle(fathers.begin(), fathers.end(), rng); }
+    uint32_t const * father = &parents[fathers[child % num_parents] * num_genes];
+    uint32_t * genome = &children[child * num_genes];
+    std::copy(father, father + num_genes, genome);
+
+    if(uniform(rng) < options.cross_rate) {
+      uint64_t rank;
+      do { rank = mate_rank(rng); } while(rank >= num_parents);
+      uint32_t const * mother = &parents[ranks[rank] * num_genes];
+      for(uint64_t gene = 0; gene < num_genes; ++gene) {
+        if(coin(rng)) { genome[gene] = mother[gene]; }
+      }
+    }
+
+    for(uint64_t gene = 0; gene < num_genes; ++gene) {
+      if(uniform(rng) < options.mutation_rate) { genome[gene] = parents[random_parent(rng) * num_genes + gene]; }
+    }
+  }
+}
+
+// Whether the hardware alone exceeds the area or power budget, so that no individual can pass
+inline bool overBudget(GeneticOptions const & options)
+{
+  return options.min_area > options.max_area || options.min_power > options.max_power;
+}
+
+// Whether cost passes the checks of _filter_cost in src/interface.py, counting the failures.
+// Individuals over budget are not evaluated and fail on their bounds, like in src/interface.py.
+inline bool accept(Cost<false> const & cost, GeneticOptions const & options, GeneticStats & stats)
+{
+  if(options.min_area > options.max_area) {
+    ++stats.num_area_failures;
+    return false;
+  }
+  if(options.min_power > options.max_power) {
+    ++stats.num_power_failures;
+    return false;
+  }
+  if(! cost.valid || cost.delay <= 0 || cost.energy <= 0 || cost.area <= 0) {
+    ++stats.num_maestro_failures;
+    return false;
+  }
+  if(cost.area > options.max_area) {
+    ++stats.num_area_failures;
+    return false;
+  }
+  if(cost.power > options.max_power) {
+    ++stats.num_power_failures;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace genetic_search
+
+// Runs the search with evaluate(dataflow) computing the cost of the directives of an individual,
+// and returns up to num_elites of the best distinct valid individuals, best first. Ties in
+// fitness go to the smaller area and then to the individual evaluated first. The search succeeded if
+// stats.num_valid reached options.num_trials.
+template<typename EvaluateF>
+std::vector<GeneticElite> runGeneticSearch(
+  SoftwareSpace const & space,
+  uint64_t const * num_sub_clusters,
+  GeneticOptions const & options,
+  uint64_t num_elites,
+  EvaluateF && evaluate,
+  GeneticStats & stats
+)
+{
+  using namespace genetic_search;
+
+  auto better = [](GeneticElite const & a, GeneticElite const & b) {
+    if(a.fitness != b.fitness) { return a.fitness < b.fitness; }
+    if(a.cost.area != b.cost.area) { return a.cost.area < b.cost.area; }
+    return a.order < b.order;
+  };
+
+  uint64_t num_genes = space.numGenes();
+  std::mt19937_64 rng(options.seed);
+  std::vector<uint32_t> parents, next_parents;
+  std::vector<double> parent_fitness, next_parent_fitness;
+  std::vector<uint32_t> children(options.population * num_genes);
+  std::vector<Cost<false>> costs(options.population);
+  std::vector<GeneticElite> elites;
+  uint64_t order = 0;
+  bool over_budget = overBudget(options);
+
+  while(stats.num_valid < options.num_trials && options.population > 0) {
+    breed(space, options, parents, parent_fitness, children, rng);
+    ++stats.num_generations;
+    next_parents.clear();
+    next_parent_fitness.clear();
+
+    for(uint64_t begin = 0; begin < options.population && stats.num_valid < options.num_trials;) {
+      uint64_t count = std::min(options.population - begin, options.num_trials - stats.num_valid);
+
+      // Every individual has the loop orders of the space, so evaluating them by tile sizes has
+      // consecutive ones share their outer cluster levels, which are then not re-analyzed
+      std::vector<DataflowT> dataflows(count);
+      for(uint64_t i = 0; i < count; ++i) { dataflows[i] = space.dataflow(&children[(begin + i) * num_genes], num_sub_clusters); }
+      std::vector<uint64_t> by_sizes(count);
+      std::iota(by_sizes.begin(), by_sizes.end(), 0);
+      std::stable_sort(by_sizes.begin(), by_sizes.end(),
+        [&](uint64_t a, uint64_t b) { return sizesBefore(dataflows[a], dataflows[b]); });
+
+      auto evaluate_one = [&](uint64_t i) {
+        if(over_budget) { return; }
+        costs[begin + by_sizes[i]] = evaluate(dataflows[by_sizes[i]]);
+      };
+#ifdef MULTICORE
+      Executor::instance().parallelFor(count, evaluate_one);
+#else
+      for(uint64_t i = 0; i < count; ++i) { evaluate_one(i); }
+#endif
+
+      for(uint64_t child = begin; child < begin + count; ++child) {
+        if(accept(costs[child], options, stats)) {
+          uint32_t const * genome = &children[child * num_genes];
+          double fitness = options.delay_only ? costs[child].delay : costs[child].delay * costs[child].energy;
+          next_parents.insert(next_parents.end(), genome, genome + num_genes);
+          next_parent_fitness.push_back(fitness);
+
+          GeneticElite elite{std::vector<uint32_t>(genome, genome + num_genes), costs[child], fitness, order};
+          bool seen = std::any_of(elites.begin(), elites.end(), [&](GeneticElite const & e) { return e.genome == elite.genome; });
+          if(! seen && (elites.size() < num_elites || better(elite, elites.back()))) {
+            elites.insert(std::upper_bound(elites.begin(), elites.end(), elite, better), std::move(elite));
+            if(elites.size() > num_elites) { elites.pop_back(); }
+          }
+          ++stats.num_valid;
+        } else {
+          ++stats.num_invalid;
+        }
+        ++order;
+
+        // Like src/optimizer.py, which checks after every sample
+        if(stats.num_invalid >= options.max_invalid) { return elites; }
+      }
+      begin += count;
+    }
+
+    parents.swap(next_parents);
+    parent_fitness.swap(next_parent_fitness);
+  }
+
+  return elites;
+}
+
+#endif
@@ -1,10 +1,17 @@
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <cstring>
+#include <functional>
 #include <numeric>
 #include <random>
+#include <string_view>
+#include <unordered_map>
 
 #include "spotlight-common.hpp"
+#include "spotlight-constraints.hpp"
+#include "spotlight-ga.hpp"
+#include "spotlight-search.hpp"
 
 #ifdef _DEBUG_OUT
   static constexpr uint64_t num_samples = 1;
@@ -13,6 +20,89 @@
 #endif
 static std::string logfile = "";
 
+// search_permutations is 0 to keep the given loop order, search_all_permutations to search every
+// cluster level for the best order, and anything else to sample num_samples random orders
+static constexpr uint64_t search_all_permutations = 2;
+
+// Dataflow strings are comma-separated directives of the form "<S|T><dim>|<tile size>", with a
+// bare "C" marking a cluster boundary whose size is taken from num_sub_clusters. Like the binary
+// records below, strings come straight from callers of the library, so parsing fails, leaving
+// dataflow empty, on an empty string or a directive that does not have that form.
+static bool parseDataflow(std::string_view dataflow_str, uint64_t const * num_sub_clusters, DataflowT & dataflow)
+{
+  if(dataflow_str.empty()) { return false; }
+
+  size_t parse_pos = 0;
+  uint64_t sub_cluster_level = 1;
+  while(true) {
+    auto comma = dataflow_str.find(',', parse_pos);
+    std::string_view directive = dataflow_str.substr(parse_pos, comma == std::string_view::npos ? comma : comma - parse_pos);
+    if(directive == "C") {
+      dataflow.push_back(std::make_tuple('C', num_sub_clusters[sub_cluster_level], "P"));
+      ++sub_cluster_level;
+    } else {
+      auto bar = directive.find('|');
+      uint64_t tile_size = 0;
+      char const * size_end = directive.data() + directive.size();
+      if(directive.empty() || (directive[0] != 'S' && directive[0] != 'T') || bar == std::string_view::npos || bar < 2 ||
+        bar + 1 == directive.size() || std::from_chars(directive.data() + bar + 1, size_end, tile_size).ptr != size_end) {
+        dataflow.clear();
+        return false;
+      }
+      dataflow.push_back(std::make_tuple(directive[0], tile_size, std::string{directive.substr(1, bar - 1)}));
+    }
+
+    if(comma == std::string_view::npos) { break; }
+    parse_pos = comma + 1;
+  }
+  return true;
+}
+
+// Binary dataflows are arrays of (kind, dimension, size) records, one per directive. kind is the
+// character code of 'S', 'T' or 'C', and dimension indexes directive_dimensions. As in the string
+// form, a 'C' record marks a cluster boundary whose size is taken from num_sub_clusters, and its
+// dimension and size fields are ignored. Records come straight from callers of the library, so
+// decoding fails, leaving dataflow empty, on an unknown kind or dimension, or on more cluster
+// boundaries than num_sub_clusters has levels.
+static constexpr uint64_t directive_record_size = 3;
+static constexpr std::array<char const *, 9> directive_dimensions{ {"N", "K", "C", "X", "Y", "R", "S", "X'", "Y'"} };
+
+static bool decodeDataflow(uint64_t const * records, uint64_t num_directives, uint64_t const * num_sub_clusters, uint64_t num_levels,
+  DataflowT & dataflow)
+{
+  uint64_t sub_cluster_level = 1;
+  dataflow.reserve(num_directives);
+  for(uint64_t i = 0; i < num_directives; ++i) {
+    uint64_t const * record = records + i * directive_record_size;
+    if(record[0] == 'S' || record[0] == 'T') {
+      if(record[1] >= directive_dimensions.size()) { dataflow.clear(); return false; }
+      dataflow.emplace_back(static_cast<char>(record[0]), record[2], directive_dimensions[record[1]]);
+    } else if(record[0] == 'C') {
+      if(sub_cluster_level >= num_levels) { dataflow.clear(); return false; }
+      dataflow.emplace_back('C', num_sub_clusters[sub_cluster_level], "P");
+      ++sub_cluster_level;
+    } else {
+      dataflow.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+// Shapes are passed as (size, stride) pairs in N, K, C, X, Y, R, S order.
+static ShapeT parseShape(uint64_t const * shape)
+{
+  ShapeT shape_map;
+  shape_map['N'] = std::make_pair(shape[0], shape[1]);
+  shape_map['K'] = std::make_pair(shape[2], shape[3]);
+  shape_map['C'] = std::make_pair(shape[4], shape[5]);
+  shape_map['X'] = std::make_pair(shape[6], shape[7]);
+  shape_map['Y'] = std::make_pair(shape[8], shape[9]);
+  shape_map['R'] = std::make_pair(shape[10], shape[11]);
+  shape_map['S'] = std::make_pair(shape[12], shape[13]);
+  return shape_map;
+}
+
 template<bool DumpAll>
 Cost<DumpAll> evaluateHelper(
   uint64_t * shape,
@@ -24,12 +114,13 @@ Cost<DumpAll> evaluateHelper(
   uint64_t num_levels,
   uint64_t * buf_sizes,
   uint64_t * num_sub_clusters,
-  char const * dataflow,
+  DataflowT const & dataflow,
   uint64_t search_permutations,
   std::string logfile
 )
 {
   (void) num_levels;
+  (void) num_sub_clusters;
 
 #if (defined _DEBUG_OUT) && (defined _VERBOSE)
   std::cout << "    shape = { {";
@@ -62,7 +153,16 @@ Cost<DumpAll> evaluateHelper(
   }
   std::cout << "} };\n";
 
-  std::cout << "    dataflow = \"" << dataflow << "\";\n";
+  std::cout << "    dataflow = \"";
+  prefix = "";
+  for(auto const & directive : dataflow) {
+    std::cout << prefix << std::get<0>(directive);
+    if(std::get<0>(directive) != 'C') {
+      std::cout << std::get<2>(directive) << '|' << std::get<1>(directive);
+    }
+    prefix = ",";
+  }
+  std::cout << "\";\n";
 #endif
 
   maestro::InitializeBaseObjects(0);
@@ -77,50 +177,17 @@ Cost<DumpAll> evaluateHelper(
   point.bw = bandwidth;
   point.latency = 1;
 
-  size_t parse_pos = 0;
-  uint64_t sub_cluster_level = 1;
-  bool done = false;
-  while(! done) {
-    std::string dataflow_str{dataflow};
-    char loop_type = dataflow_str[parse_pos];
-    ++parse_pos;
-    if(loop_type != 'C') {
-      auto bar = dataflow_str.find('|', parse_pos);
-      std::string dimension{dataflow_str, parse_pos, bar - parse_pos};
-      parse_pos = bar + 1;
-      auto comma = dataflow_str.find(',', parse_pos);
-      std::string tile_size_str;
-      if(comma == std::string::npos) {
-        tile_size_str = std::string(dataflow_str, parse_pos);
-        done = true;
-      } else {
-        tile_size_str = std::string(dataflow_str, parse_pos, comma - parse_pos);
-        parse_pos = comma + 1;
-      }
-      // std::cout << loop_type << ' ' << dimension << ' ' << tile_size_str << '\n';
-      uint64_t tile_size = std::stoi(tile_size_str);
-      point.dataflow.push_back(std::make_tuple(loop_type, tile_size, dimension));
-    } else {
-        point.dataflow.push_back(std::make_tuple('C', num_sub_clusters[sub_cluster_level], "P"));
-        // std::cout << loop_type << '\n';
-        ++sub_cluster_level;
-        ++parse_pos;
-    }
-  }
-
-  ShapeT shape_map;
-  shape_map['N'] = std::make_pair(shape[0], shape[1]);
-  shape_map['K'] = std::make_pair(shape[2], shape[3]);
-  shape_map['C'] = std::make_pair(shape[4], shape[5]);
-  shape_map['X'] = std::make_pair(shape[6], shape[7]);
-  shape_map['Y'] = std::make_pair(shape[8], shape[9]);
-  shape_map['R'] = std::make_pair(shape[10], shape[11]);
-  shape_map['S'] = std::make_pair(shape[12], shape[13]);
+  point.dataflow = dataflow;
+  ShapeT shape_map = parseShape(shape);
 
   std::ofstream result_file;
 
 #ifdef EXHAUSTIVE_PERMUTATIONS
-  std::vector<uint64_t> high_indices(7), low_indices(7);
+  // Brute force over every order of the two cluster levels, to check the search against
+  uint64_t cluster_pos = std::find_if(point.dataflow.begin(), point.dataflow.end(),
+    [](auto const & directive) { return std::get<0>(directive) == 'C'; }) - point.dataflow.begin();
+  std::vector<uint64_t> high_indices(cluster_pos);
+  std::vector<uint64_t> low_indices(cluster_pos < point.dataflow.size() ? point.dataflow.size() - cluster_pos - 1 : 0);
   std::iota(high_indices.begin(), high_indices.end(), 0);
   std::iota(low_indices.begin(), low_indices.end(), 0);
 
@@ -131,49 +198,56 @@ Cost<DumpAll> evaluateHelper(
 
   Point best_point_full;
   Cost<DumpAll> best_cost_full{};
-  uint64_t space_size = 0;
 
   do {
     do {
       Point copy = point;
-      for(uint8_t i = 0; i < high_indices.size(); ++i) { copy.dataflow[i] = point.dataflow[high_indices[i]]; }
-      for(uint8_t i = 0; i < low_indices.size(); ++i) { copy.dataflow[8+i] = point.dataflow[8+low_indices[i]]; }
+      for(uint64_t i = 0; i < high_indices.size(); ++i) { copy.dataflow[i] = point.dataflow[high_indices[i]]; }
+      for(uint64_t i = 0; i < low_indices.size(); ++i) { copy.dataflow[cluster_pos+1+i] = point.dataflow[cluster_pos+1+low_indices[i]]; }
 
-      space_batch_full[batch_idx] = point;
+      space_batch_full[batch_idx] = copy;
       cost_batch_full[batch_idx] = Cost<DumpAll>{};
       ++batch_idx;
-      ++space_size;
 
       if(batch_idx == batch_size) {
         std::cout << "Running " << batch_size << " samples\n";
-        Point best_point_cur;
-        Cost<DumpAll> best_cost_cur{};
-        runBatch(batch_size, shape_map, layer_shape, space_batch_full, cost_batch_full, result_file, best_point_cur, best_cost_cur, logfile);
+        runBatch(batch_size, shape_map, layer_type, space_batch_full, cost_batch_full, result_file, best_point_full, best_cost_full, logfile);
         batch_idx = 0;
-
-        if(best_cost_cur < best_cost_full) {
-          best_cost_full = best_cost_cur;
-          best_point_full = best_point_cur;
-        }
       }
     } while(std::next_permutation(std::begin(low_indices), std::end(low_indices)));
   } while(std::next_permutation(std::begin(high_indices), std::end(high_indices)));
 
   if(batch_idx != 0) {
-    Point best_point_cur;
-    Cost<DumpAll> best_cost_cur{};
-    runBatch(space_size % batch_size, shape_map, layer_shape, space_batch_full, cost_batch_full, result_file, best_point_cur, best_cost_cur, logfile);
-    if(best_cost_cur < best_cost_full) {
-      best_cost_full = best_cost_cur;
-      best_point_full = best_point_cur;
-    }
+    runBatch(batch_idx, shape_map, layer_type, space_batch_full, cost_batch_full, result_file, best_point_full, best_cost_full, logfile);
   }
 #endif  // ifdef EXHAUSTIVE_PERMUTATIONS
 
   Point best_point;
   Cost<DumpAll> best_cost;
 
-  if(search_permutations) {
+  if(search_permutations == search_all_permutations) {
+    LoopOrderStats stats;
+    Cost<false> cost = searchLoopOrders(shape_map, layer_type, point, best_point, stats, logfile);
+    if constexpr (DumpAll) {
+      best_cost = runWrapper<true>(0, shape_map, layer_type, best_point, logfile);
+    } else {
+      best_cost = cost;
+    }
+
+#ifdef _DEBUG_OUT
+    std::cout << "Evaluated " << stats.num_evaluated << " of " << stats.num_classes << " distinct loop orders ("
+              << stats.num_orders << " in total)\n";
+#endif
+#ifdef EXHAUSTIVE_PERMUTATIONS
+    if(! (best_cost == best_cost_full)) {
+      std::cout << "Search found ";
+      printCost(std::cout, best_cost);
+      std::cout << " not ";
+      printCost(std::cout, best_cost_full);
+      std::cout << '\n';
+    }
+#endif
+  } else if(search_permutations) {
     std::array<uint64_t, 7> indices;
     std::iota(indices.begin(), indices.end(), 0);
 
@@ -227,6 +301,51 @@ Cost<DumpAll> evaluateHelper(
   return best_cost;
 }
 
+static char const * dumpCost(Cost<true> const & best_cost)
+{
+  std::stringstream ret_ss;
+  ret_ss << "{";
+  if(best_cost.valid) {
+    std::string prefix = "";
+    for(uint64_t metric = 0; metric < num_metrics; ++metric) {
+      long double value = best_cost.costs[metric];
+      if(std::isfinite(value)) {
+        ret_ss << prefix << '"' << MetricTypeName(static_cast<maestro::MetricType>(metric)) << "\": " << std::to_string(value);
+        prefix = ", ";
+      }
+    }
+  }
+  ret_ss << "}";
+
+  std::string ret_s = ret_ss.str();
+  char * ret = new char[ret_s.size() + 1];
+  std::memcpy(ret, ret_s.c_str(), ret_s.size() + 1);
+  return ret;
+}
+
+// Metrics that were not computed stay NaN; an invalid cost is all zeros, like in packCost
+static void packMetrics(Cost<true> const & cost, double * ret)
+{
+  if(cost.valid) {
+    std::copy(cost.costs.begin(), cost.costs.end(), ret);
+  } else {
+    std::fill(ret, ret + num_metrics, 0);
+  }
+}
+
+static void packCost(Cost<false> const & cost, double * ret)
+{
+  if(cost.valid) {
+    ret[0] = cost.delay;
+    ret[1] = cost.energy;
+    ret[2] = cost.area;
+    ret[3] = cost.power;
+    ret[4] = cost.throughput;
+  } else {
+    std::fill(ret, ret + 5, 0);
+  }
+}
+
 extern "C" __attribute__((visibility("default")))
 char const * evaluateWithDump(
   uint64_t * shape,
@@ -243,6 +362,11 @@ char const * evaluateWithDump(
   char const * logfile
 )
 {
+  DataflowT dataflow_parsed;
+  if(! parseDataflow(std::string_view{dataflow}, num_sub_clusters, dataflow_parsed)) {
+    return dumpCost(Cost<true>{});
+  }
+
   Cost<true> best_cost = evaluateHelper<true>(
     shape,
     std::string{layer_type},
@@ -253,32 +377,16 @@ char const * evaluateWithDump(
     num_levels,
     buf_sizes,
     num_sub_clusters,
-    dataflow,
+    dataflow_parsed,
     search_permutations,
     std::string{logfile}
   );
 
-  std::stringstream ret_ss;
-  ret_ss << "{";
-  if(best_cost.valid) {
-    std::string prefix = "";
-    for(auto const & node : best_cost.costs) {
-      if(std::isfinite(node.second)) {
-        ret_ss << prefix << '"' << MetricTypeToString(node.first) << "\": " << std::to_string(node.second);
-        prefix = ", ";
-      }
-    }
-  }
-  ret_ss << "}";
-
-  std::string ret_s = ret_ss.str();
-  char * ret = new char[ret_s.size() + 1];
-  std::memcpy(ret, ret_s.c_str(), ret_s.size() + 1);
-  return ret;
+  return dumpCost(best_cost);
 }
 
-extern "C" __attribute__((visibility("default")))
-double * evaluate(
+template<bool DumpAll>
+static Cost<DumpAll> evaluateBinaryHelper(
   uint64_t * shape,
   char const * layer_type,
   uint64_t num_pes,
@@ -288,12 +396,18 @@ double * evaluate(
   uint64_t num_levels,
   uint64_t * buf_sizes,
   uint64_t * num_sub_clusters,
-  char const * dataflow,
+  uint64_t * dataflow,
+  uint64_t num_directives,
   uint64_t search_permutations,
   char const * logfile
 )
 {
-  Cost<false> best_cost = evaluateHelper<false>(
+  DataflowT dataflow_decoded;
+  if(! decodeDataflow(dataflow, num_directives, num_sub_clusters, num_levels, dataflow_decoded)) {
+    return Cost<DumpAll>{};
+  }
+
+  return evaluateHelper<DumpAll>(
     shape,
     std::string{layer_type},
     num_pes,
@@ -303,26 +417,586 @@ double * evaluate(
     num_levels,
     buf_sizes,
     num_sub_clusters,
-    dataflow,
+    dataflow_decoded,
     search_permutations,
     std::string{logfile}
   );
+}
+
+// Same as evaluateWithDump, with the dataflow given as num_directives binary records
+extern "C" __attribute__((visibility("default")))
+char const * evaluateWithDumpBinary(
+  uint64_t * shape,
+  char const * layer_type,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflow,
+  uint64_t num_directives,
+  uint64_t search_permutations,
+  char const * logfile
+)
+{
+  Cost<true> best_cost = evaluateBinaryHelper<true>(shape, layer_type, num_pes, num_simd_lanes, bit_width, bandwidth, num_levels,
+    buf_sizes, num_sub_clusters, dataflow, num_directives, search_permutations, logfile);
+  return dumpCost(best_cost);
+}
+
+// Same as evaluateWithDumpBinary, but writes every metric into the caller's metrics buffer of
+// getNumMetrics() doubles, indexed by maestro::MetricType, instead of returning a JSON string.
+// Returns whether the point is valid.
+extern "C" __attribute__((visibility("default")))
+uint64_t evaluateWithDumpBinaryInto(
+  uint64_t * shape,
+  char const * layer_type,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflow,
+  uint64_t num_directives,
+  uint64_t search_permutations,
+  char const * logfile,
+  double * metrics
+)
+{
+  Cost<true> best_cost = evaluateBinaryHelper<true>(shape, layer_type, num_pes, num_simd_lanes, bit_width, bandwidth, num_levels,
+    buf_sizes, num_sub_clusters, dataflow, num_directives, search_permutations, logfile);
+  packMetrics(best_cost, metrics);
+  return best_cost.valid;
+}
+
+extern "C" __attribute__((visibility("default")))
+double * evaluate(
+  uint64_t * shape,
+  char const * layer_type,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  char const * dataflow,
+  uint64_t search_permutations,
+  char const * logfile
+)
+{
+  DataflowT dataflow_parsed;
+  Cost<false> best_cost{};
+  if(parseDataflow(std::string_view{dataflow}, num_sub_clusters, dataflow_parsed)) {
+    best_cost = evaluateHelper<false>(
+      shape,
+      std::string{layer_type},
+      num_pes,
+      num_simd_lanes,
+      bit_width,
+      bandwidth,
+      num_levels,
+      buf_sizes,
+      num_sub_clusters,
+      dataflow_parsed,
+      search_permutations,
+      std::string{logfile}
+    );
+  }
 
   double * ret = new double[5];
-  if(best_cost.valid) {
-    ret[0] = best_cost.delay;
-    ret[1] = best_cost.energy;
-    ret[2] = best_cost.area;
-    ret[3] = best_cost.power;
-    ret[4] = best_cost.throughput;
+  packCost(best_cost, ret);
+  return ret;
+}
+
+// Same as evaluate, with the dataflow given as num_directives binary records
+extern "C" __attribute__((visibility("default")))
+double * evaluateBinary(
+  uint64_t * shape,
+  char const * layer_type,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflow,
+  uint64_t num_directives,
+  uint64_t search_permutations,
+  char const * logfile
+)
+{
+  Cost<false> best_cost = evaluateBinaryHelper<false>(shape, layer_type, num_pes, num_simd_lanes, bit_width, bandwidth, num_levels,
+    buf_sizes, num_sub_clusters, dataflow, num_directives, search_permutations, logfile);
+
+  double * ret = new double[5];
+  packCost(best_cost, ret);
+  return ret;
+}
+
+// Same as evaluateBinary, but writes the 5 costs into the caller's costs buffer instead of
+// returning a new array. Returns whether the point is valid.
+extern "C" __attribute__((visibility("default")))
+uint64_t evaluateBinaryInto(
+  uint64_t * shape,
+  char const * layer_type,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflow,
+  uint64_t num_directives,
+  uint64_t search_permutations,
+  char const * logfile,
+  double * costs
+)
+{
+  Cost<false> best_cost = evaluateBinaryHelper<false>(shape, layer_type, num_pes, num_simd_lanes, bit_width, bandwidth, num_levels,
+    buf_sizes, num_sub_clusters, dataflow, num_directives, search_permutations, logfile);
+  packCost(best_cost, costs);
+  return best_cost.valid;
+}
+
+// Results returned by evaluate(Binary) and evaluateWithDump(Binary) are owned by the caller and
+// must be released with these.
+extern "C" __attribute__((visibility("default")))
+void freeCosts(double * costs)
+{
+  delete[] costs;
+}
+
+extern "C" __attribute__((visibility("default")))
+void freeDump(char const * dump)
+{
+  delete[] dump;
+}
+
+// Size of the metrics buffers taken by the *Into dump entry points
+extern "C" __attribute__((visibility("default")))
+uint64_t getNumMetrics(void)
+{
+  return num_metrics;
+}
+
+// Name of the metric at index metric of a metrics buffer, e.g. "ExactRunTime"
+extern "C" __attribute__((visibility("default")))
+char const * getMetricName(uint64_t metric)
+{
+  return MetricTypeName(static_cast<maestro::MetricType>(metric));
+}
+
+// Shared body of the batch entry points; decode(i, dataflow) fills in the dataflow of point i and
+// returns false if it is malformed, which leaves the point invalid without evaluating it. Without
+// search_permutations, the points go through runBatch together; otherwise each point searches
+// its own loop orders like evaluateBinaryInto, and the points are evaluated concurrently.
+template<typename DecodeF>
+static uint64_t evaluateBatchHelper(
+  uint64_t num_points,
+  uint64_t * shapes,
+  char const * layer_type,
+  uint64_t * num_pes,
+  uint64_t * num_simd_lanes,
+  uint64_t * bit_widths,
+  uint64_t * bandwidths,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  DecodeF decode,
+  uint64_t search_permutations,
+  char const * logfile,
+  double * costs
+)
+{
+  maestro::InitializeBaseObjects(0);
+
+  // Only the points that decode are batched, in order; batch_of maps them back
+  std::vector<ShapeT> shape_batch;
+  std::vector<Point> space_batch;
+  std::vector<uint64_t> batch_of(num_points, num_points);
+  shape_batch.reserve(num_points);
+  space_batch.reserve(num_points);
+
+  for(uint64_t i = 0; i < num_points; ++i) {
+    Point point;
+    point.num_pes = num_pes[i];
+    point.num_simd_lanes = num_simd_lanes[i];
+    point.l1_size = buf_sizes[i * num_levels];
+    point.l2_size = buf_sizes[i * num_levels + 1];
+    point.bit_width = bit_widths[i];
+    point.bw = bandwidths[i];
+    point.latency = 1;
+
+    if(! decode(i, point.dataflow)) { continue; }
+    batch_of[i] = space_batch.size();
+    space_batch.push_back(std::move(point));
+    shape_batch.push_back(parseShape(shapes + i * 14));
+  }
+
+  std::vector<Cost<false>> cost_batch(space_batch.size());
+  std::string const layer_type_str{layer_type};
+  std::string const logfile_str{logfile};
+  if(search_permutations) {
+    auto evaluate_one = [&](uint64_t i) {
+      if(batch_of[i] == num_points) { return; }
+      cost_batch[batch_of[i]] = evaluateHelper<false>(shapes + i * 14, layer_type_str, num_pes[i], num_simd_lanes[i], bit_widths[i],
+        bandwidths[i], num_levels, buf_sizes + i * num_levels, num_sub_clusters + i * num_levels, space_batch[batch_of[i]].dataflow,
+        search_permutations, logfile_str);
+    };
+#ifdef MULTICORE
+    Executor::instance().parallelFor(num_points, evaluate_one);
+#else
+    for(uint64_t i = 0; i < num_points; ++i) { evaluate_one(i); }
+#endif
   } else {
-    ret[0] = 0;
-    ret[1] = 0;
-    ret[2] = 0;
-    ret[3] = 0;
-    ret[4] = 0;
+    std::ofstream result_file;
+    Point best_point;
+    Cost<false> best_cost{};
+    runBatch(space_batch.size(), shape_batch, layer_type_str, space_batch, cost_batch, result_file, best_point, best_cost, logfile_str);
   }
-  return ret;
+
+  uint64_t num_valid = 0;
+  for(uint64_t i = 0; i < num_points; ++i) {
+    Cost<false> cost = batch_of[i] < num_points ? cost_batch[batch_of[i]] : Cost<false>{};
+    packCost(cost, costs + i * 5);
+    num_valid += cost.valid;
+  }
+  return num_valid;
+}
+
+// Evaluates num_points independent design points in one call. Per-point inputs are laid out
+// contiguously: shapes is num_points x 14, buf_sizes and num_sub_clusters are
+// num_points x num_levels, and the dataflow strings are packed back to back in dataflows with
+// point i occupying [dataflow_offsets[i], dataflow_offsets[i+1]). search_permutations is taken
+// like in evaluate(), and costs receives num_points x 5 values in the same order as evaluate().
+// Malformed dataflows leave their points invalid. Returns the number of valid points.
+extern "C" __attribute__((visibility("default")))
+uint64_t evaluateBatch(
+  uint64_t num_points,
+  uint64_t * shapes,
+  char const * layer_type,
+  uint64_t * num_pes,
+  uint64_t * num_simd_lanes,
+  uint64_t * bit_widths,
+  uint64_t * bandwidths,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  char const * dataflows,
+  uint64_t * dataflow_offsets,
+  uint64_t search_permutations,
+  char const * logfile,
+  double * costs
+)
+{
+  return evaluateBatchHelper(num_points, shapes, layer_type, num_pes, num_simd_lanes, bit_widths, bandwidths, num_levels, buf_sizes,
+    num_sub_clusters, [&](uint64_t i, DataflowT & dataflow) {
+      std::string_view dataflow_str{dataflows + dataflow_offsets[i], dataflow_offsets[i + 1] - dataflow_offsets[i]};
+      return parseDataflow(dataflow_str, num_sub_clusters + i * num_levels, dataflow);
+    },
+    search_permutations, logfile, costs);
+}
+
+// Same as evaluateBatch, with the dataflows given as binary records packed back to back: point i
+// owns records [dataflow_offsets[i], dataflow_offsets[i+1]), counted in records rather than words.
+extern "C" __attribute__((visibility("default")))
+uint64_t evaluateBatchBinary(
+  uint64_t num_points,
+  uint64_t * shapes,
+  char const * layer_type,
+  uint64_t * num_pes,
+  uint64_t * num_simd_lanes,
+  uint64_t * bit_widths,
+  uint64_t * bandwidths,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflows,
+  uint64_t * dataflow_offsets,
+  uint64_t search_permutations,
+  char const * logfile,
+  double * costs
+)
+{
+  return evaluateBatchHelper(num_points, shapes, layer_type, num_pes, num_simd_lanes, bit_widths, bandwidths, num_levels, buf_sizes,
+    num_sub_clusters, [&](uint64_t i, DataflowT & dataflow) {
+      uint64_t const * records = dataflows + dataflow_offsets[i] * directive_record_size;
+      return decodeDataflow(records, dataflow_offsets[i + 1] - dataflow_offsets[i], num_sub_clusters + i * num_levels, num_levels, dataflow);
+    },
+    search_permutations, logfile, costs);
+}
+
+// Evaluates every layer of a model on one hardware point in one call, running the layers
+// concurrently. shapes is num_layers x 14, and the layers' binary dataflows are packed back to
+// back like in evaluateBatchBinary. The hardware inputs are shared by all layers and taken like
+// those of evaluateBinaryInto, as is search_permutations, so each layer gets the cost that
+// evaluateBinaryInto would give it. Layers with the same shape and dataflow are only evaluated
+// once. costs receives num_layers x 5 values in the same order as evaluate(); callers aggregate
+// them into model totals, so that layers searched apart can be combined. Returns the number of
+// valid layers.
+extern "C" __attribute__((visibility("default")))
+uint64_t evaluateModel(
+  uint64_t num_layers,
+  uint64_t * shapes,
+  char const * layer_type,
+  uint64_t num_pes,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflows,
+  uint64_t * dataflow_offsets,
+  uint64_t search_permutations,
+  char const * logfile,
+  double * costs
+)
+{
+  std::string const layer_type_str{layer_type};
+  std::string const logfile_str{logfile};
+
+  // Repeated layers share the key of the cost cache, which covers the shape, dataflow and
+  // hardware, so that each distinct one is evaluated once
+  auto key_hash = [](Hash128 const & key) { return static_cast<size_t>(key.hi); };
+  std::unordered_map<Hash128, uint64_t, decltype(key_hash)> unique_index(num_layers, key_hash);
+  std::vector<uint64_t> unique_of(num_layers);
+  std::vector<uint64_t> unique_layers;
+  std::vector<DataflowT> unique_dataflows;
+  std::vector<bool> unique_decoded;
+
+  Point point;
+  point.num_pes = num_pes;
+  point.num_simd_lanes = num_simd_lanes;
+  point.l1_size = buf_sizes[0];
+  point.l2_size = buf_sizes[1];
+  point.bit_width = bit_width;
+  point.bw = bandwidth;
+  point.latency = 1;
+
+  for(uint64_t i = 0; i < num_layers; ++i) {
+    uint64_t const * records = dataflows + dataflow_offsets[i] * directive_record_size;
+    point.dataflow.clear();
+    if(! decodeDataflow(records, dataflow_offsets[i + 1] - dataflow_offsets[i], num_sub_clusters, num_levels, point.dataflow)) {
+      // A malformed layer stays invalid on its own, without a key to share
+      unique_of[i] = unique_layers.size();
+      unique_layers.push_back(i);
+      unique_dataflows.emplace_back();
+      unique_decoded.push_back(false);
+      continue;
+    }
+
+    auto [it, inserted] = unique_index.emplace(hashDesignPoint(parseShape(shapes + i * 14), layer_type_str, point), unique_layers.size());
+    if(inserted) {
+      unique_layers.push_back(i);
+      unique_dataflows.push_back(point.dataflow);
+      unique_decoded.push_back(true);
+    }
+    unique_of[i] = it->second;
+  }
+
+  std::vector<Cost<false>> unique_costs(unique_layers.size());
+  auto evaluate_one = [&](uint64_t u) {
+    if(! unique_decoded[u]) { return; }
+    unique_costs[u] = evaluateHelper<false>(shapes + unique_layers[u] * 14, layer_type_str, num_pes, num_simd_lanes, bit_width,
+      bandwidth, num_levels, buf_sizes, num_sub_clusters, unique_dataflows[u], search_permutations, logfile_str);
+  };
+#ifdef MULTICORE
+  Executor::instance().parallelFor(unique_layers.size(), evaluate_one);
+#else
+  for(uint64_t u = 0; u < unique_layers.size(); ++u) { evaluate_one(u); }
+#endif
+
+  uint64_t num_valid = 0;
+  for(uint64_t i = 0; i < num_layers; ++i) {
+    Cost<false> const & cost = unique_costs[unique_of[i]];
+    packCost(cost, costs + i * 5);
+    num_valid += cost.valid;
+  }
+  return num_valid;
+}
+
+// Number of values per point written by checkConstraintsBatch: the input, weight and output
+// footprint of every level, then the area, the power and whether the tiles are nested.
+extern "C" __attribute__((visibility("default")))
+uint64_t getNumConstraints(uint64_t num_levels)
+{
+  return num_levels * constraints::num_tensors + 3;
+}
+
+// Checks num_points design points without analyzing them, see spotlight-constraints.hpp. Inputs
+// are laid out like those of evaluateBatchBinary. usage receives num_points x
+// getNumConstraints(num_levels) values: footprints over buffer sizes, the lower bounds on the
+// area and power over max_area and max_power, and 1 if the tiles are nested or 0 otherwise.
+// feasible receives 1 for the points that may pass, i.e. whose bounds are within budget and, if
+// enforce_footprints is set, whose tiles are nested and footprints at most twice their buffers.
+// Only a subset of the points that fail after evaluation is rejected here, so feasible points
+// may still fail. Returns the number of feasible points.
+extern "C" __attribute__((visibility("default")))
+uint64_t checkConstraintsBatch(
+  uint64_t num_points,
+  uint64_t * shapes,
+  uint64_t * num_pes,
+  uint64_t * num_simd_lanes,
+  uint64_t * bit_widths,
+  uint64_t * bandwidths,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t * dataflows,
+  uint64_t * dataflow_offsets,
+  double max_area,
+  double max_power,
+  uint64_t enforce_footprints,
+  double * usage,
+  uint64_t * feasible
+)
+{
+  ConstraintLimits limits;
+  limits.max_area = max_area;
+  limits.max_power = max_power;
+  limits.enforce_footprints = enforce_footprints;
+
+  uint64_t num_constraints = getNumConstraints(num_levels);
+  uint64_t num_feasible = 0;
+  DataflowT dataflow;
+  for(uint64_t i = 0; i < num_points; ++i) {
+    dataflow.clear();
+    uint64_t const * records = dataflows + dataflow_offsets[i] * directive_record_size;
+    if(! decodeDataflow(records, dataflow_offsets[i + 1] - dataflow_offsets[i], num_sub_clusters + i * num_levels, num_levels, dataflow)) {
+      // Malformed points use up every budget and are never feasible
+      double * row = usage + i * num_constraints;
+      std::fill(row, row + num_constraints - 1, std::numeric_limits<double>::infinity());
+      row[num_constraints - 1] = 0;
+      feasible[i] = 0;
+      continue;
+    }
+
+    ConstraintUsage point_usage = checkConstraints(parseShape(shapes + i * 14), num_pes[i], num_simd_lanes[i], bit_widths[i],
+      bandwidths[i], num_levels, buf_sizes + i * num_levels, num_sub_clusters + i * num_levels, dataflow, limits);
+
+    double * row = std::copy(point_usage.footprints.begin(), point_usage.footprints.end(), usage + i * num_constraints);
+    row[0] = point_usage.area;
+    row[1] = point_usage.power;
+    row[2] = point_usage.tiles_nested;
+    feasible[i] = point_usage.feasible;
+    num_feasible += point_usage.feasible;
+  }
+  return num_feasible;
+}
+
+// Genetic search over the tile sizes and spatial dimensions of the "searched" dataflow of one
+// layer on one hardware point; see spotlight-ga.hpp. The hardware arguments are those of
+// evaluate, with buf_sizes and num_sub_clusters ordered like the cluster levels of the dataflow,
+// and every individual is evaluated like evaluate would with search_permutations. target is 0
+// to minimize the energy-delay product and 1 to minimize the delay, and individuals whose area
+// or power exceed max_area or max_power are invalid. Up to num_elites of the best individuals
+// are written best first: elite_genomes receives their tile factors, num_levels + 1 per
+// dimension innermost first in K, C, N, X, Y, R, S order, then the dimension id of each spatial
+// gene innermost first, and elite_costs receives their 5 costs. stats receives the number of
+// generations, valid and invalid individuals, and of the invalid ones those rejected by MAESTRO,
+// for their area and for their power. Returns the number of elites written; the search gave up
+// after max_invalid invalid individuals if fewer than num_trials of them were valid.
+extern "C" __attribute__((visibility("default")))
+uint64_t runGeneticSearch(
+  uint64_t * shape,
+  char const * layer_type,
+  uint64_t num_simd_lanes,
+  uint64_t bit_width,
+  uint64_t bandwidth,
+  uint64_t num_levels,
+  uint64_t * buf_sizes,
+  uint64_t * num_sub_clusters,
+  uint64_t search_permutations,
+  uint64_t target,
+  double max_area,
+  double max_power,
+  uint64_t population,
+  uint64_t num_trials,
+  uint64_t max_invalid,
+  uint64_t seed,
+  char const * logfile,
+  uint64_t num_elites,
+  uint64_t * elite_genomes,
+  double * elite_costs,
+  uint64_t * stats
+)
+{
+  maestro::InitializeBaseObjects(0);
+
+  GeneticOptions options;
+  options.population = population;
+  options.num_trials = num_trials;
+  options.max_invalid = max_invalid;
+  options.delay_only = target == 1;
+  options.max_area = max_area;
+  options.max_power = max_power;
+  options.seed = seed;
+
+  uint64_t num_pes = std::accumulate(num_sub_clusters, num_sub_clusters + num_levels, uint64_t{1}, std::multiplies<uint64_t>());
+  HardwareBounds bounds = hardwareBounds(num_pes, num_simd_lanes, bit_width, bandwidth);
+  options.min_area = bounds.area;
+  options.min_power = bounds.power;
+  std::string layer_type_str{layer_type};
+  std::string logfile_str{logfile};
+
+  SoftwareSpace space(parseShape(shape), num_levels);
+  GeneticStats genetic_stats;
+  std::vector<GeneticElite> elites = runGeneticSearch(space, num_sub_clusters, options, num_elites,
+    [&](DataflowT const & dataflow) {
+      return evaluateHelper<false>(shape, layer_type_str, num_pes, num_simd_lanes, bit_width, bandwidth, num_levels,
+        buf_sizes, num_sub_clusters, dataflow, search_permutations, logfile_str);
+    },
+    genetic_stats);
+
+  uint64_t genome_size = genetic_search::tile_dims.size() * (num_levels + 1) + num_levels;
+  for(uint64_t i = 0; i < elites.size(); ++i) {
+    uint64_t * genome = elite_genomes + i * genome_size;
+    for(uint64_t gene = 0; gene < genetic_search::tile_dims.size(); ++gene) {
+      auto const & factors = space.factors(gene, elites[i].genome[gene]);
+      genome = std::copy(factors.begin(), factors.end(), genome);
+    }
+    for(uint64_t level = 0; level < num_levels; ++level) {
+      std::string dim(1, SoftwareSpace::spatialDim(elites[i].genome[genetic_search::tile_dims.size() + level]));
+      *genome++ = std::find(directive_dimensions.begin(), directive_dimensions.end(), dim) - directive_dimensions.begin();
+    }
+    packCost(elites[i].cost, elite_costs + i * 5);
+  }
+
+  stats[0] = genetic_stats.num_generations;
+  stats[1] = genetic_stats.num_valid;
+  stats[2] = genetic_stats.num_invalid;
+  stats[3] = genetic_stats.num_maestro_failures;
+  stats[4] = genetic_stats.num_area_failures;
+  stats[5] = genetic_stats.num_power_failures;
+  return elites.size();
+}
+
+// Fills stats with the result cache's hits, misses, number of entries and capacity,
+// summed over the full and summary cost caches.
+extern "C" __attribute__((visibility("default")))
+void getCacheStats(uint64_t * stats)
+{
+  auto small = resultCache<false>().stats();
+  auto full = resultCache<true>().stats();
+  stats[0] = small.hits + full.hits;
+  stats[1] = small.misses + full.misses;
+  stats[2] = small.size + full.size;
+  stats[3] = small.capacity + full.capacity;
+}
+
+extern "C" __attribute__((visibility("default")))
+void clearCache(void)
+{
+  resultCache<false>().clear();
+  resultCache<true>().clear();
 }
 
 #ifdef _WITH_MAIN
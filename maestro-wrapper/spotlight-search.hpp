@@ -0,0 +1,202 @@
+#ifndef _SPOTLIGHT_SEARCH_HPP
+#define _SPOTLIGHT_SEARCH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "spotlight-common.hpp"
+
+// Exhaustive search for the loop order of every cluster level of a dataflow.
+//
+// Two properties of the cost model keep the search far below the product of every level's n!
+// evaluations. The search returns the order with the best fitness only as long as both hold;
+// builds with EXHAUSTIVE_PERMUTATIONS compare it against every order to check them:
+//  - A temporal map of a dimension with extent 1 at its level runs once and moves no data, so its
+//    position in the level does not change the cost. Only the other directives of a level are
+//    permuted, with these kept innermost. Maps that cover a larger extent in one step still
+//    change the reuse of the maps around them and are permuted like any other.
+//  - Energy, area and power only depend on the order of the outermost level, and the inner
+//    levels only change the delay through the runtime of a sub-cluster, which it grows with.
+//    The energy of an outer order times its delay with compute-bound sub-clusters (min_delay)
+//    is thus a lower bound on the fitness of every order of the inner levels below it.
+// The search first evaluates every outer order with the given inner orders, then every inner
+// order with the best outer order. The remaining outer orders are visited by increasing bound,
+// each with every inner order from best to worst, until the bound reaches the best fitness.
+struct LoopOrderStats
+{
+  uint64_t num_orders = 1;     // Product of every level's n!
+  uint64_t num_classes = 1;    // Orders left once equivalent ones are collapsed
+  uint64_t num_evaluated = 0;
+};
+
+namespace loop_order_search {
+
+// The directives of one cluster level start at begin; orders holds the dataflow index of each
+// directive of the level for every distinct order.
+struct Level
+{
+  uint64_t begin;
+  std::vector<std::vector<uint64_t>> orders;
+};
+
+inline std::vector<Level> buildLevels(ShapeT const & shape, DataflowT const & dataflow, LoopOrderStats & stats)
+{
+  // Extent of each dimension at the current level; primed dimensions are never fixed
+  std::unordered_map<std::string, uint64_t> extents;
+  for(auto const & dim : shape) { extents[std::string(1, dim.first)] = dim.second.first; }
+
+  std::vector<Level> levels;
+  uint64_t begin = 0;
+  while(true) {
+    uint64_t end = begin;
+    while(end < dataflow.size() && std::get<0>(dataflow[end]) != 'C') { ++end; }
+
+    std::vector<uint64_t> permuted, fixed;
+    for(uint64_t i = begin; i < end; ++i) {
+      auto extent = extents.find(std::get<2>(dataflow[i]));
+      if(std::get<0>(dataflow[i]) == 'T' && extent != extents.end() && extent->second == 1) { fixed.push_back(i); }
+      else { permuted.push_back(i); }
+    }
+
+    Level level;
+    level.begin = begin;
+    do {
+      level.orders.push_back(permuted);
+      level.orders.back().insert(level.orders.back().end(), fixed.begin(), fixed.end());
+    } while(std::next_permutation(permuted.begin(), permuted.end()));
+
+    for(uint64_t i = 2; i <= end - begin; ++i) { stats.num_orders *= i; }
+    stats.num_classes *= level.orders.size();
+    levels.push_back(std::move(level));
+
+    if(end == dataflow.size()) { break; }
+
+    // A sub-cluster sees the tile of its parent
+    for(uint64_t i = begin; i < end; ++i) {
+      auto extent = extents.find(std::get<2>(dataflow[i]));
+      if(extent != extents.end()) { extent->second = std::min(extent->second, std::get<1>(dataflow[i])); }
+    }
+    begin = end + 1;
+  }
+
+  return levels;
+}
+
+// A candidate is an order of the outermost level and a combination of orders of the inner
+// levels, numbered with the innermost level varying fastest
+using Candidate = std::pair<uint64_t, uint64_t>;
+
+inline Point applyOrders(Point const & point, std::vector<Level> const & levels, Candidate const & candidate)
+{
+  Point ret = point;
+  auto apply = [&](Level const & level, uint64_t idx) {
+    auto const & order = level.orders[idx];
+    for(uint64_t i = 0; i < order.size(); ++i) { ret.dataflow[level.begin + i] = point.dataflow[order[i]]; }
+  };
+
+  apply(levels[0], candidate.first);
+  uint64_t inner = candidate.second;
+  for(uint64_t level = levels.size() - 1; level > 0; --level) {
+    apply(levels[level], inner % levels[level].orders.size());
+    inner /= levels[level].orders.size();
+  }
+  return ret;
+}
+
+}  // namespace loop_order_search
+
+inline Cost<false> searchLoopOrders(
+  ShapeT const & shape,
+  std::string const & layer_type,
+  Point const & point,
+  Point & best_point,
+  LoopOrderStats & stats,
+  std::string const & logfile
+)
+{
+  using namespace loop_order_search;
+
+  // Number of candidates evaluated at once once pruning starts; the best fitness used to prune
+  // is only updated between batches
+  static constexpr uint64_t batch_size = 256;
+
+  std::vector<Level> levels = buildLevels(shape, point.dataflow, stats);
+  uint64_t num_outer = levels[0].orders.size();
+  uint64_t num_inner = stats.num_classes / num_outer;
+
+  Cost<false> best_cost;
+  best_point = point;
+  auto evaluate = [&](std::vector<Candidate> const & candidates) {
+    std::vector<Point> points(candidates.size());
+    std::vector<Cost<false>> costs(candidates.size());
+    auto evaluate_one = [&](uint64_t i) {
+      points[i] = applyOrders(point, levels, candidates[i]);
+      costs[i] = runWrapper<false>(0, shape, layer_type, points[i], logfile);
+    };
+#ifdef MULTICORE
+    Executor::instance().parallelFor(candidates.size(), evaluate_one);
+#else
+    for(uint64_t i = 0; i < candidates.size(); ++i) { evaluate_one(i); }
+#endif
+
+    for(uint64_t i = 0; i < candidates.size(); ++i) {
+      if(costs[i] < best_cost) {
+        best_cost = costs[i];
+        best_point = points[i];
+      }
+    }
+    stats.num_evaluated += candidates.size();
+    return costs;
+  };
+
+  // Every outer order with the first inner orders, which are the given ones less collapsed loops
+  std::vector<Candidate> candidates;
+  for(uint64_t outer = 0; outer < num_outer; ++outer) { candidates.emplace_back(outer, 0); }
+  std::vector<Cost<false>> outer_costs = evaluate(candidates);
+
+  // Nothing is known about an outer order whose first evaluation is invalid, so it is never pruned
+  std::vector<double> bounds(num_outer, 0);
+  uint64_t best_outer = 0;
+  for(uint64_t outer = 0; outer < num_outer; ++outer) {
+    if(outer_costs[outer].valid) { bounds[outer] = outer_costs[outer].energy * outer_costs[outer].min_delay; }
+    if(outer_costs[outer] < outer_costs[best_outer]) { best_outer = outer; }
+  }
+
+  // Every inner order with the best outer order, to rank them for the other outer orders
+  candidates.clear();
+  for(uint64_t inner = 1; inner < num_inner; ++inner) { candidates.emplace_back(best_outer, inner); }
+  std::vector<Cost<false>> inner_costs = evaluate(candidates);
+  inner_costs.insert(inner_costs.begin(), outer_costs[best_outer]);
+
+  std::vector<uint64_t> inner_ranks(num_inner - 1);
+  std::iota(inner_ranks.begin(), inner_ranks.end(), 1);
+  std::stable_sort(inner_ranks.begin(), inner_ranks.end(),
+    [&](uint64_t a, uint64_t b) { return inner_costs[a] < inner_costs[b]; });
+
+  std::vector<uint64_t> outer_ranks(num_outer);
+  std::iota(outer_ranks.begin(), outer_ranks.end(), 0);
+  std::stable_sort(outer_ranks.begin(), outer_ranks.end(),
+    [&](uint64_t a, uint64_t b) { return bounds[a] < bounds[b]; });
+
+  candidates.clear();
+  for(uint64_t outer : outer_ranks) {
+    if(outer == best_outer) { continue; }
+    if(best_cost.valid && bounds[outer] >= best_cost.getFitness()) { break; }
+
+    for(uint64_t inner : inner_ranks) { candidates.emplace_back(outer, inner); }
+    if(candidates.size() >= batch_size) {
+      evaluate(candidates);
+      candidates.clear();
+    }
+  }
+  evaluate(candidates);
+
+  return best_cost;
+}
+
+#endif
@@ -0,0 +1,662 @@
+#ifndef _SPOTLIGHT_SWEEP_HPP
+#define _SPOTLIGHT_SWEEP_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "spotlight-common.hpp"
+
+constexpr uint64_t fact(uint64_t n) {
+  uint64_t ret = 1;
+  for(uint64_t i = 2; i <= n; ++i) {
+    ret *= i;
+  }
+  return ret;
+}
+
+// Orders of the two cluster levels around cluster_pos, numbered like nested std::next_permutation
+// loops over the upper and then the lower level. Any range of the space is generated directly,
+// without enumerating the orders before it.
+class PermutationSpace
+{
+public:
+  PermutationSpace(Point const & point, uint64_t cluster_pos)
+    : point_(point), cluster_pos_(cluster_pos), num_high_(cluster_pos), num_low_(point.dataflow.size() - cluster_pos - 1)
+  {}
+
+  uint64_t size(void) const { return fact(num_high_) * fact(num_low_); }
+
+  Point const & base(void) const { return point_; }
+
+  // Writes the points [begin, begin + count) of the space to the front of points
+  void generate(uint64_t begin, uint64_t count, std::vector<Point> & points) const
+  {
+    std::vector<uint64_t> high_indices = unrank(begin / fact(num_low_), num_high_);
+    std::vector<uint64_t> low_indices = unrank(begin % fact(num_low_), num_low_);
+
+    for(uint64_t i = 0; i < count; ++i) {
+      Point & copy = points[i];
+      copy = point_;
+      for(uint64_t j = 0; j < num_high_; ++j) { copy.dataflow[j] = point_.dataflow[high_indices[j]]; }
+      for(uint64_t j = 0; j < num_low_; ++j) { copy.dataflow[cluster_pos_+1+j] = point_.dataflow[cluster_pos_+1+low_indices[j]]; }
+
+      if(! std::next_permutation(low_indices.begin(), low_indices.end())) {
+        std::next_permutation(high_indices.begin(), high_indices.end());
+      }
+    }
+  }
+
+  Point at(uint64_t id) const
+  {
+    std::vector<Point> ret(1);
+    generate(id, 1, ret);
+    return ret[0];
+  }
+
+private:
+  // The rank-th permutation of 0, ..., n - 1 in lexicographic order
+  static std::vector<uint64_t> unrank(uint64_t rank, uint64_t n)
+  {
+    std::vector<uint64_t> remaining(n);
+    std::iota(remaining.begin(), remaining.end(), 0);
+
+    std::vector<uint64_t> ret;
+    for(uint64_t i = n; i > 0; --i) {
+      uint64_t idx = rank / fact(i - 1);
+      rank %= fact(i - 1);
+      ret.push_back(remaining[idx]);
+      remaining.erase(remaining.begin() + idx);
+    }
+    return ret;
+  }
+
+  Point const & point_;
+  uint64_t cluster_pos_;
+  uint64_t num_high_;
+  uint64_t num_low_;
+};
+
+// The k best valid points seen so far, kept in a heap with the worst of them on top. Of equally
+// good points, the ones with the lowest order, e.g. their index in the space, are kept.
+template<typename T>
+class TopK
+{
+public:
+  struct Entry
+  {
+    Cost<false> cost;
+    uint64_t order;
+    T value;
+  };
+
+  explicit TopK(uint64_t k) : k_(k) {}
+
+  uint64_t capacity(void) const { return k_; }
+
+  void add(Cost<false> const & cost, T const & value, uint64_t order)
+  {
+    if(! cost.valid || k_ == 0) { return; }
+    Entry entry{cost, order, value};
+    if(entries_.size() < k_) {
+      entries_.push_back(std::move(entry));
+      std::push_heap(entries_.begin(), entries_.end(), compare);
+    } else if(compare(entry, entries_.front())) {
+      std::pop_heap(entries_.begin(), entries_.end(), compare);
+      entries_.back() = std::move(entry);
+      std::push_heap(entries_.begin(), entries_.end(), compare);
+    }
+  }
+
+  // Best first
+  std::vector<Entry> sorted(void) const
+  {
+    std::vector<Entry> ret = entries_;
+    std::sort_heap(ret.begin(), ret.end(), compare);
+    return ret;
+  }
+
+private:
+  static bool compare(Entry const & a, Entry const & b)
+  {
+    return a.cost < b.cost || (a.cost == b.cost && a.order < b.order);
+  }
+
+  uint64_t k_;
+  std::vector<Entry> entries_;
+};
+
+// Valid points that no other point beats in both delay and energy. Of points with equal delay
+// and energy, the one with the lowest order is kept.
+template<typename T>
+class ParetoFront
+{
+public:
+  struct Entry
+  {
+    Cost<false> cost;
+    uint64_t order;
+    T value;
+  };
+
+  void add(Cost<false> const & cost, T const & value, uint64_t order)
+  {
+    if(! cost.valid) { return; }
+    for(auto const & entry : entries_) {
+      if(entry.cost.delay <= cost.delay && entry.cost.energy <= cost.energy) {
+        bool tie = entry.cost.delay == cost.delay && entry.cost.energy == cost.energy;
+        if(! tie || entry.order < order) { return; }
+      }
+    }
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [&](Entry const & entry) {
+      return cost.delay <= entry.cost.delay && cost.energy <= entry.cost.energy;
+    }), entries_.end());
+    entries_.push_back(Entry{cost, order, value});
+  }
+
+  // By increasing delay
+  std::vector<Entry> sorted(void) const
+  {
+    std::vector<Entry> ret = entries_;
+    std::sort(ret.begin(), ret.end(), [](Entry const & a, Entry const & b) { return a.cost.delay < b.cost.delay; });
+    return ret;
+  }
+
+private:
+  std::vector<Entry> entries_;
+};
+
+// Distributed sweeps of a PermutationSpace.
+//
+// A coordinator listens at an address, either "unix:<path>" or "<host>:<port>", and hands out
+// chunks of the space to the workers that connect to it. It forks its local workers itself;
+// workers on other nodes are started with the same options and the coordinator's address. The
+// protocol is line-based text:
+//   worker:      HELLO <hash of the space>
+//   coordinator: CHUNK <begin> <end>, or DONE
+//   worker:      RESULT <begin> <end> <n>, then n lines of <id> <delay> <energy> <area> <power> <throughput>
+// A result holds the union of the best points and the Pareto front of the chunk, and the worker
+// then waits for its next chunk. Chunks shrink as the space runs out so that the workers finish
+// together. Once every chunk is handed out, idle workers get a copy of the oldest chunk still
+// running elsewhere, and the first result for a chunk wins. Chunks of workers that disconnect go
+// back to the queue. The coordinator never waits on a worker socket: it buffers what each worker
+// sent so far and handles a message only once all of its lines have arrived.
+//
+// Every worker evaluates its chunks on its own Executor. Local workers split the cores of the
+// node between them unless SPOTLIGHT_NUM_THREADS is set; workers started by hand on a node that
+// runs several of them should set it to their share of the cores.
+namespace sweep {
+
+static constexpr uint64_t min_chunk_size = 64;
+static constexpr uint64_t max_chunk_size = 1 << 16;
+
+// Points that a worker builds and evaluates at once
+static constexpr uint64_t batch_size = 1 << 12;
+
+// What the coordinator made of the next message a worker sent
+enum class Message { incomplete, handled, invalid };
+
+class Connection
+{
+public:
+  explicit Connection(int fd) : fd_(fd) {}
+  ~Connection() { close(fd_); }
+
+  Connection(Connection const &) = delete;
+  Connection & operator=(Connection const &) = delete;
+
+  int fd(void) const { return fd_; }
+
+  bool readLine(std::string & line)
+  {
+    while(true) {
+      auto newline = buffer_.find('\n');
+      if(newline != std::string::npos) {
+        line = buffer_.substr(0, newline);
+        buffer_.erase(0, newline + 1);
+        return true;
+      }
+
+      char chunk[4096];
+      ssize_t size = recv(fd_, chunk, sizeof(chunk), 0);
+      if(size <= 0) { return false; }
+      buffer_.append(chunk, size);
+    }
+  }
+
+  // Appends whatever a non-blocking socket has to the buffer. Returns false once the peer is gone,
+  // which leaves the lines it sent before in the buffer.
+  bool receive(void)
+  {
+    while(true) {
+      char chunk[4096];
+      ssize_t size = recv(fd_, chunk, sizeof(chunk), 0);
+      if(size > 0) {
+        buffer_.append(chunk, size);
+      } else if(size < 0 && errno == EINTR) {
+        continue;
+      } else {
+        return size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+      }
+    }
+  }
+
+  // Reads the i-th buffered line without consuming it or waiting on the socket
+  bool peekLine(uint64_t i, std::string & line) const
+  {
+    size_t begin = 0;
+    for(; i > 0; --i) {
+      begin = buffer_.find('\n', begin);
+      if(begin == std::string::npos) { return false; }
+      ++begin;
+    }
+    auto newline = buffer_.find('\n', begin);
+    if(newline == std::string::npos) { return false; }
+    line = buffer_.substr(begin, newline - begin);
+    return true;
+  }
+
+  uint64_t numLines(void) const { return std::count(buffer_.begin(), buffer_.end(), '\n'); }
+
+  bool write(std::string const & data)
+  {
+    size_t offset = 0;
+    while(offset < data.size()) {
+      ssize_t size = send(fd_, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+      if(size <= 0) { return false; }
+      offset += size;
+    }
+    return true;
+  }
+
+private:
+  int fd_;
+  std::string buffer_;
+};
+
+inline bool isUnixAddress(std::string const & address) { return address.compare(0, 5, "unix:") == 0; }
+
+inline sockaddr_un unixAddress(std::string const & address)
+{
+  sockaddr_un ret{};
+  ret.sun_family = AF_UNIX;
+  std::string path = address.substr(5);
+  if(path.size() >= sizeof(ret.sun_path)) { throw std::runtime_error("socket path too long: " + path); }
+  std::strcpy(ret.sun_path, path.c_str());
+  return ret;
+}
+
+inline addrinfo * tcpAddresses(std::string const & address, bool passive)
+{
+  auto colon = address.rfind(':');
+  if(colon == std::string::npos) { throw std::runtime_error("invalid coordinator address: " + address); }
+  std::string host = address.substr(0, colon);
+  std::string port = address.substr(colon + 1);
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = passive ? AI_PASSIVE : 0;
+  addrinfo * ret = nullptr;
+  if(getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &ret) != 0) {
+    throw std::runtime_error("cannot resolve coordinator address: " + address);
+  }
+  return ret;
+}
+
+inline int listenOn(std::string const & address)
+{
+  int fd = -1;
+  if(isUnixAddress(address)) {
+    sockaddr_un addr = unixAddress(address);
+    unlink(addr.sun_path);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd >= 0 && bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) { close(fd); fd = -1; }
+  } else {
+    addrinfo * addrs = tcpAddresses(address, true);
+    for(addrinfo * addr = addrs; addr != nullptr && fd < 0; addr = addr->ai_next) {
+      fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+      int reuse = 1;
+      if(fd >= 0) { setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)); }
+      if(fd >= 0 && bind(fd, addr->ai_addr, addr->ai_addrlen) != 0) { close(fd); fd = -1; }
+    }
+    freeaddrinfo(addrs);
+  }
+
+  if(fd < 0 || listen(fd, SOMAXCONN) != 0) { throw std::runtime_error("cannot listen on " + address); }
+  return fd;
+}
+
+inline int connectTo(std::string const & address)
+{
+  int fd = -1;
+  if(isUnixAddress(address)) {
+    sockaddr_un addr = unixAddress(address);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) { close(fd); fd = -1; }
+  } else {
+    addrinfo * addrs = tcpAddresses(address, false);
+    for(addrinfo * addr = addrs; addr != nullptr && fd < 0; addr = addr->ai_next) {
+      fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+      if(fd >= 0 && connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) { close(fd); fd = -1; }
+    }
+    freeaddrinfo(addrs);
+  }
+
+  if(fd < 0) { throw std::runtime_error("cannot connect to " + address); }
+  return fd;
+}
+
+// Workers and coordinators only talk to each other if they sweep the same space
+inline std::string hello(PermutationSpace const & space, ShapeT const & shape, std::string const & layer_type)
+{
+  Hash128 hash = hashDesignPoint(shape, layer_type, space.base());
+  return "HELLO " + std::to_string(hash.lo) + " " + std::to_string(hash.hi) + " " + std::to_string(space.size()) + "\n";
+}
+
+inline std::string formatCost(uint64_t id, Cost<false> const & cost)
+{
+  char line[256];
+  std::snprintf(line, sizeof(line), "%" PRIu64 " %.17g %.17g %.17g %.17g %.17g\n",
+    id, cost.delay, cost.energy, cost.area, cost.power, cost.throughput);
+  return line;
+}
+
+// Unlike streams, strtod reads back the nan and inf that formatCost may write
+inline bool parseCost(std::string const & line, uint64_t & id, Cost<false> & cost)
+{
+  char const * pos = line.c_str();
+  char * next;
+  errno = 0;
+  id = std::strtoull(pos, &next, 10);
+  if(next == pos || errno != 0) { return false; }
+  for(double * field : {&cost.delay, &cost.energy, &cost.area, &cost.power, &cost.throughput}) {
+    pos = next;
+    *field = std::strtod(pos, &next);
+    if(next == pos) { return false; }
+  }
+  cost.valid = true;
+  return true;
+}
+
+}  // namespace sweep
+
+// Evaluates the chunks handed out by the coordinator at address until it is done, reporting the
+// top_k best points and the Pareto front of each
+inline void runSweepWorker(
+  std::string const & address,
+  PermutationSpace const & space,
+  ShapeT const & shape,
+  std::string const & layer_type,
+  uint64_t top_k
+)
+{
+  using namespace sweep;
+
+  Connection coordinator(connectTo(address));
+  if(! coordinator.write(hello(space, shape, layer_type))) { return; }
+
+  std::vector<Point> points(batch_size);
+  std::vector<Cost<false>> costs(batch_size);
+  std::ofstream result_file;
+  std::string line;
+  while(coordinator.readLine(line)) {
+    uint64_t begin, end;
+    if(std::sscanf(line.c_str(), "CHUNK %" SCNu64 " %" SCNu64, &begin, &end) != 2) { break; }
+
+    TopK<uint64_t> best(top_k);
+    ParetoFront<uint64_t> front;
+    for(uint64_t batch = begin; batch < end; batch += batch_size) {
+      uint64_t count = std::min(batch_size, end - batch);
+      space.generate(batch, count, points);
+      Point best_point;
+      Cost<false> best_cost;
+      runBatch(count, shape, layer_type, points, costs, result_file, best_point, best_cost, "");
+      for(uint64_t i = 0; i < count; ++i) {
+        best.add(costs[i], batch + i, batch + i);
+        front.add(costs[i], batch + i, batch + i);
+      }
+    }
+
+    std::map<uint64_t, Cost<false>> results;
+    for(auto const & entry : best.sorted()) { results[entry.value] = entry.cost; }
+    for(auto const & entry : front.sorted()) { results[entry.value] = entry.cost; }
+
+    std::string result = "RESULT " + std::to_string(begin) + " " + std::to_string(end) + " " + std::to_string(results.size()) + "\n";
+    for(auto const & [id, cost] : results) { result += formatCost(id, cost); }
+    if(! coordinator.write(result)) { break; }
+  }
+}
+
+// Sweeps [begin, end) of space with the workers that connect to address, num_local_workers of
+// which are forked from this process, and merges their best points and Pareto fronts. Must be
+// called before this process starts any threads.
+inline void runSweepCoordinator(
+  std::string const & address,
+  uint64_t num_local_workers,
+  PermutationSpace const & space,
+  uint64_t begin,
+  uint64_t end,
+  ShapeT const & shape,
+  std::string const & layer_type,
+  TopK<uint64_t> & best,
+  ParetoFront<uint64_t> & front
+)
+{
+  using namespace sweep;
+
+  struct Chunk
+  {
+    uint64_t end;
+    uint64_t num_assigned = 0;
+    uint64_t issue = 0;
+    bool done = false;
+  };
+
+  struct Worker
+  {
+    std::unique_ptr<Connection> connection;
+    bool ready = false;
+    bool busy = false;
+    uint64_t chunk = 0;
+  };
+
+  int listen_fd = listenOn(address);
+
+  std::cout.flush();
+  std::vector<pid_t> children;
+  for(uint64_t i = 0; i < num_local_workers; ++i) {
+    pid_t pid = fork();
+    if(pid == 0) {
+      close(listen_fd);
+      // Nothing has started the Executor yet, so it picks this up
+      if(std::getenv("SPOTLIGHT_NUM_THREADS") == nullptr) {
+        uint64_t num_threads = std::max<uint64_t>(1, std::thread::hardware_concurrency() / num_local_workers);
+        setenv("SPOTLIGHT_NUM_THREADS", std::to_string(num_threads).c_str(), 1);
+      }
+      int status = 0;
+      try {
+        runSweepWorker(address, space, shape, layer_type, best.capacity());
+      } catch(std::exception const & e) {
+        std::cerr << "[spotlight] worker failed: " << e.what() << '\n';
+        status = 1;
+      }
+      _exit(status);
+    }
+    if(pid > 0) { children.push_back(pid); }
+  }
+
+  std::map<uint64_t, Chunk> chunks;
+  std::deque<uint64_t> requeued;
+  std::vector<Worker> workers;
+  uint64_t next = begin;
+  uint64_t num_done = 0;
+  uint64_t num_issued = 0;
+  std::string expected_hello = hello(space, shape, layer_type);
+  expected_hello.pop_back();
+
+  // Returns false if the chunk could not be sent
+  auto assign = [&](Worker & worker) {
+    while(! requeued.empty() && chunks[requeued.front()].done) { requeued.pop_front(); }
+
+    uint64_t chunk_begin;
+    if(! requeued.empty()) {
+      chunk_begin = requeued.front();
+      requeued.pop_front();
+    } else if(next < end) {
+      uint64_t num_ready = std::count_if(workers.begin(), workers.end(), [](Worker const & w) { return w.ready; });
+      uint64_t size = std::clamp((end - next) / (4 * std::max<uint64_t>(num_ready, 1)), min_chunk_size, max_chunk_size);
+      chunk_begin = next;
+      next = std::min(end, next + size);
+      chunks[chunk_begin].end = next;
+    } else {
+      // Nothing left to hand out, so help with the oldest chunk that only one worker runs
+      auto straggler = chunks.end();
+      for(auto it = chunks.begin(); it != chunks.end(); ++it) {
+        if(! it->second.done && it->second.num_assigned == 1 && (straggler == chunks.end() || it->second.issue < straggler->second.issue)) {
+          straggler = it;
+        }
+      }
+      if(straggler == chunks.end()) { return true; }
+      chunk_begin = straggler->first;
+    }
+
+    Chunk & chunk = chunks[chunk_begin];
+    ++chunk.num_assigned;
+    chunk.issue = num_issued++;
+    worker.busy = true;
+    worker.chunk = chunk_begin;
+    // The socket does not wait for a worker that stopped reading, so such a worker fails here
+    return worker.connection->write("CHUNK " + std::to_string(chunk_begin) + " " + std::to_string(chunk.end) + "\n");
+  };
+
+  auto release = [&](Worker & worker) {
+    if(! worker.busy) { return; }
+    worker.busy = false;
+    Chunk & chunk = chunks[worker.chunk];
+    --chunk.num_assigned;
+    if(! chunk.done && chunk.num_assigned == 0) { requeued.push_back(worker.chunk); }
+  };
+
+  // Handles the next message of the worker once it is buffered in full, so that a worker that
+  // stops halfway through a message never stalls the others
+  auto handle = [&](Worker & worker) {
+    std::string line;
+    if(! worker.connection->peekLine(0, line)) { return Message::incomplete; }
+
+    if(! worker.ready) {
+      worker.connection->readLine(line);
+      if(line != expected_hello) {
+        std::cerr << "[spotlight] rejected a worker that sweeps a different space\n";
+        worker.connection->write("DONE\n");
+        return Message::invalid;
+      }
+      worker.ready = true;
+      return assign(worker) ? Message::handled : Message::invalid;
+    }
+
+    uint64_t chunk_begin, chunk_end, num_results;
+    if(std::sscanf(line.c_str(), "RESULT %" SCNu64 " %" SCNu64 " %" SCNu64, &chunk_begin, &chunk_end, &num_results) != 3) { return Message::invalid; }
+    auto it = chunks.find(chunk_begin);
+    if(it == chunks.end() || it->second.end != chunk_end) { return Message::invalid; }
+    if(worker.connection->numLines() <= num_results) { return Message::incomplete; }
+    worker.connection->readLine(line);
+    Chunk & chunk = it->second;
+    for(uint64_t i = 0; i < num_results; ++i) {
+      uint64_t id;
+      Cost<false> cost;
+      worker.connection->readLine(line);
+      if(! parseCost(line, id, cost)) { return Message::invalid; }
+      if(! chunk.done) {
+        best.add(cost, id, id);
+        front.add(cost, id, id);
+      }
+    }
+    if(! chunk.done) {
+      chunk.done = true;
+      num_done += chunk.end - chunk_begin;
+    }
+    release(worker);
+    return Message::handled;
+  };
+
+  uint64_t num_exited = 0;
+  while(num_done < end - begin) {
+    // Without remote workers, the sweep cannot finish once every local worker is gone
+    while(num_exited < children.size() && waitpid(-1, nullptr, WNOHANG) > 0) { ++num_exited; }
+    if(num_local_workers > 0 && num_exited == children.size() && workers.empty()) {
+      close(listen_fd);
+      if(isUnixAddress(address)) { unlink(unixAddress(address).sun_path); }
+      throw std::runtime_error("every sweep worker exited before the sweep finished");
+    }
+
+    std::vector<pollfd> fds;
+    fds.push_back(pollfd{listen_fd, POLLIN, 0});
+    for(auto const & worker : workers) { fds.push_back(pollfd{worker.connection->fd(), POLLIN, 0}); }
+    if(poll(fds.data(), fds.size(), children.empty() ? -1 : 1000) < 0) {
+      if(errno == EINTR) { continue; }
+      throw std::runtime_error("coordinator failed to poll its workers");
+    }
+
+    for(uint64_t i = 0; i < workers.size(); ++i) {
+      Worker & worker = workers[i];
+      if(fds[i + 1].revents == 0) { continue; }
+      bool open = worker.connection->receive();
+      Message message = handle(worker);
+      while(message == Message::handled) { message = handle(worker); }
+      if(! open || message == Message::invalid) {
+        release(worker);
+        worker.connection.reset();
+      }
+    }
+    workers.erase(std::remove_if(workers.begin(), workers.end(), [](Worker const & w) { return ! w.connection; }), workers.end());
+
+    if(fds[0].revents & POLLIN) {
+      int fd = accept(listen_fd, nullptr, nullptr);
+      if(fd >= 0 && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+        close(fd);
+      } else if(fd >= 0) {
+        workers.emplace_back();
+        workers.back().connection = std::make_unique<Connection>(fd);
+      }
+    }
+
+    // Chunks given back by failed workers, or stragglers, may be waiting for an idle worker
+    for(auto & worker : workers) {
+      if(worker.ready && ! worker.busy && ! assign(worker)) {
+        release(worker);
+        worker.connection.reset();
+      }
+    }
+    workers.erase(std::remove_if(workers.begin(), workers.end(), [](Worker const & w) { return ! w.connection; }), workers.end());
+  }
+
+  for(auto & worker : workers) { worker.connection->write("DONE\n"); }
+  workers.clear();
+  close(listen_fd);
+  if(isUnixAddress(address)) { unlink(unixAddress(address).sun_path); }
+  while(num_exited < children.size() && waitpid(-1, nullptr, 0) > 0) { ++num_exited; }
+}
+
+#endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <future>
@@ -10,14 +11,8 @@
 #include <vector>
 
 #include "spotlight-common.hpp"
-
-constexpr uint64_t fact(uint64_t n) {
-  uint64_t ret = 1;
-  for(uint64_t i = 2; i <= n; ++i) {
-    ret *= i;
-  }
-  return ret;
-}
+#include "spotlight-search.hpp"
+#include "spotlight-sweep.hpp"
 
 void getShape(maestro::Options const & option, ShapeT & shape);
 void getDataflow(
@@ -61,9 +56,16 @@ int main(int argc, char** argv)
 
   getShape(option, shape);
   getDataflow(option, shape, point, cluster_pos, tile_sweep_pos, tile_sweep_dim);
-  uint64_t space_id = 0;
   uint64_t space_size = 0;
 
+  // Sweep workers only report their best points to the coordinator
+  if(mode == "work") {
+    if(option.coordinator == "") { throw std::runtime_error("work mode requires a coordinator address"); }
+    PermutationSpace space(point, cluster_pos);
+    runSweepWorker(option.coordinator, space, shape, layer_type, std::max<uint64_t>(option.top_k, 1));
+    return 0;
+  }
+
   std::ofstream result_file;
 #ifndef _DEBUG_OUT
   if(option.result_file != "") {
@@ -76,11 +78,42 @@ int main(int argc, char** argv)
   std::vector<Cost<false>> cost_batch;
   Cost<false> best_cost;
   Point best_point;
+  TopK<Point> top_k(option.top_k);
+
+  // Number of points that streaming modes build and evaluate at once
+  static constexpr uint64_t chunk_size = 1 << 12;
 
   std::cout << "Building space...";
 
   auto start = std::chrono::high_resolution_clock::now();
-  if(mode == "tiles") {
+  if(mode == "coordinate") {
+    // The result file holds the Pareto front of the space rather than every point
+    PermutationSpace space(point, cluster_pos);
+    uint64_t space_end = std::min(option.space_id_end, space.size());
+    uint64_t space_begin = std::min(option.space_id_start, space_end);
+    std::string address = option.coordinator;
+    if(address == "") { address = "unix:/tmp/spotlight-" + std::to_string(getpid()) + ".sock"; }
+    std::cout << "sweeping " << space_end - space_begin << " points at " << address << " with " << option.num_workers << " local workers...";
+
+    TopK<uint64_t> best_ids(std::max<uint64_t>(option.top_k, 1));
+    ParetoFront<uint64_t> front;
+    runSweepCoordinator(address, option.num_workers, space, space_begin, space_end, shape, layer_type, best_ids, front);
+
+    for(auto const & entry : best_ids.sorted()) {
+      Point best = space.at(entry.value);
+      if(! best_cost.valid) {
+        best_cost = entry.cost;
+        best_point = best;
+      }
+      top_k.add(entry.cost, best, entry.order);
+    }
+    if(result_file.is_open()) {
+      for(auto const & entry : front.sorted()) {
+        printCost(result_file, entry.cost) << ',' << space.at(entry.value) << '\n';
+      }
+    }
+    space_size = space_end - space_begin;
+  } else if(mode == "tiles") {
     throw std::runtime_error("invalid mode selection");
 #if 0
     for(uint64_t i = 4; i <= shape[tile_sweep_dim]; ++i) {
@@ -96,28 +129,24 @@ int main(int argc, char** argv)
     }
 #endif
   } else if(mode == "permutations") {
-    std::vector<uint64_t> high_indices(cluster_pos), low_indices(point.dataflow.size() - cluster_pos - 1);
-    std::iota(high_indices.begin(), high_indices.end(), 0);
-    std::iota(low_indices.begin(), low_indices.end(), 0);
-
-    uint64_t batch_size = fact(high_indices.size()) * fact(low_indices.size());
-    space_batch.reserve(batch_size);
-    cost_batch.reserve(batch_size);
-
-    do {
-      do {
-        Point copy = point;
-        for(uint8_t i = 0; i < high_indices.size(); ++i) { copy.dataflow[i] = point.dataflow[high_indices[i]]; }
-        for(uint8_t i = 0; i < low_indices.size(); ++i) { copy.dataflow[cluster_pos+1+i] = point.dataflow[cluster_pos+1+low_indices[i]]; }
-
-        if(space_id >= option.space_id_end) { goto space_done; }
-        if(space_id++ < option.space_id_start) { continue; }
-
-        space_batch.push_back(copy);
-        cost_batch.push_back(Cost<false>{});
-        ++space_size;
-      } while(std::next_permutation(std::begin(low_indices), std::end(low_indices)));
-    } while(std::next_permutation(std::begin(high_indices), std::end(high_indices)));
+    // Chunks are evaluated as soon as they are built, so memory does not grow with the space
+    PermutationSpace space(point, cluster_pos);
+    uint64_t space_end = std::min(option.space_id_end, space.size());
+    uint64_t space_begin = std::min(option.space_id_start, space_end);
+    std::cout << "streaming " << space_end - space_begin << " points on " << Executor::instance().numThreads() << " threads...";
+
+    space_batch.resize(std::min(chunk_size, space_end - space_begin));
+    cost_batch.resize(space_batch.size());
+    for(uint64_t chunk = space_begin; chunk < space_end; chunk += chunk_size) {
+      uint64_t count = std::min(chunk_size, space_end - chunk);
+      space.generate(chunk, count, space_batch);
+      runBatch(count, shape, layer_type, space_batch, cost_batch, result_file, best_point, best_cost, "");
+      for(uint64_t i = 0; i < count; ++i) { top_k.add(cost_batch[i], space_batch[i], chunk + i); }
+      if(result_file.is_open()) { result_file.flush(); }
+      space_size += count;
+    }
+    space_batch.clear();
+    cost_batch.clear();
   } else if(mode == "permutations_random") {
     static constexpr uint64_t num_samples = 1000;
 
@@ -138,22 +167,31 @@ int main(int argc, char** argv)
       space_batch[i] = copy;
       ++space_size;
     }
+  } else if(mode == "permutations_search") {
+    LoopOrderStats stats;
+    best_cost = searchLoopOrders(shape, layer_type, point, best_point, stats, "");
+    space_size = stats.num_evaluated;
+    std::cout << "searched " << stats.num_classes << " distinct of " << stats.num_orders << " orders...";
   } else if(mode == "single") {
     best_cost = run<false>(shape, layer_type, point, true, false, true, "log.txt");
     best_point = point;
     ++space_size;
   }
-space_done:
-
   auto end = std::chrono::high_resolution_clock::now();
   auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
-  std::cout << duration.count() << "s (size: " << space_size << ")\nEvaluating space...";
-
-  start = std::chrono::high_resolution_clock::now();
-  runBatch(space_batch.size(), shape, layer_type, space_batch, cost_batch, result_file, best_point, best_cost, "");
-  end = std::chrono::high_resolution_clock::now();
-  duration = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
-  std::cout << duration.count() << "s\n";
+  std::cout << duration.count() << "s (size: " << space_size << ")\n";
+
+  // Streaming modes evaluate their points as they build them, so the time above covers both
+  if(! space_batch.empty()) {
+    std::cout << "Evaluating space on " << Executor::instance().numThreads() << " threads...";
+
+    start = std::chrono::high_resolution_clock::now();
+    runBatch(space_batch.size(), shape, layer_type, space_batch, cost_batch, result_file, best_point, best_cost, "");
+    for(uint64_t i = 0; i < space_batch.size(); ++i) { top_k.add(cost_batch[i], space_batch[i], i); }
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+    std::cout << duration.count() << "s\n";
+  }
 
   // if(! result_file.is_open()) {
   //   for(uint64_t i = 0; i < space_size; ++i) {
@@ -164,6 +202,14 @@ space_done:
 
   std::cout << '\n' << best_point;
   printCost(std::cout, best_cost) << '\n';
+
+  if(option.top_k > 1) {
+    std::cout << "\nTop " << option.top_k << ":\n";
+    for(auto const & entry : top_k.sorted()) {
+      std::cout << entry.value;
+      printCost(std::cout, entry.cost) << '\n';
+    }
+  }
   return 0;
 }
 
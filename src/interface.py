@@ -3,12 +3,13 @@ from numpy.ctypeslib import ndpointer
 import itertools
 import platform
 import numpy as np
-import json
 import os
 
-from constraints import check_buffer_usage, check_area_usage
-
 failure_stats = dict()
+metric_names = None
+constraint_func = None
+# Hardware and budget of the last point checked without its footprints, with the result
+last_hw_constraints = None
 
 class LevelConfig:
     def __init__(self, label, buf_size, num_sub_clusters, tile_sizes, spatial_dim):
@@ -27,35 +28,117 @@ class LevelConfig:
 
 
 def _verify_input_constraints(args, shape, num_simd_lanes, bit_width, bandwidth, level_configs):
-    buffer_usage = check_buffer_usage(num_simd_lanes, bit_width, bandwidth, level_configs)
-    area_usage = check_area_usage(args, num_simd_lanes, bit_width, bandwidth, level_configs)
-
-    tile_valid = True
-    for i in range(len(level_configs) - 1):
-        for k in level_configs[i].tile_sizes.keys():
-            tile_valid &= (level_configs[i].tile_sizes[k] >= level_configs[i+1].tile_sizes[k])
+    """Returns whether each constraint of the native check holds for a point of the 'searched'
+    dataflow, keyed like check_buffer_usage and check_area_usage, along with 'power' and
+    'tile_size'. Footprints pass up to twice their buffer size, and the area and power bounds
+    up to their budget."""
+    _, usage = check_constraints(args, shape, [(num_simd_lanes, bit_width, bandwidth, level_configs)], 'searched', enforce_footprints=True)
+    names = _constraint_names(len(level_configs))
 
     valid_status = {}
-    for k, v in buffer_usage.items():
-        valid_status[k] = (v <= 2)
-    for k, v in area_usage.items():
+    for k, v in zip(names, usage[0]):
         valid_status[k] = (v <= 2)
-    valid_status['tile_size'] = tile_valid
+    valid_status['area'] = usage[0][-3] <= 1
+    valid_status['power'] = usage[0][-2] <= 1
+    valid_status['tile_size'] = usage[0][-1] == 1
 
     return valid_status
 
-def get_eval_func(args):
+tile_order_default = ['N', 'K', 'C', 'X', 'Y', 'R', 'S']
+
+
+def _build_dataflow_list(args, shape, dataflow, level_configs):
+    dataflow_list = list()
+    if dataflow == 'searched':
+        for i, level_config in enumerate(level_configs):
+            s_dim = level_config.spatial_dim
+            tile_size = level_config.tile_sizes[s_dim]
+            dataflow_list.append(('S', s_dim, tile_size))
+            for x in tile_order_default:
+                if x == s_dim: continue
+                tile_size = level_config.tile_sizes[x]
+                dataflow_list.append(('T', x, tile_size))
+            if i+1 < len(level_configs):
+                level_configs[i+1].tile_sizes[s_dim] = min(level_configs[i+1].tile_sizes[s_dim], level_configs[i].tile_sizes[s_dim])
+                dataflow_list.append(('C', None, 0))
+    elif dataflow == 'eye':
+        dataflow_list.append(('T', 'C', level_configs[0].tile_sizes['C']))
+        dataflow_list.append(('T', 'K', level_configs[0].tile_sizes['K']))
+        dataflow_list.append(('S', 'Y\'', level_configs[1].num_sub_clusters))
+        dataflow_list.append(('T', 'X\'', shape[1]['S']))
+        dataflow_list.append(('T', 'R', shape[1]['R']))
+        dataflow_list.append(('T', 'S', shape[1]['S']))
+        dataflow_list.append(('C', None, 0))
+        dataflow_list.append(('T', 'C', 1))
+        dataflow_list.append(('S', 'Y\'', 1))
+        dataflow_list.append(('S', 'X\'', 1))
+        dataflow_list.append(('T', 'R', shape[1]['R']))
+        dataflow_list.append(('T', 'S', shape[1]['S']))
+        args.search_permutations = False
+    elif dataflow == 'shi':
+        dataflow_list.append(('T', 'K', level_configs[0].tile_sizes['K']))
+        dataflow_list.append(('S', 'Y\'', shape[1]['R']))
+        dataflow_list.append(('T', 'X', level_configs[1].num_sub_clusters))
+        dataflow_list.append(('T', 'C', level_configs[0].tile_sizes['C']))
+        dataflow_list.append(('T', 'R', shape[1]['R']))
+        dataflow_list.append(('T', 'S', shape[1]['S']))
+        dataflow_list.append(('C', None, 0))
+        dataflow_list.append(('T', 'C', 1))
+        dataflow_list.append(('T', 'Y\'', 1))
+        dataflow_list.append(('S', 'X\'', 1))
+        dataflow_list.append(('T', 'R', shape[1]['R']))
+        dataflow_list.append(('T', 'S', shape[1]['S']))
+        args.search_permutations = False
+    elif dataflow == 'dla':
+        dataflow_list.append(('S', 'K', level_configs[0].tile_sizes['K']))
+        dataflow_list.append(('T', 'C', level_configs[1].num_sub_clusters))
+        dataflow_list.append(('T', 'R', shape[1]['R']))
+        dataflow_list.append(('T', 'S', shape[1]['S']))
+        dataflow_list.append(('T', 'Y', shape[1]['R']))
+        dataflow_list.append(('T', 'X', shape[1]['S']))
+        dataflow_list.append(('C', None, 0))
+        dataflow_list.append(('S', 'C', 1))
+        dataflow_list.append(('T', 'Y', shape[1]['R']))
+        dataflow_list.append(('T', 'X', shape[1]['S']))
+        dataflow_list.append(('T', 'R', shape[1]['R']))
+        dataflow_list.append(('T', 'S', shape[1]['S']))
+        args.search_permutations = False
+    return dataflow_list
+
+
+# Dimension ids of the binary dataflow records, in the order of directive_dimensions in spotlight-lib.cpp
+_dataflow_dims = {d: i for i, d in enumerate(['N', 'K', 'C', 'X', 'Y', 'R', 'S', 'X\'', 'Y\''])}
+
+
+def _build_dataflow_records(args, shape, dataflow, level_configs):
+    """Packs the directives of _build_dataflow_list as (kind, dimension id, size) records. Cluster
+    records take their size from num_sub_clusters, so only their kind is set."""
+    dataflow_list = _build_dataflow_list(args, shape, dataflow, level_configs)
+    return np.array([(ord(k), _dataflow_dims.get(d, 0), size) for k, d, size in dataflow_list], dtype=np.uint64)
+
+
+def _load_library():
     if platform.system() == 'Linux':
-        spotlight = ctypes.CDLL(os.path.join('build', 'libspotlight.so'))
+        return ctypes.CDLL(os.path.join('build', 'libspotlight.so'))
     elif platform.system() == 'Darwin':
-        spotlight = ctypes.CDLL(os.path.join('build', 'libspotlight.dylib'))
+        return ctypes.CDLL(os.path.join('build', 'libspotlight.dylib'))
     else:
         assert(False)
 
+
+def get_eval_func(args):
+    global metric_names
+
+    spotlight = _load_library()
+
     if args.dump_all:
-        evaluate = spotlight.evaluateWithDump
+        evaluate = spotlight.evaluateWithDumpBinaryInto
+        spotlight.getNumMetrics.restype = ctypes.c_ulonglong
+        spotlight.getMetricName.argtypes = (ctypes.c_ulonglong,)
+        spotlight.getMetricName.restype = ctypes.c_char_p
+        metric_names = [spotlight.getMetricName(i).decode('utf-8') for i in range(spotlight.getNumMetrics())]
     else:
-        evaluate = spotlight.evaluate
+        evaluate = spotlight.evaluateBinaryInto
 
     evaluate.argtypes= (
         ctypes.POINTER(ctypes.c_ulonglong),    # shape
@@ -67,15 +150,13 @@ def get_eval_func(args):
         ctypes.c_ulonglong,    # num_levels
         ctypes.POINTER(ctypes.c_ulonglong),    # buf_sizes
         ctypes.POINTER(ctypes.c_ulonglong),    # num_sub_clusters
-        ctypes.c_char_p,                       # dataflow
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflow (num_directives x 3)
+        ctypes.c_ulonglong,    # num_directives
         ctypes.c_ulonglong,    # search_permutations
         ctypes.c_char_p,    # logfile
+        ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'),    # costs (5, or one per metric with dump_all)
     )
-
-    if args.dump_all:
-        evaluate.restype = ctypes.c_char_p
-    else:
-        evaluate.restype = ndpointer(dtype=ctypes.c_double, shape=(5,))
+    evaluate.restype = ctypes.c_ulonglong
 
     return evaluate
 
@@ -91,62 +172,11 @@ def convert_args_and_invoke(args, eval_func, shape, num_simd_lanes, bit_width, b
     buf_sizes = [x.buf_size for x in level_configs]
     num_sub_clusters = [x.num_sub_clusters for x in level_configs]
 
-    dataflow_list = list()
-    tile_order_default = ['N', 'K', 'C', 'X', 'Y', 'R', 'S']
-    if dataflow == 'searched':
-        for i, level_config in enumerate(level_configs):
-            s_dim = level_config.spatial_dim
-            tile_size = level_config.tile_sizes[s_dim]
-            dataflow_list.append('S' + s_dim + '|' + str(tile_size))
-            for x in tile_order_default:
-                if x == s_dim: continue
-                tile_size = level_config.tile_sizes[x]
-                dataflow_list.append(('T' + x + '|' + str(tile_size)))
-            if i+1 < len(level_configs):
-                level_configs[i+1].tile_sizes[s_dim] = min(level_configs[i+1].tile_sizes[s_dim], level_configs[i].tile_sizes[s_dim])
-                dataflow_list.append('C')
-    elif dataflow == 'eye':
-        dataflow_list.append('TC|' + str(level_configs[0].tile_sizes['C']))
-        dataflow_list.append('TK|' + str(level_configs[0].tile_sizes['K']))
-        dataflow_list.append('SY\'|' + str(level_configs[1].num_sub_clusters))
-        dataflow_list.append('TX\'|' + str(shape[1]['S']))
-        dataflow_list.append('TR|' + str(shape[1]['R']))
-        dataflow_list.append('TS|' + str(shape[1]['S']))
-        dataflow_list.append('C')
-        dataflow_list.append('TC|1')
-        dataflow_list.append('SY\'|1')
-        dataflow_list.append('SX\'|1')
-        dataflow_list.append('TR|' + str(shape[1]['R']))
-        dataflow_list.append('TS|' + str(shape[1]['S']))
-        args.search_permutations = False
-    elif dataflow == 'shi':
-        dataflow_list.append('TK|' + str(level_configs[0].tile_sizes['K']))
-        dataflow_list.append('SY\'|' + str(shape[1]['R']))
-        dataflow_list.append('TX|' + str(level_configs[1].num_sub_clusters))
-        dataflow_list.append('TC|' + str(level_configs[0].tile_sizes['C']))
-        dataflow_list.append('TR|' + str(shape[1]['R']))
-        dataflow_list.append('TS|' + str(shape[1]['S']))
-        dataflow_list.append('C')
-        dataflow_list.append('TC|1')
-        dataflow_list.append('TY\'|1')
-        dataflow_list.append('SX\'|1')
-        dataflow_list.append('TR|' + str(shape[1]['R']))
-        dataflow_list.append('TS|' + str(shape[1]['S']))
-        args.search_permutations = False
-    elif dataflow == 'dla':
-        dataflow_list.append('SK|' + str(level_configs[0].tile_sizes['K']))
-        dataflow_list.append('TC|' + str(level_configs[1].num_sub_clusters))
-        dataflow_list.append('TR|' + str(shape[1]['R']))
-        dataflow_list.append('TS|' + str(shape[1]['S']))
-        dataflow_list.append('TY|' + str(shape[1]['R']))
-        dataflow_list.append('TX|' + str(shape[1]['S']))
-        dataflow_list.append('C')
-        dataflow_list.append('SC|1')
-        dataflow_list.append('TY|' + str(shape[1]['R']))
-        dataflow_list.append('TX|' + str(shape[1]['S']))
-        dataflow_list.append('TR|' + str(shape[1]['R']))
-        dataflow_list.append('TS|' + str(shape[1]['S']))
-        args.search_permutations = False
+    dataflow_records = _build_dataflow_records(args, shape, dataflow, level_configs)
+    feasible, usage = _check_point_constraints(args, shape, num_simd_lanes, bit_width, bandwidth, level_configs, dataflow_records)
+    if not feasible:
+        _count_infeasible(usage)
+        return None
     shape_list = list(itertools.chain(*[(shape[1][x], shape[2][x]) for x in tile_order_default]))
     layer_type = shape[3]
     # TODO: DSCONV causes seg fault (likely because dataflow requirements are different)
@@ -154,13 +184,13 @@ def convert_args_and_invoke(args, eval_func, shape, num_simd_lanes, bit_width, b
 
     shape_array_type = ctypes.c_ulonglong * len(shape_list)
     level_array_type = ctypes.c_ulonglong * len(level_configs)
-    dataflow_array_type = ctypes.c_ulonglong * len(dataflow_list)
 
     num_pes = np.product([l.num_sub_clusters for l in level_configs])
 
     logpath = os.path.join('logs', shape[0] + '.log')
+    ret = np.zeros(len(metric_names) if args.dump_all else 5, dtype=np.float64)
 
-    ret = eval_func(
+    eval_func(
         shape_array_type(*shape_list),
         ctypes.create_string_buffer(layer_type.encode('utf-8')),
         ctypes.c_ulonglong(num_pes),
@@ -170,13 +200,15 @@ def convert_args_and_invoke(args, eval_func, shape, num_simd_lanes, bit_width, b
         ctypes.c_ulonglong(len(level_configs)),
         level_array_type(*buf_sizes),
         level_array_type(*num_sub_clusters),
-        ctypes.create_string_buffer(','.join(dataflow_list).encode('utf-8')),
+        dataflow_records,
+        ctypes.c_ulonglong(len(dataflow_records)),
         ctypes.c_ulonglong(args.search_permutations),
         ctypes.create_string_buffer(logpath.encode('utf-8')),
+        ret,
     )
 
     if args.dump_all:
-        cost = json.loads(ret.decode('utf-8'))
+        cost = {name: value for name, value in zip(metric_names, ret) if np.isfinite(value)}
     else:
         cost = {
             'ExactRunTime': ret[0],
@@ -186,6 +218,12 @@ def convert_args_and_invoke(args, eval_func, shape, num_simd_lanes, bit_width, b
             'Throughput': ret[4]
         }
 
+    return _filter_cost(args, cost)
+
+
+def _filter_cost(args, cost):
+    global failure_stats
+
     if cost['ExactRunTime'] <= 0 or cost['OverallEnergy'] <= 0 or cost['Area'] <= 0:
         failure_stats['maestro'] = failure_stats.get('maestro', 0) + 1
         return None
@@ -203,3 +241,424 @@ def convert_args_and_invoke(args, eval_func, shape, num_simd_lanes, bit_width, b
     #     return None
 
     return cost
+
+
+def get_cache_stats():
+    spotlight = _load_library()
+    spotlight.getCacheStats.argtypes = (ctypes.POINTER(ctypes.c_ulonglong),)
+    spotlight.getCacheStats.restype = None
+
+    stats = (ctypes.c_ulonglong * 4)()
+    spotlight.getCacheStats(stats)
+    return {'hits': stats[0], 'misses': stats[1], 'size': stats[2], 'capacity': stats[3]}
+
+
+def get_batch_eval_func(args):
+    spotlight = _load_library()
+
+    evaluate_batch = spotlight.evaluateBatchBinary
+    evaluate_batch.argtypes = (
+        ctypes.c_ulonglong,    # num_points
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # shapes (num_points x 14)
+        ctypes.c_char_p,       # layer_type
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_pes
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_simd_lanes
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # bit_widths
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # bandwidths
+        ctypes.c_ulonglong,    # num_levels
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # buf_sizes (num_points x num_levels)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_sub_clusters (num_points x num_levels)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflows (packed records x 3)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflow_offsets (num_points + 1, in records)
+        ctypes.c_ulonglong,    # search_permutations
+        ctypes.c_char_p,       # logfile
+        ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'),    # costs (num_points x 5)
+    )
+    evaluate_batch.restype = ctypes.c_ulonglong
+
+    return evaluate_batch
+
+
+def _pack_batch(shape, samples, dataflows):
+    """Lays out (num_simd_lanes, bit_width, bandwidth, level_configs) samples of a single layer
+    shape and their dataflow records like the batch entry points of the library take them."""
+    assert(len(shape[1]) == 7 and len(shape[2]) == 7)
+
+    num_points = len(samples)
+    num_levels = len(samples[0][3])
+
+    shape_list = list(itertools.chain(*[(shape[1][x], shape[2][x]) for x in tile_order_default]))
+
+    num_pes = np.empty(num_points, dtype=np.uint64)
+    num_simd_lanes = np.empty(num_points, dtype=np.uint64)
+    bit_widths = np.empty(num_points, dtype=np.uint64)
+    bandwidths = np.empty(num_points, dtype=np.uint64)
+    buf_sizes = np.empty((num_points, num_levels), dtype=np.uint64)
+    num_sub_clusters = np.empty((num_points, num_levels), dtype=np.uint64)
+    dataflow_offsets = np.zeros(num_points + 1, dtype=np.uint64)
+
+    for i, (simd, bit_width, bandwidth, level_configs) in enumerate(samples):
+        assert(len(level_configs) == num_levels)
+        num_pes[i] = np.product([l.num_sub_clusters for l in level_configs])
+        num_simd_lanes[i] = simd
+        bit_widths[i] = bit_width
+        bandwidths[i] = bandwidth
+        buf_sizes[i] = [l.buf_size for l in level_configs]
+        num_sub_clusters[i] = [l.num_sub_clusters for l in level_configs]
+        dataflow_offsets[i + 1] = dataflow_offsets[i] + len(dataflows[i])
+
+    shapes = np.tile(np.array(shape_list, dtype=np.uint64), num_points)
+    return (num_points, shapes, num_pes, num_simd_lanes, bit_widths, bandwidths, num_levels,
+            buf_sizes, num_sub_clusters, np.concatenate(dataflows), dataflow_offsets)
+
+
+def convert_args_and_invoke_batch(args, batch_func, shape, samples, dataflows):
+    """Evaluates a list of (num_simd_lanes, bit_width, bandwidth, level_configs) samples for a single
+    layer shape in one library call, sample i with dataflows[i]. Each sample gets the cost that
+    convert_args_and_invoke would give it. Samples that fail the constraint check are not evaluated.
+    Returns a list of costs (or None for rejected samples)."""
+    assert(not args.dump_all)
+
+    # TODO: DSCONV causes seg fault (likely because dataflow requirements are different)
+    layer_type = 'CONV'
+    logpath = os.path.join('logs', shape[0] + '.log')
+
+    dataflows = [_build_dataflow_records(args, shape, dataflow, sample[3]) for sample, dataflow in zip(samples, dataflows)]
+    feasible, usage = _check_packed_constraints(args, _pack_batch(shape, samples, dataflows))
+
+    ret = [None] * len(samples)
+    for i in np.flatnonzero(~feasible):
+        _count_infeasible(usage[i])
+
+    indices = np.flatnonzero(feasible)
+    if len(indices) == 0:
+        return ret
+
+    (num_points, shapes, num_pes, num_simd_lanes, bit_widths, bandwidths, num_levels,
+     buf_sizes, num_sub_clusters, records, dataflow_offsets) = _pack_batch(shape, [samples[i] for i in indices], [dataflows[i] for i in indices])
+    costs = np.zeros((num_points, 5), dtype=np.float64)
+
+    batch_func(
+        num_points,
+        shapes,
+        layer_type.encode('utf-8'),
+        num_pes,
+        num_simd_lanes,
+        bit_widths,
+        bandwidths,
+        num_levels,
+        buf_sizes,
+        num_sub_clusters,
+        records,
+        dataflow_offsets,
+        args.search_permutations,
+        logpath.encode('utf-8'),
+        costs,
+    )
+
+    for i, row in zip(indices, costs):
+        cost = {
+            'ExactRunTime': row[0],
+            'OverallEnergy': row[1],
+            'Area': row[2],
+            'Power': row[3],
+            'Throughput': row[4]
+        }
+        ret[i] = _filter_cost(args, cost)
+    return ret
+
+
+def get_model_eval_func(args):
+    spotlight = _load_library()
+
+    evaluate_model = spotlight.evaluateModel
+    evaluate_model.argtypes = (
+        ctypes.c_ulonglong,    # num_layers
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # shapes (num_layers x 14)
+        ctypes.c_char_p,       # layer_type
+        ctypes.c_ulonglong,    # num_pes
+        ctypes.c_ulonglong,    # num_simd_lanes
+        ctypes.c_ulonglong,    # bit_width
+        ctypes.c_ulonglong,    # bandwidth
+        ctypes.c_ulonglong,    # num_levels
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # buf_sizes (num_levels)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_sub_clusters (num_levels)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflows (packed records x 3)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflow_offsets (num_layers + 1, in records)
+        ctypes.c_ulonglong,    # search_permutations
+        ctypes.c_char_p,       # logfile
+        ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'),    # costs (num_layers x 5)
+    )
+    evaluate_model.restype = ctypes.c_ulonglong
+
+    return evaluate_model
+
+
+def convert_args_and_invoke_model(args, model_func, shapes, num_simd_lanes, bit_width, bandwidth, layer_configs):
+    """Evaluates one (dataflow, level_configs) mapping per layer shape on shared hardware in one
+    library call, which runs the layers concurrently and evaluates repeated layers with the same
+    mapping once. The level_configs of every layer must agree on the buffer sizes and sub-clusters.
+    Layers that fail the constraint check are not evaluated. Returns a list of costs (or None for
+    rejected layers)."""
+    assert(not args.dump_all)
+    assert(len(shapes) == len(layer_configs))
+
+    # TODO: DSCONV causes seg fault (likely because dataflow requirements are different)
+    layer_type = 'CONV'
+    logpath = os.path.join('logs', 'model.log')
+
+    ret = [None] * len(shapes)
+    indices = list()
+    dataflows = list()
+    for i, (shape, (dataflow, level_configs)) in enumerate(zip(shapes, layer_configs)):
+        assert(len(shape[1]) == 7 and len(shape[2]) == 7)
+        dataflow_records = _build_dataflow_records(args, shape, dataflow, level_configs)
+        feasible, usage = _check_point_constraints(args, shape, num_simd_lanes, bit_width, bandwidth, level_configs, dataflow_records)
+        if feasible:
+            indices.append(i)
+            dataflows.append(dataflow_records)
+        else:
+            _count_infeasible(usage)
+
+    if len(indices) == 0:
+        return ret
+
+    level_configs = layer_configs[indices[0]][1]
+    buf_sizes = np.array([l.buf_size for l in level_configs], dtype=np.uint64)
+    num_sub_clusters = np.array([l.num_sub_clusters for l in level_configs], dtype=np.uint64)
+    num_pes = np.product([l.num_sub_clusters for l in level_configs])
+
+    shapes_array = np.array([list(itertools.chain(*[(shapes[i][1][x], shapes[i][2][x]) for x in tile_order_default])) for i in indices], dtype=np.uint64)
+    dataflow_offsets = np.zeros(len(indices) + 1, dtype=np.uint64)
+    dataflow_offsets[1:] = np.cumsum([len(records) for records in dataflows])
+    costs = np.zeros((len(indices), 5), dtype=np.float64)
+
+    model_func(
+        len(indices),
+        shapes_array,
+        layer_type.encode('utf-8'),
+        num_pes,
+        num_simd_lanes,
+        bit_width,
+        bandwidth,
+        len(level_configs),
+        buf_sizes,
+        num_sub_clusters,
+        np.concatenate(dataflows),
+        dataflow_offsets,
+        args.search_permutations,
+        logpath.encode('utf-8'),
+        costs,
+    )
+
+    for i, row in zip(indices, costs):
+        cost = {
+            'ExactRunTime': row[0],
+            'OverallEnergy': row[1],
+            'Area': row[2],
+            'Power': row[3],
+            'Throughput': row[4]
+        }
+        ret[i] = _filter_cost(args, cost)
+    return ret
+
+
+def get_constraint_func():
+    global constraint_func
+
+    if constraint_func is None:
+        spotlight = _load_library()
+        spotlight.getNumConstraints.argtypes = (ctypes.c_ulonglong,)
+        spotlight.getNumConstraints.restype = ctypes.c_ulonglong
+
+        check = spotlight.checkConstraintsBatch
+        check.argtypes = (
+            ctypes.c_ulonglong,    # num_points
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # shapes (num_points x 14)
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_pes
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_simd_lanes
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # bit_widths
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # bandwidths
+            ctypes.c_ulonglong,    # num_levels
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # buf_sizes (num_points x num_levels)
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_sub_clusters (num_points x num_levels)
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflows (packed records x 3)
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # dataflow_offsets (num_points + 1, in records)
+            ctypes.c_double,       # max_area
+            ctypes.c_double,       # max_power
+            ctypes.c_ulonglong,    # enforce_footprints
+            ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'),    # usage (num_points x getNumConstraints(num_levels))
+            ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # feasible (num_points)
+        )
+        check.restype = ctypes.c_ulonglong
+        check.num_constraints = spotlight.getNumConstraints
+        constraint_func = check
+
+    return constraint_func
+
+
+def _constraint_names(num_levels):
+    """Names of the columns of the usage returned by check_constraints"""
+    names = ['{}_valid_{}'.format(tensor, level) for level in range(num_levels) for tensor in ['inp', 'wgt', 'out']]
+    return names + ['area', 'power', 'tile_size']
+
+
+def _check_packed_constraints(args, packed, enforce_footprints=None):
+    (num_points, shapes, num_pes, num_simd_lanes, bit_widths, bandwidths, num_levels,
+     buf_sizes, num_sub_clusters, records, dataflow_offsets) = packed
+    if enforce_footprints is None:
+        enforce_footprints = args.enforce_footprints
+
+    check = get_constraint_func()
+    usage = np.zeros((num_points, check.num_constraints(num_levels)), dtype=np.float64)
+    feasible = np.zeros(num_points, dtype=np.uint64)
+    # Like _filter_cost, which checks the power against the area budget
+    check(num_points, shapes, num_pes, num_simd_lanes, bit_widths, bandwidths, num_levels, buf_sizes, num_sub_clusters,
+          records, dataflow_offsets, args.max_area, args.max_area, int(enforce_footprints), usage, feasible)
+    return feasible.astype(bool), usage
+
+
+def check_constraints(args, shape, samples, dataflow, enforce_footprints=None):
+    """Checks (num_simd_lanes, bit_width, bandwidth, level_configs) samples of a single layer shape
+    without evaluating them. Returns whether each sample may pass _filter_cost, along with a row
+    per sample of the columns named by _constraint_names: the footprint of every tensor at every
+    level over the buffer size, as in check_buffer_usage, the lower bounds of the area and power
+    over the area budget, and whether the tiles are nested. Footprints and nesting only decide
+    feasibility with enforce_footprints, which defaults to args.enforce_footprints."""
+    dataflows = [_build_dataflow_records(args, shape, dataflow, sample[3]) for sample in samples]
+    return _check_packed_constraints(args, _pack_batch(shape, samples, dataflows), enforce_footprints)
+
+
+def _check_point_constraints(args, shape, num_simd_lanes, bit_width, bandwidth, level_configs, dataflow_records):
+    """Checks a single point like check_constraints. Without footprints, the outcome only depends
+    on the hardware, which stays the same across the software samples of a hardware point."""
+    global last_hw_constraints
+
+    key = None
+    if not args.enforce_footprints:
+        key = (tuple(l.num_sub_clusters for l in level_configs), num_simd_lanes, bit_width, bandwidth, args.max_area)
+        if last_hw_constraints is not None and last_hw_constraints[0] == key:
+            return last_hw_constraints[1]
+
+    feasible, usage = _check_packed_constraints(args, _pack_batch(shape, [(num_simd_lanes, bit_width, bandwidth, level_configs)], [dataflow_records]))
+    if key is not None:
+        last_hw_constraints = (key, (feasible[0], usage[0]))
+    return feasible[0], usage[0]
+
+
+def _count_infeasible(usage_row):
+    global failure_stats
+
+    if usage_row[-3] > 1:
+        key = 'area'
+    elif usage_row[-2] > 1:
+        key = 'power'
+    else:
+        key = 'footprint'
+    failure_stats[key] = failure_stats.get(key, 0) + 1
+
+
+def get_genetic_search_func(args):
+    spotlight = _load_library()
+
+    genetic_search = spotlight.runGeneticSearch
+    genetic_search.argtypes = (
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # shape (14)
+        ctypes.c_char_p,       # layer_type
+        ctypes.c_ulonglong,    # num_simd_lanes
+        ctypes.c_ulonglong,    # bit_width
+        ctypes.c_ulonglong,    # bandwidth
+        ctypes.c_ulonglong,    # num_levels
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # buf_sizes (num_levels)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # num_sub_clusters (num_levels)
+        ctypes.c_ulonglong,    # search_permutations
+        ctypes.c_ulonglong,    # target (0 for edp, 1 for delay)
+        ctypes.c_double,       # max_area
+        ctypes.c_double,       # max_power
+        ctypes.c_ulonglong,    # population
+        ctypes.c_ulonglong,    # num_trials
+        ctypes.c_ulonglong,    # max_invalid
+        ctypes.c_ulonglong,    # seed
+        ctypes.c_char_p,       # logfile
+        ctypes.c_ulonglong,    # num_elites
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # elite_genomes (num_elites x genome size)
+        ndpointer(dtype=np.float64, flags='C_CONTIGUOUS'),    # elite_costs (num_elites x 5)
+        ndpointer(dtype=np.uint64, flags='C_CONTIGUOUS'),     # stats (6)
+    )
+    genetic_search.restype = ctypes.c_ulonglong
+
+    return genetic_search
+
+
+# Tile genes of the native genetic search, in the order of the parameters of space.create_software_space
+_genetic_tile_dims = ['K', 'C', 'N', 'X', 'Y', 'R', 'S']
+
+
+def invoke_genetic_search(args, genetic_func, shape, num_simd_lanes, bit_width, bandwidth, buf_sizes, num_sub_clusters, seed, num_elites):
+    """Runs the native genetic search of software points for a single layer shape, with the
+    levels of buf_sizes and num_sub_clusters outermost first. Returns up to num_elites
+    (sw_point, cost) pairs, best first, with sw_point a dictionary of the parameters of
+    space.create_software_space, and whether the search found args.sw_trials valid points."""
+    global failure_stats
+
+    assert(len(shape[1]) == 7 and len(shape[2]) == 7)
+    assert(args.dataflow == 'searched' and not args.dump_all)
+
+    num_levels = len(buf_sizes)
+    shape_list = list(itertools.chain(*[(shape[1][x], shape[2][x]) for x in tile_order_default]))
+    # TODO: DSCONV causes seg fault (likely because dataflow requirements are different)
+    layer_type = 'CONV'
+    logpath = os.path.join('logs', shape[0] + '.log')
+
+    genome_size = len(_genetic_tile_dims) * (num_levels + 1) + num_levels
+    elite_genomes = np.zeros((num_elites, genome_size), dtype=np.uint64)
+    elite_costs = np.zeros((num_elites, 5), dtype=np.float64)
+    stats = np.zeros(6, dtype=np.uint64)
+
+    num_written = genetic_func(
+        np.array(shape_list, dtype=np.uint64),
+        layer_type.encode('utf-8'),
+        num_simd_lanes,
+        bit_width,
+        bandwidth,
+        num_levels,
+        np.array(buf_sizes, dtype=np.uint64),
+        np.array(num_sub_clusters, dtype=np.uint64),
+        int(args.search_permutations),
+        1 if args.target == 'delay' else 0,
+        args.max_area,
+        # Like _filter_cost, which checks the power against the area budget
+        args.max_area,
+        args.sw_batch_size,
+        args.sw_trials,
+        args.max_invalid,
+        seed,
+        logpath.encode('utf-8'),
+        num_elites,
+        elite_genomes,
+        elite_costs,
+        stats,
+    )
+
+    for key, count in zip(['maestro', 'area', 'power'], stats[3:]):
+        if count:
+            failure_stats[key] = failure_stats.get(key, 0) + int(count)
+
+    elites = list()
+    for genome, row in zip(elite_genomes[:num_written], elite_costs[:num_written]):
+        sw_point = dict()
+        for i, dim in enumerate(_genetic_tile_dims):
+            sw_point[dim] = [int(x) for x in genome[i * (num_levels + 1):(i + 1) * (num_levels + 1)]]
+        spatial_dims = genome[len(_genetic_tile_dims) * (num_levels + 1):]
+        for i, dim_id in enumerate(spatial_dims):
+            sw_point['l{}_spatial_dim'.format(i)] = list(_dataflow_dims.keys())[int(dim_id)]
+        cost = {
+            'ExactRunTime': row[0],
+            'OverallEnergy': row[1],
+            'Area': row[2],
+            'Power': row[3],
+            'Throughput': row[4]
+        }
+        elites.append((sw_point, cost))
+
+    return elites, int(stats[1]) >= args.sw_trials
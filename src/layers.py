@@ -1,5 +1,24 @@
 import copy
 
+def shape_key(shape):
+    """Lengths, strides and type of a (name, lengths, strides, type) shape, which are all that
+    its evaluation depends on"""
+    dim_labels = ['N', 'K', 'C', 'R', 'S', 'X', 'Y']
+    return tuple([shape[1][x] for x in dim_labels] + [shape[2][x] for x in dim_labels] + [shape[3]])
+
+def group_shapes(shapes):
+    """Groups the shapes with the same shape_key. Returns the index of the first shape of every
+    group and the group of every shape."""
+    groups = dict()
+    first_indices = list()
+    group_of = list()
+    for i, shape in enumerate(shapes):
+        group = groups.setdefault(shape_key(shape), len(first_indices))
+        if group == len(first_indices):
+            first_indices.append(i)
+        group_of.append(group)
+    return first_indices, group_of
+
 def get_shapes(layer_names, ignore_stride, ignore_type, remove_duplicates):
     shape_db = {
         'resnet50_early': {'N': 1, 'K': 64, 'C': 3, 'R': 7, 'S': 7, 'X': 224, 'Y': 224},
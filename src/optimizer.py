@@ -8,6 +8,8 @@ import numpy as np
 
 import bo
 import ga
+import interface
+import layers
 import space
 import search_utils
 
@@ -56,26 +58,28 @@ class Optimizer:
         cost = search_utils.run_maestro_tvm(self.args, self.eval_f, shape, hw_point, sw_point, num_levels)
         return cost
 
+    def new_layer_results(self):
+        if self.args.target == 'edp':
+            return search_utils.SWResults(
+                (float('inf'), float('inf'), float('inf')),
+                lambda x: (x.energy, x.delay, x.area),
+                Optimizer._edp_reduce,
+                lambda x: x[0] * x[1]
+            )
+        elif self.args.target == 'delay':
+            return search_utils.SWResults(
+                (float('inf'), float('inf')),
+                lambda x: (x.delay, x.area),
+                Optimizer._single_reduce,
+                lambda x: x[0]
+            )
+
     def opt_sw(self, num_levels, hw_point):
         model_results = list()
         model_status = True
 
         for i, shape in enumerate(self.shapes):
-
-            if self.args.target == 'edp':
-                layer_results = search_utils.SWResults(
-                    (float('inf'), float('inf'), float('inf')),
-                    lambda x: (x.energy, x.delay, x.area),
-                    Optimizer._edp_reduce,
-                    lambda x: x[0] * x[1]
-                )
-            elif self.args.target == 'delay':
-                layer_results = search_utils.SWResults(
-                    (float('inf'), float('inf')),
-                    lambda x: (x.delay, x.area),
-                    Optimizer._single_reduce,
-                    lambda x: x[0]
-                )
+            layer_results = self.new_layer_results()
 
             sw_space = space.create_software_space(self.args, shape[1], num_levels)
             invalid_sample_count = 0
@@ -234,6 +238,155 @@ class Optimizer:
         pass
 
 class RandomOptimizer(Optimizer):
+    def __init__(self, args, eval_f, shapes, n_hw, n_sw, out_file, compute_feats=True):
+        super().__init__(args, eval_f, shapes, n_hw, n_sw, out_file, compute_feats)
+        self.model_func = None
+        self.batch_func = None
+        self.group_layers, self.group_of = layers.group_shapes(shapes)
+
+    def opt_sw_batch(self, num_levels, hw_point):
+        # Random samples do not depend on earlier ones, so the library can evaluate every sample a
+        # layer still needs in one call, with summary costs
+        if self.batch_func is None:
+            self.batch_func = interface.get_batch_eval_func(self.args)
+
+        model_results = list()
+        model_status = True
+
+        for i, shape in enumerate(self.shapes):
+            layer_results = self.new_layer_results()
+
+            sw_space = space.create_software_space(self.args, shape[1], num_levels)
+            invalid_sample_count = 0
+            valid_sample_count = 0
+
+            if self.args.sw_progress_bar:
+                pbar = tqdm.tqdm(total=self.n_sw)
+
+            layer_start_time = time.perf_counter()
+
+            while valid_sample_count < self.n_sw and invalid_sample_count < self.args.max_invalid:
+                sample_start_time = time.perf_counter()
+                sw_points = [self.get_sw_point(sw_space, hw_point, layer_results) for _ in range(self.n_sw - valid_sample_count)]
+                costs = search_utils.run_maestro_batch(self.args, self.batch_func, shape, hw_point, sw_points, num_levels)
+                sample_end_time = time.perf_counter()
+
+                for sw_point, cost in zip(sw_points, costs):
+                    if cost is None:
+                        invalid_sample_count += 1
+                        if invalid_sample_count >= self.args.max_invalid:
+                            break
+                        continue
+
+                    if self.compute_feats:
+                        sw_feats, self.sw_feat_labels = search_utils.get_sw_point_feats(hw_point, sw_point, num_levels, self.excluded_feats, self.args.dataflow, with_labels=True)
+                    else:
+                        sw_feats = list()
+                    sw_sample = search_utils.SWSample(sw_point, sw_feats, cost)
+                    if self.args.print_sw_samples:
+                        self.log('         {} sw_sample {} {} t {} sec', valid_sample_count, sw_sample.getResultString(), str(sw_sample), sample_end_time - sample_start_time)
+                    if self.args.sw_progress_bar:
+                        pbar.update(1)
+                    layer_results.add(sw_sample)
+                    valid_sample_count += 1
+
+            if invalid_sample_count >= self.args.max_invalid:
+                model_status = False
+
+            layer_end_time = time.perf_counter()
+
+            if model_status:
+                self.log('      {} opt_layer {} t {} sec', i, str(layer_results), layer_end_time - layer_start_time)
+                model_results.append(layer_results)
+            else:
+                self.log('      {} opt_layer INVALID t {} sec', i, layer_end_time - layer_start_time)
+
+            if self.args.sw_progress_bar:
+                pbar.close()
+
+            if self.sw_opt_complete_hook:
+                self.sw_opt_complete_hook(self, shape, sw_space, hw_point, layer_results)
+
+        return model_results if model_status else None
+
+    def opt_sw(self, num_levels, hw_point):
+        if self.args.dump_all:
+            return super().opt_sw(num_levels, hw_point)
+        if not self.args.model_eval:
+            return self.opt_sw_batch(num_levels, hw_point)
+
+        # Likewise, the library can evaluate a sample of every layer at once. Repeated layers share
+        # their samples and results: every layer is passed with the sample of its group, and the
+        # library evaluates each distinct layer once.
+
+        if self.model_func is None:
+            self.model_func = interface.get_model_eval_func(self.args)
+
+        num_groups = len(self.group_layers)
+        sw_spaces = [space.create_software_space(self.args, self.shapes[i][1], num_levels) for i in self.group_layers]
+        group_results = [self.new_layer_results() for _ in range(num_groups)]
+        valid_sample_counts = [0] * num_groups
+        invalid_sample_counts = [0] * num_groups
+        model_status = True
+
+        if self.args.sw_progress_bar:
+            pbar = tqdm.tqdm(total=self.n_sw * num_groups)
+
+        model_start_time = time.perf_counter()
+
+        while model_status:
+            groups = [g for g, count in enumerate(valid_sample_counts) if count < self.n_sw]
+            if len(groups) == 0:
+                break
+
+            sample_start_time = time.perf_counter()
+            group_points = {g: self.get_sw_point(sw_spaces[g], hw_point, group_results[g]) for g in groups}
+            layer_indices = [i for i, g in enumerate(self.group_of) if g in group_points]
+            costs = search_utils.run_maestro_model(self.args, self.model_func, [self.shapes[i] for i in layer_indices],
+                                                   hw_point, [group_points[self.group_of[i]] for i in layer_indices], num_levels)
+            group_costs = {self.group_of[i]: cost for i, cost in zip(layer_indices, costs) if i == self.group_layers[self.group_of[i]]}
+            sample_end_time = time.perf_counter()
+
+            for g, sw_point in group_points.items():
+                cost = group_costs[g]
+                if cost is None:
+                    invalid_sample_counts[g] += 1
+                    if invalid_sample_counts[g] >= self.args.max_invalid:
+                        model_status = False
+                    continue
+
+                if self.compute_feats:
+                    sw_feats, self.sw_feat_labels = search_utils.get_sw_point_feats(hw_point, sw_point, num_levels, self.excluded_feats, self.args.dataflow, with_labels=True)
+                else:
+                    sw_feats = list()
+                sw_sample = search_utils.SWSample(sw_point, sw_feats, cost)
+                if self.args.print_sw_samples:
+                    self.log('         {} sw_sample {} {} t {} sec', valid_sample_counts[g], sw_sample.getResultString(), str(sw_sample), sample_end_time - sample_start_time)
+                if self.args.sw_progress_bar:
+                    pbar.update(1)
+                group_results[g].add(sw_sample)
+                valid_sample_counts[g] += 1
+
+        model_end_time = time.perf_counter()
+
+        # The layers are evaluated together, so each reports the time of the whole model
+        model_results = list()
+        for i, shape in enumerate(self.shapes):
+            g = self.group_of[i]
+            if valid_sample_counts[g] >= self.n_sw:
+                self.log('      {} opt_layer {} t {} sec', i, str(group_results[g]), model_end_time - model_start_time)
+            else:
+                self.log('      {} opt_layer INVALID t {} sec', i, model_end_time - model_start_time)
+            model_results.append(group_results[g])
+
+            if self.sw_opt_complete_hook:
+                self.sw_opt_complete_hook(self, shape, sw_spaces[g], hw_point, group_results[g])
+
+        if self.args.sw_progress_bar:
+            pbar.close()
+
+        return model_results if model_status else None
+
     def get_hw_point(self, hw_space, hw_results):
         space_idx = np.random.randint(hw_space.size)
         return hw_space.build_point(space_idx)
@@ -266,6 +419,52 @@ class GridOptimizer(Optimizer):
         self.sw_idx = None
 
 class GeneticOptimizer(Optimizer):
+    def __init__(self, args, eval_f, shapes, n_hw, n_sw, out_file, compute_feats=True):
+        super().__init__(args, eval_f, shapes, n_hw, n_sw, out_file, compute_feats)
+        self.genetic_func = None
+
+    def opt_sw(self, num_levels, hw_point):
+        # The library runs whole software searches of the searched dataflow, with summary costs
+        if not self.args.native_ga or self.args.dataflow != 'searched' or self.args.dump_all:
+            return super().opt_sw(num_levels, hw_point)
+
+        if self.genetic_func is None:
+            self.genetic_func = interface.get_genetic_search_func(self.args)
+
+        model_results = list()
+        model_status = True
+
+        for i, shape in enumerate(self.shapes):
+            layer_results = self.new_layer_results()
+
+            layer_start_time = time.perf_counter()
+            elites, success = search_utils.run_genetic_search(self.args, self.genetic_func, shape, hw_point, num_levels, self.args.sw_elites)
+            layer_end_time = time.perf_counter()
+
+            # Each layer reports its own search; any failed layer invalidates the model
+            model_status = model_status and success
+            if success:
+                # Worst first, so that ties leave the best elite as the optimum of the layer
+                for j, (sw_point, cost) in reversed(list(enumerate(elites))):
+                    if self.compute_feats:
+                        sw_feats, self.sw_feat_labels = search_utils.get_sw_point_feats(hw_point, sw_point, num_levels, self.excluded_feats, self.args.dataflow, with_labels=True)
+                    else:
+                        sw_feats = list()
+                    sw_sample = search_utils.SWSample(sw_point, sw_feats, cost)
+                    if self.args.print_sw_samples:
+                        self.log('         {} sw_elite {} {}', j, sw_sample.getResultString(), str(sw_sample))
+                    layer_results.add(sw_sample)
+
+                self.log('      {} opt_layer {} t {} sec', i, str(layer_results), layer_end_time - layer_start_time)
+                model_results.append(layer_results)
+            else:
+                self.log('      {} opt_layer INVALID t {} sec', i, layer_end_time - layer_start_time)
+
+            if self.sw_opt_complete_hook:
+                self.sw_opt_complete_hook(self, shape, None, hw_point, layer_results)
+
+        return model_results if model_status else None
+
     def gen_hw_batch(self, hw_space, hw_results):
         if hw_results:
             self.hw_points_last_gen = [x for i, x in enumerate(self.hw_points) if self.hw_point_valid[i]]
@@ -38,6 +38,7 @@ class DefaultArgs:
     hw_batch_size = 1000
     sw_batch_trials = 10
     hw_batch_trials = 10
+    sw_elites = 10
 
     layers = None
     exclude_feat = "raw"
@@ -79,6 +80,7 @@ def get_args():
 
     parser.add_argument("--max-area", help="maximum area", type=float, default=DefaultArgs.max_area)
     parser.add_argument("--max-power", help="maximum power", type=float, default=DefaultArgs.max_power)
+    parser.add_argument("--footprint-filter", dest="enforce_footprints", help="skip points whose tiles overflow their buffers or are not nested without evaluating them", default=False, action="store_true")
 
     parser.add_argument("--trials", help="number of hardware trials", type=int, default=DefaultArgs.trials)
     parser.add_argument("--hw-trials", help="number of hardware trials", type=int, default=DefaultArgs.hw_trials)
@@ -98,16 +100,20 @@ def get_args():
     parser.add_argument("--hw-batch-size", help="number of random samples in hardware BO batch", type=int, default=DefaultArgs.hw_batch_size)
     parser.add_argument("--sw-batch-trials", help="number of software samples in BO batch to evaluate", type=int, default=DefaultArgs.sw_batch_trials)
     parser.add_argument("--hw-batch-trials", help="number of hardware samples in BO batch to evaluate", type=int, default=DefaultArgs.hw_batch_trials)
+    parser.add_argument("--sw-elites", help="number of best software samples the native GA reports per layer", type=int, default=DefaultArgs.sw_elites)
+    parser.add_argument("--python-ga", dest="native_ga", help="run the software GA in Python instead of in the library", default=True, action="store_false")
+    parser.add_argument("--per-layer-eval", dest="model_eval", help="evaluate the random software samples of one layer at a time, in batches, instead of a sample of every layer at once", default=True, action="store_false")
 
     parser.add_argument("--print-bo-analysis", dest="print_bo_analysis", help="whether to analyze BO features", default=False, action="store_true")
 
     parser.add_argument("--exhaustive-hw-start-idx", help="point at which to start HW space in exhaustive search", type=int, default=0)
     parser.add_argument("--exhaustive-hw-end-idx", help="point at which to end HW space in exhaustive search", type=int, default=0)
     parser.add_argument("--no-search-permutations", dest="search_permutations", help="enable MAESTRO to search permutations", default=True, action="store_false")
+    parser.add_argument("--optimal-permutations", dest="search_permutations", help="search every loop order of every cluster level for the best one", action="store_const", const=2)
     parser.add_argument("--dataflow", help="type of dataflow to use", type=str, default="searched")
 
     parser.add_argument("--layers", help="comma separated list of layers", type=str, default=DefaultArgs.layers)
-    parser.add_argument("--remove-duplicate-layers", dest="remove_duplicate_layers", help="ignore duplicate layers", default=False, action="store_true")
+    parser.add_argument("--remove-duplicate-layers", dest="remove_duplicate_layers", help="ignore duplicate layers, leaving them out of the model totals", default=False, action="store_true")
     parser.add_argument("--ignore-stride", dest="ignore_stride", help="ignore stride in layer shapes", default=False, action="store_true")
 
     parser.add_argument("--exclude-feat", help="comma separated list of features to ignore", type=str, default=DefaultArgs.exclude_feat)
@@ -1,5 +1,6 @@
 import numpy as np
 import interface
+import space
 from constraints import check_buffer_usage, check_area_usage
 import math
 
@@ -146,10 +147,9 @@ class HWResults(Results):
         )
 
 
-def convert_point_to_maestro(args, hw_point, sw_point, num_levels):
-    num_simd_lanes = hw_point.get('num_simd_lane')
-    bit_width = hw_point.get('bit_width')
-    bandwidth = hw_point.get('bandwidth')
+def convert_hw_point_to_maestro(hw_point, num_levels):
+    """Returns the buffer size of one partition of every level, which is split among the
+    sub-clusters of the levels above it, along with the number of sub-clusters of every level."""
     subclusters = hw_point.get('subclusters')
 
     buf_partition_counts = list()
@@ -159,6 +159,15 @@ def convert_point_to_maestro(args, hw_point, sw_point, num_levels):
         total *= subclusters[num_levels - i - 1]
     buf_partition_counts.reverse()
 
+    buf_sizes = [int(hw_point.get('l{}_buf_size'.format(i)) / buf_partition_counts[i]) for i in range(num_levels)]
+    return buf_sizes, list(subclusters[:num_levels])
+
+def convert_point_to_maestro(args, hw_point, sw_point, num_levels):
+    num_simd_lanes = hw_point.get('num_simd_lane')
+    bit_width = hw_point.get('bit_width')
+    bandwidth = hw_point.get('bandwidth')
+    buf_sizes, subclusters = convert_hw_point_to_maestro(hw_point, num_levels)
+
     aggregate_tile_sizes = dict()
     if args.dataflow == 'searched':
         tiled_dims = ['N', 'K', 'C', 'X', 'Y', 'R', 'S']
@@ -170,14 +179,13 @@ def convert_point_to_maestro(args, hw_point, sw_point, num_levels):
 
     level_configs = list()
     for i in range(num_levels):
-        buf_size_per_partition = int(hw_point.get('l{}_buf_size'.format(i)) / buf_partition_counts[i])
         if args.dataflow == 'searched':
             spatial_dim = sw_point.get('l{}_spatial_dim'.format(i))
         elif args.dataflow == 'fixed':
             spatial_dim = None
         level_configs.append(interface.LevelConfig(
             'L{}'.format(i),
-            buf_size_per_partition,
+            buf_sizes[i],
             subclusters[i],
             {dim: aggregate_tile_size[i] for dim, aggregate_tile_size in aggregate_tile_sizes.items()},
             spatial_dim
@@ -193,6 +201,49 @@ def run_maestro_tvm(args, eval_func, shape, hw_point, sw_point, num_levels):
     num_simd_lanes, bit_width, bandwidth, dataflow, level_configs = convert_point_to_maestro(args, hw_point, sw_point, num_levels)
     return interface.convert_args_and_invoke(args, eval_func, shape, num_simd_lanes, bit_width, bandwidth, dataflow, level_configs)
 
+def run_maestro_batch(args, batch_func, shape, hw_point, sw_points, num_levels):
+    """Evaluates every point of sw_points for shape on hw_point in one library call, see
+    interface.convert_args_and_invoke_batch. Returns the cost of every point."""
+    samples = list()
+    dataflows = list()
+    for sw_point in sw_points:
+        num_simd_lanes, bit_width, bandwidth, dataflow, level_configs = convert_point_to_maestro(args, hw_point, sw_point, num_levels)
+        samples.append((num_simd_lanes, bit_width, bandwidth, level_configs))
+        dataflows.append(dataflow)
+    return interface.convert_args_and_invoke_batch(args, batch_func, shape, samples, dataflows)
+
+def run_maestro_model(args, model_func, shapes, hw_point, sw_points, num_levels):
+    """Evaluates sw_points[i] for shapes[i] on hw_point in one library call, see
+    interface.convert_args_and_invoke_model. Returns the cost of every layer."""
+    layer_configs = list()
+    for sw_point in sw_points:
+        num_simd_lanes, bit_width, bandwidth, dataflow, level_configs = convert_point_to_maestro(args, hw_point, sw_point, num_levels)
+        layer_configs.append((dataflow, level_configs))
+    return interface.convert_args_and_invoke_model(args, model_func, shapes, num_simd_lanes, bit_width, bandwidth, layer_configs)
+
+def run_genetic_search(args, genetic_func, shape, hw_point, num_levels, num_elites):
+    """Runs the native genetic search for the software points of one layer on hw_point. Returns
+    the best (sw_point, cost) pairs, best first, and whether the search found sw_trials valid
+    points before giving up."""
+    buf_sizes, subclusters = convert_hw_point_to_maestro(hw_point, num_levels)
+    # Levels are passed outermost first, like the level configs of convert_point_to_maestro
+    buf_sizes.reverse()
+    subclusters.reverse()
+    seed = np.random.randint(np.iinfo(np.int64).max)
+    elites, success = interface.invoke_genetic_search(
+        args,
+        genetic_func,
+        shape,
+        hw_point.get('num_simd_lane'),
+        hw_point.get('bit_width'),
+        hw_point.get('bandwidth'),
+        buf_sizes,
+        subclusters,
+        seed,
+        num_elites
+    )
+    return [(space.Point(sw_point), cost) for sw_point, cost in elites], success
+
 def get_hw_point_feats(hw_point, num_levels, with_labels=False):
     feats = list()
     feats.append(hw_point.get('num_simd_lane'))